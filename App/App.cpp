@@ -3,21 +3,81 @@
 #include <assert.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <ctype.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <sched.h>
 #define MAX_PATH FILENAME_MAX
 #include "sgx_urts.h"
 #include "sgx_status.h"
+#include "sgx_uswitchless.h"
 #include "App.h"
 #include "Enclave_u.h"
 
 
 extern "C"{
 void mainn(int argc, char *argv[]);
+unsigned long StartStopwatch();
+void alloc_failed(void);
 };
 
 
 /* Global EID shared by multiple threads */
 sgx_enclave_id_t global_eid = 0;
 
+/* Switchless call configuration, set from the command line (-s) */
+int app_switchless = 0;
+unsigned int app_switchless_tworkers = 1;
+unsigned int app_switchless_uworkers = 1;
+
+/* SGX_MODE the App was built for (HW or SIM), for the result files */
+#ifndef SGX_MODE_NAME
+# define SGX_MODE_NAME "unknown"
+#endif
+const char *app_sgx_mode = SGX_MODE_NAME;
+
+/* Native build of the enclave code for the differential run (-diff).
+ * While app_native is set the bridges below call into it instead of
+ * the enclave, with the same arguments. */
+int app_native = 0;
+static void *native_handle = NULL;
+
+/* Type of the native function behind an ECALL proxy... */
+template<typename P> struct native_of;
+template<typename... A> struct native_of<sgx_status_t(sgx_enclave_id_t, A...)> {
+    typedef void type(A...);
+};
+
+/* ...and behind one that returns its value through retval */
+template<typename P> struct native_ret_of;
+template<typename R, typename... A> struct native_ret_of<sgx_status_t(sgx_enclave_id_t, R *, A...)> {
+    typedef R type(A...);
+};
+
+static void *native_sym(const char *name)
+{
+    void *p = dlsym(native_handle, name);
+    if (p == NULL) {
+        printf("Error: %s not found in %s.\n", name, NATIVE_FILENAME);
+        exit(1);
+    }
+    return p;
+}
+
+/* Native fn, looked up once per call site */
+#define NATIVE_FN(trait, fn) ([]() -> trait<decltype(fn)>::type * { \
+        static trait<decltype(fn)>::type *p = \
+            (trait<decltype(fn)>::type *)native_sym(#fn); \
+        return p; }())
+
+/* Call fn in the enclave or natively */
+#define ECALL(fn, ...) (app_native ? \
+        (NATIVE_FN(native_of, fn)(__VA_ARGS__), SGX_SUCCESS) : \
+        fn(global_eid, ##__VA_ARGS__))
+#define ECALL_RET(fn, retval, ...) (app_native ? \
+        (*(retval) = NATIVE_FN(native_ret_of, fn)(__VA_ARGS__), SGX_SUCCESS) : \
+        fn(global_eid, retval, ##__VA_ARGS__))
+
 typedef struct _sgx_errlist_t {
     sgx_status_t err;
     const char *msg;
@@ -29,6 +89,8 @@ typedef struct _sgx_errlist_t {
  *   Step 2: call sgx_create_enclave to initialize an enclave instance
  *   Step 3: save the launch token if it is updated
  */
+static const char *enclave_filename = ENCLAVE_FILENAME;
+
 int initialize_enclave(void)
 {
     char token_path[MAX_PATH] = {'\0'};
@@ -71,7 +133,25 @@ int initialize_enclave(void)
 
     /* Step 2: call sgx_create_enclave to initialize an enclave instance */
     /* Debug Support: set 2nd parameter to 1 */
-    ret = sgx_create_enclave(ENCLAVE_FILENAME, SGX_DEBUG_FLAG, &token, &updated, &global_eid, NULL);
+    if (app_switchless) {
+        /* ECALLs/OCALLs marked transition_using_threads are handed to
+         * worker threads polling a shared queue instead of EENTER/EEXIT */
+        sgx_uswitchless_config_t us_config = SGX_USWITCHLESS_CONFIG_INITIALIZER;
+        const void *enclave_ex_p[32] = { 0 };
+
+        us_config.num_tworkers = app_switchless_tworkers;
+        us_config.num_uworkers = app_switchless_uworkers;
+        enclave_ex_p[SGX_CREATE_ENCLAVE_EX_SWITCHLESS_BIT_IDX] = (const void *)&us_config;
+        ret = sgx_create_enclave_ex(enclave_filename, SGX_DEBUG_FLAG, &token, &updated, &global_eid, NULL,
+                                    SGX_CREATE_ENCLAVE_EX_SWITCHLESS, enclave_ex_p);
+    } else {
+        ret = sgx_create_enclave(enclave_filename, SGX_DEBUG_FLAG, &token, &updated, &global_eid, NULL);
+    }
+    if (ret != SGX_SUCCESS) {
+        printf("Error: Failed to create the enclave (0x%x).\n", ret);
+        if (fp != NULL) fclose(fp);
+        return -1;
+    }
 
 
     /* Step 3: save the launch token if it is updated */
@@ -94,6 +174,12 @@ int initialize_enclave(void)
     return 0;
 }
 
+/* Arrival times of OCALLs in stopwatch ticks, recorded by
+ * app_ocall_loop.  Not per thread: a switchless OCALL runs on an
+ * untrusted worker thread. */
+static unsigned long long *volatile ocall_stamps = NULL;
+static unsigned long ocall_nstamps = 0;
+
 /* OCall functions */
 void ocall_print_string(const char *str)
 {
@@ -101,8 +187,27 @@ void ocall_print_string(const char *str)
      * the input string to prevent buffer overflow. 
      */
     //printf("%s", str);
+    if (ocall_stamps != NULL)
+        ocall_stamps[ocall_nstamps++] = StartStopwatch();
 }
 
+/* A streaming stage has waited a while for its neighbours */
+void ocall_yield(void)
+{
+    sched_yield();
+}
+
+
+/* Parse the tail of "-s[T[,U]]": T trusted and U untrusted workers */
+static void parse_switchless_arg(const char *arg)
+{
+    app_switchless = 1;
+    if (*arg == '\0')
+        return;
+    app_switchless_tworkers = (unsigned int)strtoul(arg, (char **)&arg, 10);
+    if (*arg == ',')
+        app_switchless_uworkers = (unsigned int)strtoul(arg + 1, NULL, 10);
+}
 
 /* Application entry */
 int SGX_CDECL main(int argc, char *argv[])
@@ -110,6 +215,13 @@ int SGX_CDECL main(int argc, char *argv[])
     (void)(argc);
     (void)(argv);
 
+    /* The transition mode has to be known before the enclave is
+     * created; nbench0.c accepts and ignores the same option. */
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && toupper((unsigned char)argv[i][1]) == 'S')
+            parse_switchless_arg(argv[i] + 2);
+    }
+
     /* Initialize the enclave */
     if(initialize_enclave() < 0){
         return -1;}
@@ -126,162 +238,558 @@ int SGX_CDECL main(int argc, char *argv[])
     return 0;
 }
 
+/* Load the native build of the enclave code; 0 on success */
+int app_native_load(void){
+    if (native_handle == NULL)
+        native_handle = dlopen("./" NATIVE_FILENAME, RTLD_NOW | RTLD_LOCAL);
+    if (native_handle == NULL) {
+        printf("Error: Failed to load %s: %s\n", NATIVE_FILENAME, dlerror());
+        return -1;
+    }
+    return 0;
+}
+
+/* Replace the enclave with the one signed for the EPC sweep, whose
+ * heap is much larger than the EPC; 0 on success */
+int app_sweep_enclave(void){
+    sgx_destroy_enclave(global_eid);
+    enclave_filename = SWEEP_ENCLAVE_FILENAME;
+    return initialize_enclave() < 0 ? -1 : 0;
+}
+
+/* Give the calling thread its own benchmark state (slot) in the
+ * enclave; 0 on success */
+int app_thread_bind(int slot){
+    return ECALL(encl_thread_bind, slot) == SGX_SUCCESS ? 0 : -1;
+}
+
 void app_AllocateMemory(size_t size){
-    encl_AllocateMemory(global_eid,size);
+    int retval = -1;
+    if (ECALL_RET(encl_AllocateMemory, &retval, size) != SGX_SUCCESS || retval != 0)
+        alloc_failed();
 }
 
 void app_AllocateMemory2(size_t size){
-    encl_AllocateMemory2(global_eid,size);
+    int retval = -1;
+    if (ECALL_RET(encl_AllocateMemory2, &retval, size) != SGX_SUCCESS || retval != 0)
+        alloc_failed();
 }
 
 void app_AllocateMemory3(size_t size){
-    encl_AllocateMemory3(global_eid,size);
+    int retval = -1;
+    if (ECALL_RET(encl_AllocateMemory3, &retval, size) != SGX_SUCCESS || retval != 0)
+        alloc_failed();
 }
 
 void app_AllocateMemory4(size_t size){
-    encl_AllocateMemory4(global_eid,size);
+    int retval = -1;
+    if (ECALL_RET(encl_AllocateMemory4, &retval, size) != SGX_SUCCESS || retval != 0)
+        alloc_failed();
 }
 
 void app_AllocateMemory5(size_t size){
-    encl_AllocateMemory5(global_eid,size);
+    int retval = -1;
+    if (ECALL_RET(encl_AllocateMemory5, &retval, size) != SGX_SUCCESS || retval != 0)
+        alloc_failed();
 }
 void app_FreeMemory(){
-    encl_FreeMemory(global_eid);
+    ECALL(encl_FreeMemory);
 }
 
 void app_FreeMemory2(){
-    encl_FreeMemory2(global_eid);
+    ECALL(encl_FreeMemory2);
 }
 
 void app_FreeMemory3(){
-    encl_FreeMemory3(global_eid);
+    ECALL(encl_FreeMemory3);
 }
 
 void app_FreeMemory4(){
-    encl_FreeMemory4(global_eid);
+    ECALL(encl_FreeMemory4);
 }
 
 void app_FreeMemory5(){
-    encl_FreeMemory5(global_eid);
+    ECALL(encl_FreeMemory5);
+}
+
+const char *app_enclave_file(void){
+    return enclave_filename;
+}
+
+int app_heap_probe(size_t size){
+    int retval = -1;
+    if (ECALL_RET(encl_heap_probe, &retval, size) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_buf_create(size_t size, size_t align){
+    int retval = -1;
+    if (ECALL_RET(encl_buf_create, &retval, size, align) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_buf_bind(int k, int h){
+    int retval = -1;
+    if (ECALL_RET(encl_buf_bind, &retval, k, h) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+void app_buf_destroy(int h){
+    ECALL(encl_buf_destroy, h);
+}
+
+/* app_buf_create(), with alloc_failed() for no room, as app_AllocateMemory() */
+int app_buf_alloc(size_t size, size_t align){
+    int h = app_buf_create(size, align);
+    if (h < 0)
+        alloc_failed();
+    return h;
+}
+
+int app_arena_create(size_t size){
+    int retval = -1;
+    if (ECALL_RET(encl_arena_create, &retval, size) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_arena_use(int h){
+    int retval = -1;
+    if (ECALL_RET(encl_arena_use, &retval, h) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_arena_reset(int h){
+    int retval = -1;
+    if (ECALL_RET(encl_arena_reset, &retval, h) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+size_t app_arena_peak(int h){
+    size_t retval = 0;
+    if (ECALL_RET(encl_arena_peak, &retval, h) != SGX_SUCCESS)
+        return 0;
+    return retval;
+}
+
+void app_arena_destroy(int h){
+    ECALL(encl_arena_destroy, h);
 }
 
 
 /*NumSort*/
 void app_LoadNumArrayWithRand(unsigned long arraysize, unsigned int numarrays){
-    encl_LoadNumArrayWithRand(global_eid,arraysize,numarrays);
+    ECALL(encl_LoadNumArrayWithRand, arraysize,numarrays);
 }
 
 void app_NumHeapSort(unsigned long base_offset,unsigned long bottom, unsigned long top){
- sgx_status_t t= encl_NumHeapSort(global_eid,base_offset,bottom,top);
+ sgx_status_t t= ECALL(encl_NumHeapSort, base_offset,bottom,top);
+}
+
+/* Numeric Sort (PAR): the pool id for app_sortpool_worker, or -1 */
+int app_sortpool_start(unsigned long arraysize, int nparts, int algo){
+    int retval = -1;
+    if (ECALL_RET(encl_sortpool_start, &retval, arraysize, nparts, algo) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+/* Returns when the pool is stopped; -1 if the ECALL failed (no free TCS) */
+int app_sortpool_worker(int id, int part){
+    int retval = -1;
+    if (ECALL_RET(encl_sortpool_worker, &retval, id, part) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_sortpool_run(unsigned long numarrays){
+    int retval = -1;
+    if (ECALL_RET(encl_sortpool_run, &retval, numarrays) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+void app_sortpool_stop(void){
+    ECALL(encl_sortpool_stop);
+}
+
+/* 0 if every array is in ascending order */
+int app_NumSortCheck(unsigned long arraysize, unsigned long numarrays){
+    int retval = -1;
+    if (ECALL_RET(encl_NumSortCheck, &retval, arraysize, numarrays) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 /*StringSort*/
 unsigned long app_LoadStringArray(unsigned int numarrays, unsigned long arraysize){
 		unsigned long retval;
-		encl_LoadStringArray(global_eid,&retval, numarrays,arraysize);
+		ECALL_RET(encl_LoadStringArray, &retval, numarrays,arraysize);
 		return retval;
 }
 
 void app_StrHeapSort(unsigned long oparrayOffset, unsigned long strarrayOffset, unsigned long numstrings, unsigned long bottom, unsigned long top){
- 	//encl_StrHeapSort(global_eid, oparrayOffset, strarrayOffset, numstrings, bottom, top);
+ 	//ECALL(encl_StrHeapSort, oparrayOffset, strarrayOffset, numstrings, bottom, top);
 }
 
 void app_call_StrHeapSort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize){
-	 encl_call_StrHeapSort(global_eid, nstrings, numarrays, arraysize);
+	 ECALL(encl_call_StrHeapSort, nstrings, numarrays, arraysize);
+}
+
+/* String Sort (KEY); 0, or -1 if its arrays do not fit in the enclave */
+int app_call_StrKeySort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize){
+    int retval = -1;
+    if (ECALL_RET(encl_call_StrKeySort, &retval, nstrings, numarrays, arraysize) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+/* 0 if every string array is in order */
+int app_StrSortCheck(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize){
+    int retval = -1;
+    if (ECALL_RET(encl_StrSortCheck, &retval, nstrings, numarrays, arraysize) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 /*BitSort*/
 unsigned long app_bitSetup(long bitfieldarraysize, long bitoparraysize){
 	unsigned long retval;
-	encl_bitSetup(global_eid, &retval, bitfieldarraysize, bitoparraysize);
+	ECALL_RET(encl_bitSetup, &retval, bitfieldarraysize, bitoparraysize);
 	return retval;
 }
 
 void app_ToggleBitRun(unsigned long bit_addr, unsigned long nbits, unsigned int val){
-	encl_ToggleBitRun(global_eid, bit_addr, nbits, val);
+	ECALL(encl_ToggleBitRun, bit_addr, nbits, val);
 }
 
 void app_FlipBitRun(long bit_addr,long nbits){
-	encl_FlipBitRun(global_eid, bit_addr, nbits);   
+	ECALL(encl_FlipBitRun, bit_addr, nbits);   
+}
+
+void app_DoBitfieldIteration(long bitoparraysize){
+	ECALL(encl_DoBitfieldIteration, bitoparraysize);
+}
+
+void app_DoBitfieldIterationWord(long bitoparraysize, int kernel){
+	ECALL(encl_DoBitfieldIterationWord, bitoparraysize, kernel);
+}
+
+/* 0 if the word-at-a-time runs leave the bitmap as the bit-by-bit ones do */
+int app_checkBitfieldWord(long bitfieldarraysize, long bitoparraysize, int kernel){
+    int retval = -1;
+    if (ECALL_RET(encl_checkBitfieldWord, &retval, bitfieldarraysize, bitoparraysize, kernel) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 /*Floating Point*/
 void app_SetupCPUEmFloatArrays(unsigned long arraysize){
-    encl_SetupCPUEmFloatArrays(global_eid,arraysize);
+    ECALL(encl_SetupCPUEmFloatArrays, arraysize);
 }
 void app_DoEmFloatIteration(ulong arraysize, ulong loops){
-    encl_DoEmFloatIteration(global_eid, arraysize, loops);
+    ECALL(encl_DoEmFloatIteration, arraysize, loops);
+}
+int app_SetupWideEmFloatArrays(unsigned long arraysize, int a, int b){
+    int retval = -1;
+    if (ECALL_RET(encl_SetupWideEmFloatArrays, &retval, arraysize, a, b) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+int app_DoWideEmFloatIteration(ulong arraysize, ulong loops, int a, int b, int c){
+    int retval = -1;
+    if (ECALL_RET(encl_DoWideEmFloatIteration, &retval, arraysize, loops, a, b, c) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+int app_checkWideEmFloat(ulong arraysize, ulong loops){
+    int retval = -1;
+    if (ECALL_RET(encl_checkWideEmFloat, &retval, arraysize, loops) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+int app_SetupSortedEmFloatArrays(ulong arraysize, int a, int b, int c, int order){
+    int retval = -1;
+    if (ECALL_RET(encl_SetupSortedEmFloatArrays, &retval, arraysize, a, b, c, order) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+/* FP Emulation (SORTED): the pool id for app_emfloat_worker, or -1 */
+int app_emfloat_start(void){
+    int retval = -1;
+    if (ECALL_RET(encl_emfloat_start, &retval) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+/* Returns when the pool is stopped; -1 if the ECALL failed (no free TCS) */
+int app_emfloat_worker(int id){
+    int retval = -1;
+    if (ECALL_RET(encl_emfloat_worker, &retval, id) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+int app_emfloat_run(ulong arraysize, ulong loops, int a, int b, int c, int order){
+    int retval = -1;
+    if (ECALL_RET(encl_emfloat_run, &retval, arraysize, loops, a, b, c, order) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+void app_emfloat_stop(void){
+    ECALL(encl_emfloat_stop);
+}
+int app_checkSortedEmFloat(ulong arraysize, ulong loops, int a, int b, int c){
+    int retval = -1;
+    if (ECALL_RET(encl_checkSortedEmFloat, &retval, arraysize, loops, a, b, c) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 /*Fourier*/
 void app_DoFPUTransIteration(unsigned long arraysize){
-    encl_DoFPUTransIteration(global_eid, arraysize);
+    ECALL(encl_DoFPUTransIteration, arraysize);
+}
+
+int app_fourier_start(int level){
+    int retval = -1;
+    if (ECALL_RET(encl_fourier_start, &retval, level) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+/* Returns when the pool is stopped; -1 if the ECALL failed (no free TCS) */
+int app_fourier_worker(int id){
+    int retval = -1;
+    if (ECALL_RET(encl_fourier_worker, &retval, id) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_fourier_run(unsigned long arraysize, int a, int b){
+    int retval = -1;
+    if (ECALL_RET(encl_fourier_run, &retval, arraysize, a, b) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+void app_fourier_stop(void){
+    ECALL(encl_fourier_stop);
+}
+
+int app_fourier_check(unsigned long arraysize, int a, int b){
+    int retval = -1;
+    if (ECALL_RET(encl_fourier_check, &retval, arraysize, a, b) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 /*Assignment*/
 
 void app_LoadAssignArrayWithRand(unsigned long numarrays){
-	encl_LoadAssignArrayWithRand(global_eid,numarrays);
+	ECALL(encl_LoadAssignArrayWithRand, numarrays);
 }
 
 void app_call_AssignmentTest(unsigned int numarrays){
-	encl_call_AssignmentTest(global_eid, numarrays);
+	ECALL(encl_call_AssignmentTest, numarrays);
+}
+
+int app_assign_build(long n, int costs){
+	int retval = -1;
+	if (ECALL_RET(encl_assign_build, &retval, n, costs) != SGX_SUCCESS)
+		return -1;
+	return retval;
+}
+
+long app_assign_solve(long n, int costs, int duals, int perm, int scratch){
+	long retval = -1;
+	if (ECALL_RET(encl_assign_solve, &retval, n, costs, duals, perm, scratch) != SGX_SUCCESS)
+		return -1;
+	return retval;
+}
+
+int app_assign_check(long n, long cost, int costs, int duals, int perm){
+	int retval = -1;
+	if (ECALL_RET(encl_assign_check, &retval, n, cost, costs, duals, perm) != SGX_SUCCESS)
+		return -1;
+	return retval;
 }
 
 /*IDEAsort*/
 void app_loadIDEA(unsigned long arraysize){
-	encl_app_loadIDEA(global_eid, arraysize);
+	ECALL(encl_app_loadIDEA, arraysize);
 }
 
 void app_callIDEA(unsigned long arraysize, unsigned short* Z, unsigned short* DK, unsigned long nloops){
-	encl_callIDEA(global_eid, arraysize, Z, DK, nloops);
+	ECALL(encl_callIDEA, arraysize, Z, DK, nloops);
 }
 
-/*Neural Net*/
-void app_set_numpats(int npats){
-    encl_set_numpats(global_eid,npats);
+void app_callIDEAsimd(unsigned long arraysize, unsigned short* Z, unsigned short* DK, unsigned long nloops, int level){
+	ECALL(encl_callIDEAsimd, arraysize, Z, DK, nloops, level);
 }
 
-double app_get_in_pats(int patt, int element){
-    double retval;
-    encl_get_in_pats(global_eid,&retval,patt,element);
+/* 0 if the vectorized IDEA matches cipher_idea() bit for bit */
+int app_checkIDEAsimd(unsigned long arraysize, unsigned short* Z, unsigned short* DK, int level){
+    int retval = -1;
+    if (ECALL_RET(encl_checkIDEAsimd, &retval, arraysize, Z, DK, level) != SGX_SUCCESS)
+        return -1;
     return retval;
 }
 
-void app_set_in_pats(int patt, int element, double val){
-    encl_set_in_pats(global_eid,patt,element,val);
+/*Streaming IDEA*/
+/* Rings for chunks of chunk bytes; 0 on success */
+int app_stream_init(size_t chunk, unsigned short* Z, int level){
+    int retval = -1;
+    if (ECALL_RET(encl_stream_init, &retval, chunk, Z, level) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
-void app_set_out_pats(int patt, int element, double val){
-    encl_set_out_pats(global_eid,patt,element,val);
+void app_stream_free(){
+    ECALL(encl_stream_free);
+}
+
+/* One stage of the stream (STREAM_xxx); 0 on success */
+int app_stream_stage(int stage, const void *in, void *out, size_t len){
+    int retval = -1;
+    if (ECALL_RET(encl_stream_stage, &retval, stage, in, out, len) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+void app_stream_abort(){
+    ECALL(encl_stream_abort);
+}
+
+/* Scalar ciphertext every run is checked against; 0 on success */
+int app_stream_reference(const void *in, void *out, size_t len){
+    int retval = -1;
+    if (ECALL_RET(encl_stream_reference, &retval, in, out, len) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+/*Neural Net*/
+/* All NNET patterns in one [in] buffer; 0 on success */
+int app_load_pats(int npats, const double *pats, size_t count){
+    int retval = -1;
+    if (ECALL_RET(encl_load_pats, &retval, npats, pats, count) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 void app_DoNNetIteration(unsigned long nloops){
-    encl_DoNNetIteration(global_eid,nloops);
+    ECALL(encl_DoNNetIteration, nloops);
+}
+
+int app_mlp_setup(long in, long hid, long out, long npats, long batch){
+    int retval = -1;
+    if (ECALL_RET(encl_mlp_setup, &retval, in, hid, out, npats, batch) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+void app_mlp_train(unsigned long nepochs, int level){
+    ECALL(encl_mlp_train, nepochs, level);
+}
+
+int app_mlp_check(int level){
+    int retval = -1;
+    if (ECALL_RET(encl_mlp_check, &retval, level) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+void app_mlp_free(void){
+    ECALL(encl_mlp_free);
 }
 
 /*LU Decomposition*/
 void app_build_problem(){
-	encl_build_problem(global_eid);
+	ECALL(encl_build_problem);
 }
 
 void app_moveSeedArrays(unsigned long numarrays){
-	encl_moveSeedArrays(global_eid, numarrays);
+	ECALL(encl_moveSeedArrays, numarrays);
 }
 
 void app_call_lusolve(unsigned long numarrays){
-	encl_call_lusolve(global_eid, numarrays);
+	ECALL(encl_call_lusolve, numarrays);
+}
+
+int app_lu_build(long n, int seed, int rhs){
+    int retval = -1;
+    if (ECALL_RET(encl_lu_build, &retval, n, seed, rhs) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+int app_lu_reset(long n, int seed, int work){
+    int retval = -1;
+    if (ECALL_RET(encl_lu_reset, &retval, n, seed, work) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+/* -1 for a singular matrix, -2 for a bad handle or a failed ECALL */
+int app_lu_factor(long n, long nb, int kernel, int level, int work, int indx, int scratch){
+    int retval = -2;
+    if (ECALL_RET(encl_lu_factor, &retval, n, nb, kernel, level, work, indx, scratch) != SGX_SUCCESS)
+        return -2;
+    return retval;
+}
+
+int app_lu_check(long n, int seed, int rhs, int work, int indx, int scratch){
+    int retval = -1;
+    if (ECALL_RET(encl_lu_check, &retval, n, seed, rhs, work, indx, scratch) != SGX_SUCCESS)
+        return -1;
+    return retval;
 }
 
 /*Huffman Compression*/
 void app_buildHuffman(unsigned long arraysize){
-	encl_buildHuffman(global_eid, arraysize);
+	ECALL(encl_buildHuffman, arraysize);
 }
 
 void app_callHuffman(unsigned long nloops, unsigned long arraysize){
-	encl_callHuffman(global_eid, nloops,arraysize);
+	ECALL(encl_callHuffman, nloops,arraysize);
+}
+
+/* 0 if every round trip of the canonical coder matched */
+int app_callHuffmanTable(unsigned long nloops, unsigned long arraysize){
+    int retval = -1;
+    if (ECALL_RET(encl_callHuffmanTable, &retval, nloops, arraysize) != SGX_SUCCESS)
+        return -1;
+    return retval;
+}
+
+/*Transition microbenchmarks*/
+int app_nothing(){
+	return nothing(global_eid) == SGX_SUCCESS ? 0 : -1;
 }
 
+int app_ecall_in(const void *buf, size_t len){
+	return encl_ecall_in(global_eid, buf, len) == SGX_SUCCESS ? 0 : -1;
+}
 
+int app_ecall_out(void *buf, size_t len){
+	return encl_ecall_out(global_eid, buf, len) == SGX_SUCCESS ? 0 : -1;
+}
 
+int app_ecall_user_check(void *buf, size_t len){
+	return encl_ecall_user_check(global_eid, buf, len) == SGX_SUCCESS ? 0 : -1;
+}
 
+/* stamps receives the stopwatch reading (StartStopwatch) at the arrival
+ * of each of the count OCALLs.  Only one thread may run this at a time. */
+int app_ocall_loop(unsigned long long *stamps, unsigned long count){
+	sgx_status_t ret;
+	ocall_stamps = stamps;
+	ocall_nstamps = 0;
+	ret = encl_ocall_loop(global_eid, count);
+	ocall_stamps = NULL;
+	return ret == SGX_SUCCESS ? 0 : -1;
+}
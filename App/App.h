@@ -48,6 +48,8 @@
 # define TOKEN_FILENAME   "enclave.token"
 # define ENCLAVE_FILENAME "enclave.signed.so"
 #endif
+#define NATIVE_FILENAME "native.so"     /* Enclave code built natively */
+#define SWEEP_ENCLAVE_FILENAME "enclave.sweep.signed.so" /* Big heap, for SWEEP= */
 
 extern sgx_enclave_id_t global_eid;    /* global enclave id */
 
@@ -55,6 +57,24 @@ extern sgx_enclave_id_t global_eid;    /* global enclave id */
 extern "C" {
 #endif
 
+/*Transition mode*/
+extern int app_switchless;                     /* switchless calls enabled */
+extern unsigned int app_switchless_tworkers;   /* trusted worker threads */
+extern unsigned int app_switchless_uworkers;   /* untrusted worker threads */
+extern const char *app_sgx_mode;               /* HW or SIM */
+
+
+/*Differential run: bridges call native.so while app_native is set*/
+extern int app_native;
+int app_native_load(void);              /* 0 on success */
+
+/*EPC sweep: reload with the big-heap enclave, 0 on success*/
+int app_sweep_enclave(void);
+int app_heap_probe(size_t size);        /* 0 if size bytes fit */
+const char *app_enclave_file(void);     /* Signed enclave being run */
+
+/*Per-thread state, 0 on success*/
+int app_thread_bind(int slot);
 
 /*Memory management*/
 void app_AllocateMemory(size_t size);
@@ -68,50 +88,112 @@ void app_FreeMemory3();
 void app_FreeMemory4();
 void app_FreeMemory5();
 
+/*Buffer registry; handle, or -1*/
+int app_buf_create(size_t size, size_t align);
+int app_buf_bind(int k, int h);         /* For the calling thread */
+void app_buf_destroy(int h);
+int app_buf_alloc(size_t size, size_t align);   /* alloc_failed() on no room */
+
+/*Arenas for the buffers (ARENAKB=); handle, or -1*/
+int app_arena_create(size_t size);
+int app_arena_use(int h);               /* For the calling thread */
+int app_arena_reset(int h);
+size_t app_arena_peak(int h);
+void app_arena_destroy(int h);
+
 /*NumSort*/
 void app_LoadNumArrayWithRand(unsigned long arraysize, unsigned int numarrays);
 void app_NumHeapSort(unsigned long base_offset,unsigned long bottom, unsigned long top);
+int app_sortpool_start(unsigned long arraysize, int nparts, int algo);
+int app_sortpool_worker(int id, int part);
+int app_sortpool_run(unsigned long numarrays);
+void app_sortpool_stop(void);
+int app_NumSortCheck(unsigned long arraysize, unsigned long numarrays);
 
 /*BitSort*/
 unsigned long app_bitSetup(long bitfieldarraysize, long bitoparraysize);
 void app_ToggleBitRun(unsigned long bit_addr, unsigned long nbits, unsigned int val);
 void app_FlipBitRun(long bit_addr,long nbits); 
+void app_DoBitfieldIteration(long bitoparraysize);
+void app_DoBitfieldIterationWord(long bitoparraysize, int kernel);
+int app_checkBitfieldWord(long bitfieldarraysize, long bitoparraysize, int kernel);
 
 /*StringSort*/
 unsigned long app_LoadStringArray(unsigned int numarrays, unsigned long arraysize);
 void app_StrHeapSort(unsigned long oparrayOffset, unsigned long strarrayOffset, unsigned long numstrings, unsigned long bottom, unsigned long top);
 void app_call_StrHeapSort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+int app_call_StrKeySort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+int app_StrSortCheck(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
 
 /*Floating Point*/
 void app_SetupCPUEmFloatArrays(unsigned long);
 void app_DoEmFloatIteration(unsigned long arraysize, unsigned long loops);
+int app_SetupWideEmFloatArrays(unsigned long arraysize, int a, int b);
+int app_DoWideEmFloatIteration(unsigned long arraysize, unsigned long loops, int a, int b, int c);
+int app_checkWideEmFloat(unsigned long arraysize, unsigned long loops);
+int app_SetupSortedEmFloatArrays(unsigned long arraysize, int a, int b, int c, int order);
+int app_emfloat_start(void);
+int app_emfloat_worker(int id);
+int app_emfloat_run(unsigned long arraysize, unsigned long loops, int a, int b, int c, int order);
+void app_emfloat_stop(void);
+int app_checkSortedEmFloat(unsigned long arraysize, unsigned long loops, int a, int b, int c);
 
 /*Fourier*/
 void app_DoFPUTransIteration(unsigned long arraysize);
+int app_fourier_start(int level);
+int app_fourier_worker(int id);
+int app_fourier_run(unsigned long arraysize, int a, int b);
+void app_fourier_stop(void);
+int app_fourier_check(unsigned long arraysize, int a, int b);
 
 /*Assignment*/
 void app_LoadAssignArrayWithRand(unsigned long numarrays);
 void app_call_AssignmentTest(unsigned int numarrays);
+int app_assign_build(long n, int costs);
+long app_assign_solve(long n, int costs, int duals, int perm, int scratch);
+int app_assign_check(long n, long cost, int costs, int duals, int perm);
 
 /*IDEAsort*/
 void app_loadIDEA(unsigned long arraysize);
 void app_callIDEA(unsigned long arraysize, unsigned short* Z, unsigned short* DK, unsigned long nloops);
+void app_callIDEAsimd(unsigned long arraysize, unsigned short* Z, unsigned short* DK, unsigned long nloops, int level);
+int app_checkIDEAsimd(unsigned long arraysize, unsigned short* Z, unsigned short* DK, int level);
+
+/*Streaming IDEA*/
+int app_stream_init(size_t chunk, unsigned short* Z, int level);
+void app_stream_free();
+int app_stream_stage(int stage, const void *in, void *out, size_t len);
+void app_stream_abort();
+int app_stream_reference(const void *in, void *out, size_t len);
 
 /*Neural Net*/
-void app_set_numpats(int npats);
-double app_get_in_pats(int patt, int element);
-void app_set_in_pats(int patt, int element, double val);
-void app_set_out_pats(int patt, int element, double val);
+int app_load_pats(int npats, const double *pats, size_t count);
 void app_DoNNetIteration(unsigned long nloops);
+int app_mlp_setup(long in, long hid, long out, long npats, long batch);
+void app_mlp_train(unsigned long nepochs, int level);
+int app_mlp_check(int level);
+void app_mlp_free(void);
 
 /*LU Decomposition*/
 void app_moveSeedArrays(unsigned long numarrays);
 void app_call_lusolve(unsigned long numarrays);
 void app_build_problem();
+int app_lu_build(long n, int seed, int rhs);
+int app_lu_reset(long n, int seed, int work);
+int app_lu_factor(long n, long nb, int kernel, int level, int work, int indx, int scratch);
+int app_lu_check(long n, int seed, int rhs, int work, int indx, int scratch);
 
 /*Huffman Decompisition*/
 void app_buildHuffman(unsigned long arraysize);
 void app_callHuffman(unsigned long nloops, unsigned long arraysize);
+int app_callHuffmanTable(unsigned long nloops, unsigned long arraysize);
+
+/*Transition microbenchmarks, 0 on success*/
+int app_nothing();
+int app_ecall_in(const void *buf, size_t len);
+int app_ecall_out(void *buf, size_t len);
+int app_ecall_user_check(void *buf, size_t len);
+int app_ocall_loop(unsigned long long *stamps, unsigned long count);
 
 
 #if defined(__cplusplus)
@@ -26,13 +26,28 @@
 #include <stdio.h>      /* vsnprintf */
 #include <string.h>
 #include <math.h>
+#include <float.h>      /* DBL_EPSILON */
 #include "Enclave.h"
+#ifndef ENCLAVE_NATIVE
 #include "Enclave_t.h"  /* print_string */
+#include "sgx_trts.h"   /* sgx_is_outside_enclave */
+#else
+#include <sched.h>      /* sched_yield */
+#endif
 
 #include "nmglobal.h"
 #include "emfloat.h"
 #include "pointer.h"
 #include "wordcat.h"
+#include "encl_thread.h"
+#include "encl_idea_simd.h"
+#include "encl_huffman.h"
+#include "encl_bitrun.h"
+#include "encl_lu.h"
+#include "encl_vmath.h"
+#include "encl_mlp.h"
+#include "encl_assign.h"
+#include "encl_workpool.h"
 
 /*
 ** TYPEDEFS
@@ -97,7 +112,9 @@ static long plaintextlen;               /* Length of plaintext */
 
 /*
  * ** GLOBALS
+ * ** One copy per thread slot (see encl_thread.h).
  * */
+typedef struct {
 double  mid_wts[MID_SIZE][IN_SIZE];     /* middle layer weights */
 double  out_wts[OUT_SIZE][MID_SIZE];    /* output layer weights */
 double  mid_out[MID_SIZE];              /* middle layer output */
@@ -120,6 +137,30 @@ int iteration_count;    /* number of passes thru network so far */
 int numpats;            /* number of patterns in data file */
 int numpasses;          /* number of training passes through data file */
 int learned;            /* flag--if TRUE, network has learned all patterns */
+} NNetState;
+
+static NNetState nnet_state[MAXTHREADS];
+
+#define mid_wts (nnet_state[encl_slot].mid_wts)
+#define out_wts (nnet_state[encl_slot].out_wts)
+#define mid_out (nnet_state[encl_slot].mid_out)
+#define out_out (nnet_state[encl_slot].out_out)
+#define mid_error (nnet_state[encl_slot].mid_error)
+#define out_error (nnet_state[encl_slot].out_error)
+#define mid_wt_change (nnet_state[encl_slot].mid_wt_change)
+#define out_wt_change (nnet_state[encl_slot].out_wt_change)
+#define in_pats (nnet_state[encl_slot].in_pats)
+#define out_pats (nnet_state[encl_slot].out_pats)
+#define tot_out_error (nnet_state[encl_slot].tot_out_error)
+#define out_wt_cum_change (nnet_state[encl_slot].out_wt_cum_change)
+#define mid_wt_cum_change (nnet_state[encl_slot].mid_wt_cum_change)
+#define worst_error (nnet_state[encl_slot].worst_error)
+#define average_error (nnet_state[encl_slot].average_error)
+#define avg_out_error (nnet_state[encl_slot].avg_out_error)
+#define iteration_count (nnet_state[encl_slot].iteration_count)
+#define numpats (nnet_state[encl_slot].numpats)
+#define numpasses (nnet_state[encl_slot].numpasses)
+#define learned (nnet_state[encl_slot].learned)
 
 /*
  * ** PROTOTYPES
@@ -221,11 +262,12 @@ memmove(destination, source, nbytes);
  * These variables are only available in the enclave      *
  *********************************************************/
 
-void* enclave_buffer;
-void* enclave_buffer2;
-void* enclave_buffer3;
-void* enclave_buffer4;
-void* enclave_buffer5;
+__thread int encl_slot;
+
+/*
+** State of randnum(), one per slot.
+*/
+static int32 randw[MAXTHREADS][2] = { { (int32)13 , (int32)117 } };
 
 /**********************************************************
  * Public functions					  *
@@ -233,64 +275,209 @@ void* enclave_buffer5;
  * The following functions must be placed in enclave.edl  *
  *********************************************************/
 
-void encl_AllocateMemory(size_t size){
-    enclave_buffer = malloc(size);
-    if( !enclave_buffer ){
-        printf("FATAL: Enclave malloc returned NULL pointer for buffer 1\n");
-	encl_FreeMemory();
-	}
+/*
+** Make the calling thread use slot's state.  Needs a bound
+** TCS (TCSPolicy 0) so the slot sticks to the App thread.
+*/
+void encl_thread_bind(int slot){
+    if(slot<0 || slot>=MAXTHREADS)
+        slot=0;
+    encl_slot=slot;
+    randw[slot][0]=(int32)13; randw[slot][1]=(int32)117;
 }
 
-void encl_AllocateMemory2(size_t size){
-   enclave_buffer2 = malloc(size);
-    if( !enclave_buffer2 ){
-        printf("FATAL: Enclave malloc returned NULL pointer for buffer 2\n");
-	encl_FreeMemory2();
-	}
+/*
+** Arenas (ARENAKB=): handle h is arenas[h].  A slot whose
+** slotarena[] is h+1 takes its buffers from arena h; with 0
+** they come from malloc() as before.
+*/
+static Arena arenas[MAXTHREADS];
+static int arenaopen[MAXTHREADS];
+static int slotarena[MAXTHREADS];
+
+/*
+** Registry buffer of size bytes for the calling slot, from
+** its arena if it has one.  Returns the handle, or -1.
+*/
+static int encl_new_buffer(size_t size, size_t align){
+    int a = slotarena[encl_slot];
+
+    return buf_create(size, align, encl_slot, a ? &arenas[a-1] : NULL);
 }
 
-void encl_AllocateMemory3(size_t size){
-    enclave_buffer3 = malloc(size);
-    if( !enclave_buffer3 ){
-        printf("FATAL: Enclave malloc returned NULL pointer for buffer 3\n");
-	encl_FreeMemory3();
-	}
+/*
+** Set buffer k (0 for enclave_buffer) of the calling slot to
+** a new cache-line aligned buffer of size bytes.  Returns 0,
+** or -1 if there is no room (in the slot's arena, if it has
+** one); k is then left unbound.
+*/
+static int encl_alloc_buffer(int k, size_t size){
+    int h;
+
+    buf_destroy(buf_bound(encl_slot, k));
+    h = encl_new_buffer(size, BUFALIGN_LINE);
+    buf_bind(encl_slot, k, h);
+    return h<0 ? -1 : 0;
 }
 
-void encl_AllocateMemory4(size_t size){
-    enclave_buffer4 = malloc(size);
-    if( !enclave_buffer4 ){
-        printf("FATAL: Enclave malloc returned NULL pointer for buffer 4\n");
-	encl_FreeMemory4();	
-	}
+static void encl_free_buffer(int k){
+    buf_destroy(buf_bound(encl_slot, k));
 }
 
-void encl_AllocateMemory5(size_t size){
-    enclave_buffer5 = malloc(size);
-    if( !enclave_buffer5 ){
-        printf("FATAL: Enclave malloc returned NULL pointer for buffer 5\n");
-	encl_FreeMemory5();
-	}
+int encl_AllocateMemory(size_t size){
+    return encl_alloc_buffer(0, size);
+}
+
+int encl_AllocateMemory2(size_t size){
+    return encl_alloc_buffer(1, size);
+}
+
+int encl_AllocateMemory3(size_t size){
+    return encl_alloc_buffer(2, size);
+}
+
+int encl_AllocateMemory4(size_t size){
+    return encl_alloc_buffer(3, size);
+}
+
+int encl_AllocateMemory5(size_t size){
+    return encl_alloc_buffer(4, size);
 }
 
 void encl_FreeMemory(){
-    free(enclave_buffer);
+    encl_free_buffer(0);
 }
 
 void encl_FreeMemory2(){
-    free(enclave_buffer2);
+    encl_free_buffer(1);
 }
 
 void encl_FreeMemory3(){
-    free(enclave_buffer3);
+    encl_free_buffer(2);
 }
 
 void encl_FreeMemory4(){
-    free(enclave_buffer4);
+    encl_free_buffer(3);
 }
 
 void encl_FreeMemory5(){
-    free(enclave_buffer5);
+    encl_free_buffer(4);
+}
+
+/*
+** A buffer of size bytes on a multiple of align (BUFALIGN_xxx)
+** for the calling slot.  Returns its handle, or -1.
+*/
+int encl_buf_create(size_t size, size_t align){
+    return encl_new_buffer(size, align);
+}
+
+/*
+** Make buffer h numbered buffer k (0 for enclave_buffer) of
+** the calling slot, or unbind k with h of -1.  Returns 0, or
+** -1 on a bad k or handle.
+*/
+int encl_buf_bind(int k, int h){
+    return buf_bind(encl_slot, k, h);
+}
+
+/*
+** Give buffer h back.
+*/
+void encl_buf_destroy(int h){
+    buf_destroy(h);
+}
+
+/*
+** Set aside an arena of size bytes.  Returns its handle, or
+** -1 if there is no room or no free handle.  Two blocks of
+** odd sizes are cut first, and must both start on a cache
+** line as encl_arena.h promises; if not, the arena is given
+** back and -1 returned.
+*/
+int encl_arena_create(size_t size){
+    unsigned char *p, *q;
+    int h;
+
+    for(h=0;h<MAXTHREADS;h++)
+        if( !arenaopen[h] )
+            break;
+    if( h==MAXTHREADS || arena_init(&arenas[h], size)!=0 )
+        return -1;
+    if( size>=3*ARENAALIGN ){
+        p = (unsigned char *)arena_alloc(&arenas[h], 0, 1);
+        q = (unsigned char *)arena_alloc(&arenas[h], 1, 3);
+        arena_reset(&arenas[h]);
+        if( p==NULL || q==NULL || ((size_t)p % ARENAALIGN)!=0 ||
+          ((size_t)q % ARENAALIGN)!=0 ){
+            arena_destroy(&arenas[h]);
+            return -1;
+        }
+    }
+    arenaopen[h] = 1;
+    return h;
+}
+
+/*
+** Take the calling slot's buffers from arena h from now on,
+** or from malloc() with h of -1.  Returns 0, or -1 on a bad
+** handle.
+*/
+int encl_arena_use(int h){
+    if( h<-1 || h>=MAXTHREADS || (h>=0 && !arenaopen[h]) )
+        return -1;
+    slotarena[encl_slot] = h+1;
+    return 0;
+}
+
+/*
+** Empty arena h; the buffers cut from it are gone.
+*/
+int encl_arena_reset(int h){
+    if( h<0 || h>=MAXTHREADS || !arenaopen[h] )
+        return -1;
+    buf_drop_arena(&arenas[h]);
+    arena_reset(&arenas[h]);
+    return 0;
+}
+
+/*
+** Most bytes arena h has had in use.
+*/
+size_t encl_arena_peak(int h){
+    if( h<0 || h>=MAXTHREADS || !arenaopen[h] )
+        return 0;
+    return arenas[h].peak;
+}
+
+/*
+** Give arena h back to the heap.  Slots using it go back to
+** malloc(), and buffers left in it are dropped, so that a
+** later FreeMemory() does not hand them to free().
+*/
+void encl_arena_destroy(int h){
+    int i;
+
+    if( h<0 || h>=MAXTHREADS || !arenaopen[h] )
+        return;
+    for(i=0;i<MAXTHREADS;i++)
+        if( slotarena[i]==h+1 )
+            slotarena[i] = 0;
+    buf_drop_arena(&arenas[h]);
+    arena_destroy(&arenas[h]);
+    arenaopen[h] = 0;
+}
+
+/*
+** 0 if size bytes can be allocated; lets the App find out
+** before a test fails to allocate inside the enclave.
+*/
+int encl_heap_probe(size_t size){
+    void *p = malloc(size);
+    if( !p )
+        return -1;
+    free(p);
+    return 0;
 }
 
 
@@ -508,14 +695,14 @@ extern "C" {
 int32 randnum(int32 lngval)
 {
 	register int32 interm;
-	static int32 randw[2] = { (int32)13 , (int32)117 };
+	int32 *w=randw[encl_slot];
 
 	if (lngval!=(int32)0)
-	{	randw[0]=(int32)13; randw[1]=(int32)117; }
+	{	w[0]=(int32)13; w[1]=(int32)117; }
 
-	interm=(randw[0]*(int32)254754+randw[1]*(int32)529562)%(int32)999563;
-	randw[1]=randw[0];
-	randw[0]=interm;
+	interm=(w[0]*(int32)254754+w[1]*(int32)529562)%(int32)999563;
+	w[1]=w[0];
+	w[0]=interm;
 	return(interm);
 }
 /****************************
@@ -678,6 +865,88 @@ unsigned long encl_bitSetup(long bitfieldarraysize, long bitoparraysize)
 
 }
 
+/*************************
+** DoBitfieldIteration **
+**************************
+** Walk the whole offset/run length array in enclave_buffer2
+** without leaving the enclave.  Same operation mix as the
+** untrusted loop in nbench1.c, so the two modes only differ
+** in the number of enclave transitions.
+*/
+void encl_DoBitfieldIteration(long bitoparraysize)
+{
+long i;                         /* Index */
+
+for(i=0;i<bitoparraysize;i++)
+{
+	switch(i % 3)
+	{
+		case 0: /* Set run of bits */
+			encl_ToggleBitRun(i+i,i+i+1,1);
+			break;
+
+		case 1: /* Clear run of bits */
+			encl_ToggleBitRun(i+i,i+i+1,0);
+			break;
+
+		case 2: /* Complement run of bits */
+			encl_FlipBitRun(i+i,i+i+1);
+			break;
+	}
+}
+return;
+}
+
+/*****************************
+** DoBitfieldIterationWord **
+******************************
+** encl_DoBitfieldIteration() with the word-at-a-time runs
+** of encl_bitrun.c, using kernel BITKERNEL_xxx.
+*/
+void encl_DoBitfieldIterationWord(long bitoparraysize, int kernel)
+{
+unsigned long *bitmap=(unsigned long *)enclave_buffer;
+unsigned long *ops=(unsigned long *)enclave_buffer2;
+long i;
+
+for(i=0;i<bitoparraysize;i++)
+	bitrun(kernel,bitmap,ops[i+i],ops[i+i+1],(int)(i % 3));
+return;
+}
+
+/*
+** Check the word-at-a-time runs against the bit-by-bit ones
+** on the loaded bitmap and operations: run both from the
+** same bitmap and compare.  The bitmap is left as the
+** word-at-a-time run leaves it.  Returns 0, or -1 on a
+** mismatch or if there is no room for the copies.
+*/
+int encl_checkBitfieldWord(long bitfieldarraysize, long bitoparraysize, int kernel)
+{
+unsigned long *bitmap=(unsigned long *)enclave_buffer;
+unsigned long *start, *bybit;
+size_t size=(size_t)bitfieldarraysize*sizeof(unsigned long);
+int status;
+
+start=(unsigned long *)malloc(size);
+bybit=(unsigned long *)malloc(size);
+if(start==NULL || bybit==NULL)
+{
+	free(start);
+	free(bybit);
+	return(-1);
+}
+memcpy(start,bitmap,size);
+encl_DoBitfieldIteration(bitoparraysize);
+memcpy(bybit,bitmap,size);
+memcpy(bitmap,start,size);
+encl_DoBitfieldIterationWord(bitoparraysize,kernel);
+status=memcmp(bybit,bitmap,size)==0 ? 0 : -1;
+free(start);
+free(bybit);
+return(status);
+}
+
 /* Fourier Private Functions */
 /****************
  * ** thefunction **
@@ -1220,6 +1489,7 @@ return;
 }
 
 
+#ifndef ENCLAVE_NATIVE
 /* 
  * printf: 
  *   Invokes OCALL to display the enclave buffer to the terminal.
@@ -1233,6 +1503,21 @@ void printf(const char *fmt, ...)
     va_end(ap);
     ocall_print_string(buf);
 }
+#else
+/*
+ * Built as native code (native.so, for the differential run):
+ * printf is the C library's and there is no OCALL to make.
+ */
+static void ocall_print_string(const char *str)
+{
+    fputs(str, stdout);
+}
+
+static void ocall_yield(void)
+{
+    sched_yield();
+}
+#endif
 
 
 /*************************
@@ -1282,13 +1567,12 @@ return;
 ** integers.  Also pass in minimum and maximum offsets.
 ** This routine performs a heap sort on that array.
 */
-void encl_NumHeapSort( unsigned long base_offset,/* Again, don't pass the array pointer, but we do need an offset. */
+static void NumHeapSortArray(long *array,
 	unsigned long bottom,           /* Lower bound */
 	unsigned long top)              /* Upper bound */
 {
 unsigned long temp;                     /* Used to exchange elements */
 unsigned long i;                        /* Loop index */
-long *array = (long*)enclave_buffer+base_offset;
 
 /*
 ** First, build a heap in the array
@@ -1310,6 +1594,362 @@ for(i=top; i>0; --i)
 return;
 }
 
+void encl_NumHeapSort( unsigned long base_offset,/* Again, don't pass the array pointer, but we do need an offset. */
+	unsigned long bottom,           /* Lower bound */
+	unsigned long top)              /* Upper bound */
+{
+NumHeapSortArray((long*)enclave_buffer+base_offset,bottom,top);
+}
+
+/*****************
+** NumRadixSort **
+******************
+** LSD radix sort of n longs, a byte per pass, through
+** scratch (n longs).  The counts of all eight bytes are
+** taken in one pass over the array; a pass whose byte is the
+** same in every key moves nothing and is skipped, which for
+** the 32-bit values of the test leaves four passes.
+*/
+static void NumRadixSort(long *array, long *scratch, unsigned long n)
+{
+unsigned long count[8][256];            /* Keys per byte value */
+unsigned long offset[256];
+unsigned long key, i;
+long *src, *dst, *tmp;
+int pass, b;
+
+memset(count,0,sizeof(count));
+for(i=0;i<n;i++)
+{       /* Flip the sign bit so signed order is unsigned order */
+	key=(unsigned long)array[i]^(1UL<<63);
+	for(pass=0;pass<8;pass++)
+		count[pass][(key>>(8*pass)) & 0xFF]++;
+}
+
+src=array;
+dst=scratch;
+for(pass=0;pass<8;pass++)
+{       key=((unsigned long)src[0]^(1UL<<63))>>(8*pass) & 0xFF;
+	if(count[pass][key]==n)
+		continue;
+	offset[0]=0;
+	for(b=1;b<256;b++)
+		offset[b]=offset[b-1]+count[pass][b-1];
+	for(i=0;i<n;i++)
+	{       key=((unsigned long)src[i]^(1UL<<63))>>(8*pass) & 0xFF;
+		dst[offset[key]++]=src[i];
+	}
+	tmp=src; src=dst; dst=tmp;
+}
+if(src!=array)
+	memcpy(array,src,n*sizeof(long));
+return;
+}
+
+/*
+** Numeric Sort (PAR).  encl_sortpool_run() sorts every
+** array in one ECALL.  Helper threads of the App park in
+** encl_sortpool_worker() for the whole test and join each
+** run.  Each participant owns a range of the arrays, takes
+** arrays from its end and, once it is empty, steals from
+** the front of the others' ranges; a helper that is late
+** simply has its arrays stolen.
+** A run is open while its generation is odd.  A helper
+** counts itself busy and then checks the run is still open,
+** and the caller closes the run before it waits for the
+** busy count to drop to zero, so no helper is left in a
+** run once the next one is set up.
+** There is one pool per thread slot (-threads=N).
+*/
+#define SORTSPINS 1024          /* Spins between yields */
+
+typedef struct {
+	int lock;
+	unsigned long front, back;      /* Arrays [front,back) left */
+} SortRange;
+
+typedef struct {
+	long *base;                     /* First array */
+	unsigned long arraysize;
+	int algo;                       /* SORT_xxx */
+	int nparts;                     /* Caller + helpers */
+	SortRange range[SORTMAXWORKERS];
+	long *scratch[SORTMAXWORKERS];  /* Radix sort buffers */
+	unsigned long generation;       /* Odd while a run is open */
+	unsigned long done;             /* Arrays sorted in the run */
+	int busy;                       /* Helpers in the run */
+	int stop;                       /* Helpers return */
+} SortPool;
+
+static SortPool sortpool[MAXTHREADS];
+
+/* Spin with pause, giving up the CPU now and then */
+static void sortpool_backoff(int *spins)
+{
+	if(++*spins<SORTSPINS)
+		__builtin_ia32_pause();
+	else
+	{
+		ocall_yield();
+		*spins=0;
+	}
+}
+
+/*
+** Next array for participant part: the back of its own
+** range, else the front of another's.  Returns 0, or -1
+** when no array is left.
+*/
+static int sortpool_take(SortPool *pool, int part, unsigned long *index)
+{
+	SortRange *r;
+	int spins, k;
+
+	for(k=0;k<pool->nparts;k++)
+	{
+		r=&pool->range[(part+k)%pool->nparts];
+		spins=0;
+		while(__atomic_exchange_n(&r->lock,1,__ATOMIC_ACQUIRE))
+			sortpool_backoff(&spins);
+		if(r->front<r->back)
+		{
+			*index=(k==0) ? --r->back : r->front++;
+			__atomic_store_n(&r->lock,0,__ATOMIC_RELEASE);
+			return(0);
+		}
+		__atomic_store_n(&r->lock,0,__ATOMIC_RELEASE);
+	}
+	return(-1);
+}
+
+/* Sort arrays until none is left */
+static void sortpool_work(SortPool *pool, int part)
+{
+	unsigned long index;
+	long *array;
+
+	while(sortpool_take(pool,part,&index)==0)
+	{
+		array=pool->base+index*pool->arraysize;
+		if(pool->algo==SORT_RADIX)
+			NumRadixSort(array,pool->scratch[part],pool->arraysize);
+		else
+			NumHeapSortArray(array,0L,pool->arraysize-1L);
+		__atomic_add_fetch(&pool->done,1,__ATOMIC_RELEASE);
+	}
+}
+
+void encl_sortpool_stop(void)
+{
+	SortPool *pool=&sortpool[encl_slot];
+
+	__atomic_store_n(&pool->stop,1,__ATOMIC_SEQ_CST);
+}
+
+/*
+** Set up the pool of the calling thread's slot for arrays of
+** arraysize longs, nparts participants and algorithm algo.
+** Returns the pool for encl_sortpool_worker(), or -1 if the
+** arguments are bad or the radix buffers do not fit.
+*/
+int encl_sortpool_start(unsigned long arraysize, int nparts, int algo)
+{
+	SortPool *pool=&sortpool[encl_slot];
+	int i;
+
+	if(nparts<1 || nparts>SORTMAXWORKERS || arraysize==0)
+		return(-1);
+	for(i=0;i<SORTMAXWORKERS;i++)
+	{
+		free(pool->scratch[i]);
+		pool->scratch[i]=NULL;
+	}
+	if(algo==SORT_RADIX)
+		for(i=0;i<nparts;i++)
+		{
+			pool->scratch[i]=(long *)malloc(arraysize*sizeof(long));
+			if(pool->scratch[i]==NULL)
+				return(-1);
+		}
+	pool->arraysize=arraysize;
+	pool->algo=algo;
+	pool->nparts=nparts;
+	pool->generation=0;
+	pool->done=0;
+	pool->busy=0;
+	pool->stop=0;
+	return(encl_slot);
+}
+
+/*
+** Body of helper part (1 to nparts-1) of pool id: join every
+** run until encl_sortpool_stop().  Returns 0, or -1 on bad
+** arguments.
+*/
+int encl_sortpool_worker(int id, int part)
+{
+	SortPool *pool;
+	unsigned long seen, gen;
+	int spins;
+
+	if(id<0 || id>=MAXTHREADS)
+		return(-1);
+	pool=&sortpool[id];
+	if(part<1 || part>=pool->nparts)
+		return(-1);
+	seen=0;
+	spins=0;
+	while(!__atomic_load_n(&pool->stop,__ATOMIC_ACQUIRE))
+	{
+		gen=__atomic_load_n(&pool->generation,__ATOMIC_ACQUIRE);
+		if((gen & 1)==0 || gen==seen)
+		{
+			sortpool_backoff(&spins);
+			continue;
+		}
+		__atomic_add_fetch(&pool->busy,1,__ATOMIC_SEQ_CST);
+		if(__atomic_load_n(&pool->generation,__ATOMIC_SEQ_CST)==gen)
+			sortpool_work(pool,part);
+		__atomic_sub_fetch(&pool->busy,1,__ATOMIC_SEQ_CST);
+		seen=gen;
+		spins=0;
+	}
+	return(0);
+}
+
+/*
+** Sort numarrays arrays of the calling thread's
+** enclave_buffer with its pool.  Returns 0, or -1 if the
+** pool is not set up.
+*/
+int encl_sortpool_run(unsigned long numarrays)
+{
+	SortPool *pool=&sortpool[encl_slot];
+	unsigned long per, extra, next;
+	int i, spins;
+
+	if(pool->nparts<1)
+		return(-1);
+	pool->base=(long *)enclave_buffer;
+	per=numarrays/pool->nparts;
+	extra=numarrays%pool->nparts;
+	next=0;
+	for(i=0;i<pool->nparts;i++)
+	{
+		pool->range[i].lock=0;
+		pool->range[i].front=next;
+		next+=per+((unsigned long)i<extra ? 1 : 0);
+		pool->range[i].back=next;
+	}
+	pool->done=0;
+	__atomic_add_fetch(&pool->generation,1,__ATOMIC_SEQ_CST);    /* Open */
+
+	sortpool_work(pool,0);
+	spins=0;
+	while(__atomic_load_n(&pool->done,__ATOMIC_ACQUIRE)<numarrays)
+		sortpool_backoff(&spins);
+
+	__atomic_add_fetch(&pool->generation,1,__ATOMIC_SEQ_CST);    /* Close */
+	while(__atomic_load_n(&pool->busy,__ATOMIC_SEQ_CST)!=0)
+		sortpool_backoff(&spins);
+	return(0);
+}
+
+/*
+** Pool of parked helpers (encl_workpool.h).  Units are
+** taken off pool->next; a helper counts itself busy and then
+** checks the run is still open, as in the sort pool, so
+** next and done can be reset once busy is back to zero.
+*/
+void workpool_start(WorkPool *pool, int id,
+	void (*unit)(int id, unsigned long u))
+{
+	pool->unit=unit;
+	pool->id=id;
+	pool->nunits=0;
+	pool->next=0;
+	pool->done=0;
+	pool->generation=0;
+	pool->busy=0;
+	pool->stop=0;
+}
+
+/* Do units of the open run until none is left */
+static void workpool_work(WorkPool *pool)
+{
+	unsigned long u;
+
+	while((u=__atomic_fetch_add(&pool->next,1,__ATOMIC_ACQ_REL))<
+	  pool->nunits)
+	{
+		pool->unit(pool->id,u);
+		__atomic_add_fetch(&pool->done,1,__ATOMIC_RELEASE);
+	}
+}
+
+void workpool_worker(WorkPool *pool)
+{
+	unsigned long seen, gen;
+	int spins;
+
+	seen=0;
+	spins=0;
+	while(!__atomic_load_n(&pool->stop,__ATOMIC_ACQUIRE))
+	{
+		gen=__atomic_load_n(&pool->generation,__ATOMIC_ACQUIRE);
+		if((gen & 1)==0 || gen==seen)
+		{
+			sortpool_backoff(&spins);
+			continue;
+		}
+		__atomic_add_fetch(&pool->busy,1,__ATOMIC_SEQ_CST);
+		if(__atomic_load_n(&pool->generation,__ATOMIC_SEQ_CST)==gen)
+			workpool_work(pool);
+		__atomic_sub_fetch(&pool->busy,1,__ATOMIC_SEQ_CST);
+		seen=gen;
+		spins=0;
+	}
+}
+
+void workpool_run(WorkPool *pool, unsigned long nunits)
+{
+	int spins;
+
+	pool->nunits=nunits;
+	pool->next=0;
+	pool->done=0;
+	__atomic_add_fetch(&pool->generation,1,__ATOMIC_SEQ_CST);    /* Open */
+
+	workpool_work(pool);
+	spins=0;
+	while(__atomic_load_n(&pool->done,__ATOMIC_ACQUIRE)<nunits)
+		sortpool_backoff(&spins);
+
+	__atomic_add_fetch(&pool->generation,1,__ATOMIC_SEQ_CST);    /* Close */
+	while(__atomic_load_n(&pool->busy,__ATOMIC_SEQ_CST)!=0)
+		sortpool_backoff(&spins);
+}
+
+void workpool_stop(WorkPool *pool)
+{
+	__atomic_store_n(&pool->stop,1,__ATOMIC_SEQ_CST);
+}
+
+/*
+** 0 if each of the numarrays arrays of arraysize longs in
+** enclave_buffer is in ascending order, else -1.
+*/
+int encl_NumSortCheck(unsigned long arraysize, unsigned long numarrays)
+{
+	long *array=(long *)enclave_buffer;
+	unsigned long i, j;
+
+	for(j=0;j<numarrays;j++,array+=arraysize)
+		for(i=1;i<arraysize;i++)
+			if(array[i-1]>array[i])
+				return(-1);
+	return(0);
+}
 
 void test_function(const char *str){
     printf(str);
@@ -1323,6 +1963,67 @@ void nothing(){
     return;
 }
 
+/*
+ * Transition microbenchmarks, together with nothing() above for
+ * the empty ECALL.  The bodies are empty on purpose:
+ * what is measured is the EENTER/EEXIT (or switchless hand-off)
+ * plus the marshalling edger8r generates for each buffer kind.
+ */
+void encl_ecall_in(const void *buf, size_t len){
+    (void)buf; (void)len;
+}
+
+void encl_ecall_out(void *buf, size_t len){
+    (void)buf; (void)len;
+}
+
+void encl_ecall_user_check(void *buf, size_t len){
+    (void)buf; (void)len;
+}
+
+/* Issue count empty OCALLs back to back; the App timestamps each arrival */
+void encl_ocall_loop(unsigned long count){
+    while(count--)
+        ocall_print_string("");
+}
+
+/*
+** Hash of the strings encl_LoadStringArray() made, one per slot.
+*/
+static unsigned long long strsort_strings[MAXTHREADS];
+
+/*
+** Hash of which strings an array holds, in any order: the
+** sum of a hash of each (its length byte and bytes, FNV-1a
+** and a final mix), so dropping, doubling or changing a
+** string changes it.
+*/
+static unsigned long long str_multiset(farulong *optrarray,
+	faruchar *strarray, unsigned long nstrings)
+{
+	unsigned long long sum, h;
+	unsigned long j;
+	faruchar *s;
+	int n;
+
+	sum=0;
+	for(j=0;j<nstrings;j++)
+	{
+		s=strarray+optrarray[j];
+		h=14695981039346656037ULL;
+		for(n=0;n<=(int)s[0];n++)
+		{
+			h^=(unsigned long long)s[n];
+			h*=1099511628211ULL;
+		}
+		h^=h>>33;
+		h*=0xff51afd7ed558ccdULL;
+		h^=h>>33;
+		sum+=h;
+	}
+	return(sum);
+}
+
 unsigned long encl_LoadStringArray(unsigned int numarrays,unsigned long arraysize)          
 {
 	unsigned long *optrarray;
@@ -1412,15 +2113,14 @@ while(k<numarrays)
 ** offset pointer array.
 */
 
-encl_AllocateMemory2(nstrings * sizeof(unsigned long) * numarrays);
+/*
+** No room: report no strings.
+*/
+if(encl_AllocateMemory2(nstrings * sizeof(unsigned long) * numarrays)!=0)
+	return(0);
 
 optrarray=(farulong *)enclave_buffer2;
 
-if(!optrarray)
-{     
-        printf("FATAL: Enclave malloc returned NULL pointer\n");
-}
-
 /*
 ** Go through the newly-built string array, building
 ** offsets and putting them into the offset pointer
@@ -1446,10 +2146,13 @@ while(k<numarrays)
 }
 
 /*
-** All done...go home.  Pass local pointer back.
+** Remember which strings there are, for encl_StrSortCheck().
 */
-enclave_buffer2=(void *)optrarray;
+strsort_strings[encl_slot]=str_multiset(optrarray,strarray,nstrings);
 
+/*
+** All done...go home.
+*/
 //printf("%lu\n",nstrings);
 return(nstrings);
 }
@@ -1544,14 +2247,221 @@ void encl_call_StrHeapSort(unsigned long nstrings, unsigned int numarrays, unsig
 
 }
 
-/************************
-** DoFPUTransIteration **
-*************************
-** Perform an iteration of the FPU Transcendental/trigonometric
-** benchmark.  Here, an iteration consists of calculating the
-** first n fourier coefficients of the function (x+1)^x on
-** the interval 0,2.  n is given by arraysize.
-** NOTE: The # of integration steps is fixed at
+/*
+** String Sort (KEY).  Each string becomes a 16-byte element:
+** the first bytes str_is_less() would compare, packed
+** big-endian into a key so that comparing keys as integers
+** gives the same order, and the string's offset.  The
+** elements are sorted in one contiguous array, and a string
+** is only looked at when two keys tie.  The strings are then
+** copied once, in order, into a scratch array and back, and
+** the offsets rebuilt.
+*/
+#define STRKEYCUTOFF 16         /* Insertion sort below this */
+
+typedef struct {
+	unsigned long key;              /* Leading bytes, big-endian */
+	unsigned long offset;           /* Offset of the string */
+} StrKey;
+
+/*
+** Key of the string at s.  str_is_less() compares
+** min(length) bytes from the length byte on with strncmp(),
+** so strings of different lengths are ordered by length,
+** and strncmp() stops at a NUL: the bytes past the length
+** or past a NUL are left 0.  An empty string is put after
+** every other, as str_is_less() does.
+*/
+static unsigned long str_key(const unsigned char *s)
+{
+	unsigned long key=0;
+	int len=s[0];
+	int i, b;
+
+	if(len==0)
+		return(~0UL);
+	for(i=0;i<8;i++)
+	{
+		b=(i<len) ? s[i] : 0;
+		if(b==0)
+		{
+			key<<=8*(8-i);
+			break;
+		}
+		key=(key<<8) | (unsigned long)b;
+	}
+	return(key);
+}
+
+/*
+** TRUE if a sorts before b.  Equal keys mean equal strings
+** unless the key holds 8 bytes of a longer string with no
+** NUL; then the rest is compared.
+*/
+static int strkey_less(const StrKey *a, const StrKey *b,
+	const unsigned char *strarray)
+{
+	const unsigned char *sa, *sb;
+	int len;
+
+	if(a->key!=b->key)
+		return(a->key<b->key);
+	sa=strarray+a->offset;
+	sb=strarray+b->offset;
+	len=sa[0];
+	if(len<=8 || (a->key & 0xFF)==0)
+		return(FALSE);
+	return(strncmp((const char *)sa+8,(const char *)sb+8,len-8)<0);
+}
+
+/*
+** Quicksort with a median-of-three pivot, recursing on the
+** smaller part; short runs are finished by insertion.
+*/
+static void strkey_sort(StrKey *a, long n, const unsigned char *strarray)
+{
+	StrKey pivot, t;
+	long i, j, mid;
+
+	while(n>STRKEYCUTOFF)
+	{
+		mid=n/2;
+		if(strkey_less(&a[mid],&a[0],strarray))
+			{ t=a[mid]; a[mid]=a[0]; a[0]=t; }
+		if(strkey_less(&a[n-1],&a[mid],strarray))
+		{
+			t=a[n-1]; a[n-1]=a[mid]; a[mid]=t;
+			if(strkey_less(&a[mid],&a[0],strarray))
+				{ t=a[mid]; a[mid]=a[0]; a[0]=t; }
+		}
+		pivot=a[mid];
+
+		/* a[0] and a[n-1] stop the scans */
+		i=0;
+		j=n-1;
+		for(;;)
+		{
+			do i++; while(strkey_less(&a[i],&pivot,strarray));
+			do j--; while(strkey_less(&pivot,&a[j],strarray));
+			if(i>=j)
+				break;
+			t=a[i]; a[i]=a[j]; a[j]=t;
+		}
+
+		/* a[0..i-1] <= pivot <= a[i..n-1] */
+		if(i<n-i)
+		{
+			strkey_sort(a,i,strarray);
+			a+=i;
+			n-=i;
+		}
+		else
+		{
+			strkey_sort(a+i,n-i,strarray);
+			n=i;
+		}
+	}
+
+	for(i=1;i<n;i++)
+	{
+		t=a[i];
+		for(j=i;j>0 && strkey_less(&t,&a[j-1],strarray);j--)
+			a[j]=a[j-1];
+		a[j]=t;
+	}
+}
+
+/*
+** Sort each of the numarrays string arrays built by
+** encl_LoadStringArray().  Returns 0, or -1 if the element
+** and scratch arrays do not fit in the enclave heap.
+*/
+int encl_call_StrKeySort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize)
+{
+	farulong *optrarray;
+	faruchar *strarray;
+	StrKey *keys;
+	unsigned char *scratch;
+	unsigned long j, off, len;
+
+	keys=(StrKey *)malloc(nstrings*sizeof(StrKey));
+	scratch=(unsigned char *)malloc(arraysize+100);
+	if(keys==NULL || scratch==NULL)
+	{
+		free(keys);
+		free(scratch);
+		return(-1);
+	}
+
+	optrarray=(unsigned long *)enclave_buffer2;
+	strarray=(unsigned char *)enclave_buffer;
+	for(unsigned int i=0;i<numarrays;i++)
+	{
+		for(j=0;j<nstrings;j++)
+		{
+			keys[j].key=str_key(strarray+optrarray[j]);
+			keys[j].offset=optrarray[j];
+		}
+		strkey_sort(keys,(long)nstrings,strarray);
+
+		/* Lay the strings out in order */
+		off=0;
+		for(j=0;j<nstrings;j++)
+		{
+			len=(unsigned long)strarray[keys[j].offset]+1L;
+			memcpy(scratch+off,strarray+keys[j].offset,len);
+			optrarray[j]=off;
+			off+=len;
+		}
+		memcpy(strarray,scratch,off);
+
+		optrarray+=nstrings;    /* Advance base pointers */
+		strarray+=arraysize+100;
+	}
+	free(keys);
+	free(scratch);
+	return(0);
+}
+
+/*
+** 0 if each string array is in str_is_less() order and
+** holds the strings encl_LoadStringArray() put in it, each
+** once, else -1.
+*/
+int encl_StrSortCheck(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize)
+{
+	farulong *optrarray;
+	faruchar *strarray;
+	unsigned long j;
+
+	optrarray=(unsigned long *)enclave_buffer2;
+	strarray=(unsigned char *)enclave_buffer;
+	for(unsigned int i=0;i<numarrays;i++)
+	{
+		for(j=0;j<nstrings;j++)
+			if(optrarray[j]>=arraysize ||
+			  optrarray[j]+strarray[optrarray[j]]>=arraysize+100)
+				return(-1);
+		for(j=1;j<nstrings;j++)
+			if(str_is_less(optrarray,strarray,nstrings,j,j-1))
+				return(-1);
+		if(str_multiset(optrarray,strarray,nstrings)!=
+		  strsort_strings[encl_slot])
+			return(-1);
+		optrarray+=nstrings;
+		strarray+=arraysize+100;
+	}
+	return(0);
+}
+
+/************************
+** DoFPUTransIteration **
+*************************
+** Perform an iteration of the FPU Transcendental/trigonometric
+** benchmark.  Here, an iteration consists of calculating the
+** first n fourier coefficients of the function (x+1)^x on
+** the interval 0,2.  n is given by arraysize.
+** NOTE: The # of integration steps is fixed at
 ** 200.
 */
 void encl_DoFPUTransIteration(ulong arraysize)                /* # of coeffs */
@@ -1617,6 +2527,211 @@ void encl_DoFPUTransIteration(ulong arraysize)                /* # of coeffs */
 #endif
 }
 
+/*
+** Fourier (SIMD): the coefficients of encl_DoFPUTransIteration(),
+** a block of them at a time.  The integrand is evaluated on
+** the very points TrapezoidIntegrate() uses, so (x+1)**x and
+** the trapezoid weights are computed once, with vm_log() and
+** vm_exp(); each point then takes one vm_sincos() over the
+** block of coefficients.  encl_fourier_run() hands the
+** coefficients out FOURUNIT at a time to the calling thread
+** and the helpers parked in encl_fourier_worker(), into the
+** A[] and B[] buffers the run was handed.
+** There is one table and pool per thread slot (-threads=N).
+*/
+#define FOURSTEPS 200           /* As in encl_DoFPUTransIteration() */
+#define FOURBLOCK 256           /* Coefficients per block */
+#define FOURUNIT 64             /* Coefficients per unit of the pool */
+
+typedef struct {
+	int level;                      /* SIMD_xxx */
+	int npoints;
+	unsigned long arraysize;        /* Coefficients of the run */
+	double *abase;                  /* A[] of the run */
+	double *bbase;                  /* B[] of the run */
+	double dx;
+	double x[FOURSTEPS+1];          /* Points */
+	double wf[FOURSTEPS+1];         /* Weight times (x+1)**x */
+} FourierTable;
+
+static FourierTable fouriertab[MAXTHREADS];
+static WorkPool fourierpool[MAXTHREADS];
+
+static void fourier_unit(int id, unsigned long u);
+
+/*
+** Set up the table and pool of the calling thread's slot.
+** Returns the slot, for encl_fourier_worker().
+*/
+int encl_fourier_start(int level)
+{
+	FourierTable *t=&fouriertab[encl_slot];
+	double xp1[FOURSTEPS+1], lg[FOURSTEPS+1];
+	double x;
+	int nsteps, k;
+
+	/*
+	** TrapezoidIntegrate() takes x0, then x0+dx added up
+	** nsteps-2 times, then x1; each inner point weighs 1,
+	** the ends 1/2.
+	*/
+	t->level=level;
+	t->dx=((double)2.0-(double)0.0)/(double)FOURSTEPS;
+	k=0;
+	x=(double)0.0;
+	t->x[k++]=x;
+	for(nsteps=FOURSTEPS-1;--nsteps;)
+	{
+		x+=t->dx;
+		t->x[k++]=x;
+	}
+	t->x[k++]=(double)2.0;
+	t->npoints=k;
+	for(k=0;k<t->npoints;k++)
+		xp1[k]=t->x[k]+(double)1.0;
+	vm_log(level,xp1,lg,t->npoints);
+	for(k=0;k<t->npoints;k++)
+		lg[k]*=t->x[k];
+	vm_exp(level,lg,t->wf,t->npoints);
+	t->wf[0]/=(double)2.0;
+	t->wf[t->npoints-1]/=(double)2.0;
+	workpool_start(&fourierpool[encl_slot],encl_slot,fourier_unit);
+	return(encl_slot);
+}
+
+/*
+** Coefficients [first,last) of the table and run of slot id.
+*/
+static void fourier_range(int id, unsigned long first, unsigned long last)
+{
+	FourierTable *t=&fouriertab[id];
+	double *abase=t->abase;
+	double *bbase=t->bbase;
+	double omegan[FOURBLOCK], arg[FOURBLOCK];
+	double s[FOURBLOCK], c[FOURBLOCK];
+	double suma[FOURBLOCK], sumb[FOURBLOCK];
+	double omega;
+	unsigned long i0;
+	long len, j;
+	int k;
+
+	omega=(double)3.1415926535897932;
+	for(i0=first;i0<last;i0+=FOURBLOCK)
+	{
+		len=last-i0<FOURBLOCK ? (long)(last-i0) : FOURBLOCK;
+		for(j=0;j<len;j++)
+		{
+			omegan[j]=omega*(double)(i0+j);
+			suma[j]=sumb[j]=(double)0.0;
+		}
+		for(k=0;k<t->npoints;k++)
+		{
+			for(j=0;j<len;j++)
+				arg[j]=omegan[j]*t->x[k];
+			vm_sincos(t->level,arg,s,c,len);
+			for(j=0;j<len;j++)
+			{
+				suma[j]+=t->wf[k]*c[j];
+				sumb[j]+=t->wf[k]*s[j];
+			}
+		}
+		for(j=0;j<len;j++)
+		{
+			abase[i0+j]=suma[j]*t->dx;
+			bbase[i0+j]=sumb[j]*t->dx;
+		}
+	}
+}
+
+/* Coefficients FOURUNIT*u+1 on of slot id */
+static void fourier_unit(int id, unsigned long u)
+{
+	unsigned long first, last;
+
+	first=1+u*FOURUNIT;
+	last=fouriertab[id].arraysize-first<FOURUNIT ?
+		fouriertab[id].arraysize : first+FOURUNIT;
+	fourier_range(id,first,last);
+}
+
+/*
+** Body of a helper of the pool of slot id, until
+** encl_fourier_stop().  Returns 0, or -1 on a bad id.
+*/
+int encl_fourier_worker(int id)
+{
+	if(id<0 || id>=MAXTHREADS)
+		return(-1);
+	workpool_worker(&fourierpool[id]);
+	return(0);
+}
+
+/*
+** The arraysize coefficients into the buffers of handles a
+** and b, A[0] here and the rest with the pool of the calling
+** thread's slot.  Returns 0, or -1 if encl_fourier_start()
+** was not called or a handle is bad.
+*/
+int encl_fourier_run(unsigned long arraysize, int a, int b)
+{
+	FourierTable *t=&fouriertab[encl_slot];
+	double sum;
+	int k;
+
+	if(t->npoints==0 || arraysize==0)
+		return(-1);
+	t->abase=(double *)buf_get(a,arraysize*sizeof(double));
+	t->bbase=(double *)buf_get(b,arraysize*sizeof(double));
+	if(t->abase==NULL || t->bbase==NULL)
+		return(-1);
+	sum=(double)0.0;
+	for(k=0;k<t->npoints;k++)
+		sum+=t->wf[k];
+	t->abase[0]=sum*t->dx/(double)2.0;
+	t->arraysize=arraysize;
+	workpool_run(&fourierpool[encl_slot],(arraysize-1+FOURUNIT-1)/FOURUNIT);
+	return(0);
+}
+
+void encl_fourier_stop(void)
+{
+	workpool_stop(&fourierpool[encl_slot]);
+}
+
+/*
+** Check the coefficients in the buffers of handles a and b
+** against TrapezoidIntegrate().  Returns 0, or -1 if one is
+** off by more than FOURCHECKTOL (relative to 1 + its size)
+** or a handle is bad.
+*/
+int encl_fourier_check(unsigned long arraysize, int a, int b)
+{
+	double *abase=(double *)buf_get(a,arraysize*sizeof(double));
+	double *bbase=(double *)buf_get(b,arraysize*sizeof(double));
+	double omega, ref;
+	unsigned long i;
+
+	if(abase==NULL || bbase==NULL)
+		return(-1);
+	ref=TrapezoidIntegrate((double)0.0,(double)2.0,FOURSTEPS,
+		(double)0.0,0)/(double)2.0;
+	if(fabs(abase[0]-ref)>FOURCHECKTOL*((double)1.0+fabs(ref)))
+		return(-1);
+	omega=(double)3.1415926535897932;
+	for(i=1;i<arraysize;i++)
+	{
+		ref=TrapezoidIntegrate((double)0.0,(double)2.0,FOURSTEPS,
+			omega*(double)i,1);
+		if(fabs(abase[i]-ref)>FOURCHECKTOL*((double)1.0+fabs(ref)))
+			return(-1);
+		ref=TrapezoidIntegrate((double)0.0,(double)2.0,FOURSTEPS,
+			omega*(double)i,2);
+		if(fabs(bbase[i]-ref)>FOURCHECKTOL*((double)1.0+fabs(ref)))
+			return(-1);
+	}
+	return(0);
+}
+
 ////////////////////////////Assignment Begin////////////////////////////////////////////////
 
 /***************
@@ -2008,6 +3123,58 @@ for(int i=0;i<numarrays;i++)
 
 }
 
+/*
+** Assignment (JV).  The ECALLs are handed the buffers of the
+** n x n costs, the duals u and v (duals), the assignment both
+** ways (perm) and the scratch of assign_solve(); a handle
+** that is bad, or too small for n, fails the call.
+*/
+#define ASSIGNSCRATCH(n) ((size_t)3*(size_t)(n)*sizeof(long)+(size_t)(n))
+
+int encl_assign_build(long n, int costs)
+{
+long *c=(long *)buf_get(costs,(size_t)n*(size_t)n*sizeof(long));
+long i;
+
+if(c==NULL)
+	return(-1);
+randnum((int32)13);
+for(i=0;i<n*n;i++)
+	c[i]=abs_randwc((int32)5000000);
+return(0);
+}
+
+/*
+** Solve the assignment from scratch; returns its cost, or -1
+** on a bad handle.
+*/
+long encl_assign_solve(long n, int costs, int duals, int perm, int scratch)
+{
+const long *c=(const long *)buf_get(costs,(size_t)n*(size_t)n*sizeof(long));
+long *uv=(long *)buf_get(duals,(size_t)2*(size_t)n*sizeof(long));
+long *p=(long *)buf_get(perm,(size_t)2*(size_t)n*sizeof(long));
+long *w=(long *)buf_get(scratch,ASSIGNSCRATCH(n));
+
+if(c==NULL || uv==NULL || p==NULL || w==NULL)
+	return(-1);
+return(assign_solve(c,n,uv,uv+n,p,p+n,w,(char *)(w+3*n)));
+}
+
+/*
+** Check the last solution against its duals; returns 0, or
+** -1 if they do not prove it the cheapest or a handle is bad.
+*/
+int encl_assign_check(long n, long cost, int costs, int duals, int perm)
+{
+const long *c=(const long *)buf_get(costs,(size_t)n*(size_t)n*sizeof(long));
+const long *uv=(const long *)buf_get(duals,(size_t)2*(size_t)n*sizeof(long));
+const long *p=(const long *)buf_get(perm,(size_t)2*(size_t)n*sizeof(long));
+
+if(c==NULL || uv==NULL || p==NULL)
+	return(-1);
+return(assign_check(c,n,uv,uv+n,p,p+n,cost));
+}
+
 void encl_app_loadIDEA(unsigned long arraysize)
 {faruchar *plain1;
 	
@@ -2113,27 +3280,271 @@ void encl_callIDEA(unsigned long arraysize, unsigned short * Z, unsigned short *
 
 		for(j=0;j<arraysize;j+=(sizeof(u16)*4))
 			cipher_idea(((u16 *)(crypt1+j)),((u16 *)(plain2+j)),DK);      /* Decrypt */
-	}	
+	}
 }
-/* Neural Net */
-void encl_set_numpats(int npats)
+
+/*
+** Vectorized IDEA: the blocks are run through idea_simd()
+** a group at a time, and the few left over through
+** cipher_idea().  level is one of the SIMD_xxx constants.
+*/
+static void cipher_idea_simd(int level, u16 *in, u16 *out,
+		ulong nblocks, IDEAkey Z)
 {
-    numpats = npats;
+	ulong done;
+
+	done=idea_simd(level,in,out,nblocks,Z);
+	for(;done<nblocks;done++)
+		cipher_idea(in+4*done,out+4*done,Z);
+}
+
+void encl_callIDEAsimd(unsigned long arraysize, unsigned short * Z, unsigned short * DK, unsigned long nloops, int level)
+{
+	u16 *plain1;
+	u16 *crypt1;
+	u16 *plain2;
+	ulong nblocks;
+
+	plain1=(u16 *)enclave_buffer;
+	crypt1=(u16 *)enclave_buffer2;
+	plain2=(u16 *)enclave_buffer3;
+	nblocks=arraysize/IDEABLOCKSIZE;
+
+	for(ulong i=0;i<nloops;i++)
+	{
+		cipher_idea_simd(level,plain1,crypt1,nblocks,Z);      /* Encrypt */
+		cipher_idea_simd(level,crypt1,plain2,nblocks,DK);     /* Decrypt */
+	}
+}
+
+/*
+** Check the vectorized IDEA against cipher_idea() on the
+** loaded plaintext: the ciphertexts must be bit-identical,
+** and decrypting must give the plaintext back.  Returns 0,
+** or -1 on a mismatch.
+*/
+int encl_checkIDEAsimd(unsigned long arraysize, unsigned short * Z, unsigned short * DK, int level)
+{
+	u16 *plain1;
+	u16 *crypt1;
+	u16 *plain2;
+	ulong nblocks;
+	ulong j;
+
+	plain1=(u16 *)enclave_buffer;
+	crypt1=(u16 *)enclave_buffer2;
+	plain2=(u16 *)enclave_buffer3;
+	nblocks=arraysize/IDEABLOCKSIZE;
+
+	for(j=0;j<nblocks;j++)
+		cipher_idea(plain1+4*j,crypt1+4*j,Z);
+	cipher_idea_simd(level,plain1,plain2,nblocks,Z);
+	if(memcmp(crypt1,plain2,nblocks*IDEABLOCKSIZE)!=0)
+		return(-1);
+
+	cipher_idea_simd(level,crypt1,plain2,nblocks,DK);
+	if(memcmp(plain1,plain2,nblocks*IDEABLOCKSIZE)!=0)
+		return(-1);
+	return(0);
+}
+
+/*
+** Streaming IDEA.  The App streams len bytes from an
+** untrusted buffer through the enclave and back out, a chunk
+** at a time.  Three stages -- copy-in, cipher, copy-out --
+** each run as an ECALL on a thread of their own and hand
+** chunks on through two rings of STREAMSLOTS enclave
+** buffers, so the copies overlap the cipher.  A stage waits
+** for its neighbours by spinning on their chunk counters and
+** gives up the CPU now and then with an OCALL.
+*/
+#define STREAMSPINS 1024        /* Spins between yields */
+
+static u16 stream_key[KEYLEN];
+static int stream_level;
+static size_t stream_chunk;
+static unsigned char *stream_inring[STREAMSLOTS];
+static unsigned char *stream_outring[STREAMSLOTS];
+static ulong stream_copied;     /* Chunks copied in */
+static ulong stream_ciphered;   /* Chunks ciphered */
+static ulong stream_drained;    /* Chunks copied out */
+static int stream_aborted;
+
+void encl_stream_free(void)
+{
+	for(int i=0;i<STREAMSLOTS;i++)
+	{
+		free(stream_inring[i]);
+		free(stream_outring[i]);
+		stream_inring[i]=NULL;
+		stream_outring[i]=NULL;
+	}
+	stream_chunk=0;
+}
+
+/*
+** Set up the rings for chunks of chunk bytes.  Returns 0,
+** or -1 if they do not fit in the enclave heap.
+*/
+int encl_stream_init(size_t chunk, unsigned short *Z, int level)
+{
+	encl_stream_free();
+	if(chunk==0 || chunk%IDEABLOCKSIZE!=0)
+		return(-1);
+	for(int i=0;i<STREAMSLOTS;i++)
+	{
+		stream_inring[i]=(unsigned char *)malloc(chunk);
+		stream_outring[i]=(unsigned char *)malloc(chunk);
+		if(stream_inring[i]==NULL || stream_outring[i]==NULL)
+		{
+			encl_stream_free();
+			return(-1);
+		}
+	}
+	memcpy(stream_key,Z,sizeof(stream_key));
+	stream_level=level;
+	stream_chunk=chunk;
+	stream_copied=stream_ciphered=stream_drained=0;
+	stream_aborted=0;
+	return(0);
+}
+
+/*
+** Cipher len bytes of in to out a block at a time with the
+** scalar cipher_idea() and the key of the stream: the output
+** every run of the stream is checked against, as
+** encl_checkIDEAsimd() checks IDEA (SIMD).  Returns 0, or -1
+** on bad arguments.
+*/
+int encl_stream_reference(const void *in, void *out, size_t len)
+{
+	u16 plain[4], crypt[4];
+
+	if(stream_chunk==0 || len%IDEABLOCKSIZE!=0)
+		return(-1);
+	for(size_t i=0;i<len;i+=IDEABLOCKSIZE)
+	{
+		memcpy(plain,(const unsigned char *)in+i,IDEABLOCKSIZE);
+		cipher_idea(plain,crypt,stream_key);
+		memcpy((unsigned char *)out+i,crypt,IDEABLOCKSIZE);
+	}
+	return(0);
 }
 
-double encl_get_in_pats(int patt, int element)
+/* Make the stages still waiting give up; a stage failed to start */
+void encl_stream_abort(void)
 {
-    return in_pats[patt][element];
+	__atomic_store_n(&stream_aborted,1,__ATOMIC_RELEASE);
 }
 
-void encl_set_in_pats(int patt, int element, double val)
+/*
+** Wait until *counter reaches value.  Returns 0, or -1 if
+** the stream was aborted.
+*/
+static int stream_wait(ulong *counter, ulong value)
 {
-    in_pats[patt][element] = val;
+	int spins=0;
+
+	while(__atomic_load_n(counter,__ATOMIC_ACQUIRE)<value)
+	{
+		if(__atomic_load_n(&stream_aborted,__ATOMIC_ACQUIRE))
+			return(-1);
+		if(++spins<STREAMSPINS)
+			__builtin_ia32_pause();
+		else
+		{
+			ocall_yield();
+			spins=0;
+		}
+	}
+	return(0);
 }
 
-void encl_set_out_pats(int patt, int element, double val)
+/*
+** Run one stage of the stream (STREAM_xxx) over len bytes of
+** in, writing the ciphertext to out.  STREAM_SERIAL does the
+** copy-in, cipher and copy-out of each chunk itself.
+** Returns 0, or -1 on bad arguments or an abort.
+*/
+int encl_stream_stage(int stage, const void *in, void *out, size_t len)
+{
+	const unsigned char *src;
+	unsigned char *dst;
+	size_t chunk, n;
+	ulong nchunks, k;
+	int slot;
+
+	chunk=stream_chunk;
+	if(chunk==0 || len%IDEABLOCKSIZE!=0)
+		return(-1);
+#ifndef ENCLAVE_NATIVE
+	if(!sgx_is_outside_enclave(in,len) || !sgx_is_outside_enclave(out,len))
+		return(-1);
+#endif
+	src=(const unsigned char *)in;
+	dst=(unsigned char *)out;
+	nchunks=(len+chunk-1)/chunk;
+
+	for(k=0;k<nchunks;k++)
+	{
+		slot=(int)(k%STREAMSLOTS);
+		n=(k==nchunks-1) ? len-k*chunk : chunk;
+		switch(stage)
+		{
+		case STREAM_SERIAL:
+			memcpy(stream_inring[0],src+k*chunk,n);
+			cipher_idea_simd(stream_level,(u16 *)stream_inring[0],
+				(u16 *)stream_outring[0],n/IDEABLOCKSIZE,stream_key);
+			memcpy(dst+k*chunk,stream_outring[0],n);
+			break;
+
+		case STREAM_COPYIN:
+			/* The slot is free once its last chunk is ciphered */
+			if(k>=STREAMSLOTS && stream_wait(&stream_ciphered,k+1-STREAMSLOTS)!=0)
+				return(-1);
+			memcpy(stream_inring[slot],src+k*chunk,n);
+			__atomic_store_n(&stream_copied,k+1,__ATOMIC_RELEASE);
+			break;
+
+		case STREAM_CIPHER:
+			if(stream_wait(&stream_copied,k+1)!=0)
+				return(-1);
+			if(k>=STREAMSLOTS && stream_wait(&stream_drained,k+1-STREAMSLOTS)!=0)
+				return(-1);
+			cipher_idea_simd(stream_level,(u16 *)stream_inring[slot],
+				(u16 *)stream_outring[slot],n/IDEABLOCKSIZE,stream_key);
+			__atomic_store_n(&stream_ciphered,k+1,__ATOMIC_RELEASE);
+			break;
+
+		case STREAM_COPYOUT:
+			if(stream_wait(&stream_ciphered,k+1)!=0)
+				return(-1);
+			memcpy(dst+k*chunk,stream_outring[slot],n);
+			__atomic_store_n(&stream_drained,k+1,__ATOMIC_RELEASE);
+			break;
+
+		default:
+			return(-1);
+		}
+	}
+	return(0);
+}
+/* Neural Net */
+/*
+** Load every pattern in one go: npats input patterns of
+** IN_SIZE, then npats output patterns of OUT_SIZE, count
+** doubles in all.  Returns 0, or -1 if the sizes are wrong.
+*/
+int encl_load_pats(int npats, const double *pats, size_t count)
 {
-    out_pats[patt][element] = val;
+    if(npats<0 || npats>MAXPATS ||
+      count!=(size_t)npats*(IN_SIZE+OUT_SIZE))
+        return -1;
+    numpats = npats;
+    memcpy(in_pats, pats, (size_t)npats*IN_SIZE*sizeof(double));
+    memcpy(out_pats, pats+(size_t)npats*IN_SIZE,
+        (size_t)npats*OUT_SIZE*sizeof(double));
+    return 0;
 }
 
 void encl_DoNNetIteration(unsigned long nloops)
@@ -2166,6 +3577,52 @@ printf("Learned in %d passes\n",numpasses);
 }
 }
 
+/*
+** Neural Net (MLP), one net per thread slot (-threads=N).
+*/
+static MLPNet mlpnet[MAXTHREADS];
+
+/*
+** Make the net and its patterns.  Returns 0, or -1 if there
+** is no room.
+*/
+int encl_mlp_setup(long in, long hid, long out, long npats, long batch)
+{
+	mlp_free(&mlpnet[encl_slot]);
+	return(mlp_setup(&mlpnet[encl_slot],in,hid,out,npats,batch));
+}
+
+/*
+** Train nepochs passes from the initial weights, with the
+** kernels of SIMD_xxx level.
+*/
+void encl_mlp_train(unsigned long nepochs, int level)
+{
+	MLPNet *net=&mlpnet[encl_slot];
+
+	if(net->block==NULL)
+		return;
+	mlp_reset(net);
+	while(nepochs--)
+		mlp_epoch(net,level);
+}
+
+/*
+** Check the batched forward pass and an epoch of training;
+** returns 0, or -1.
+*/
+int encl_mlp_check(int level)
+{
+	if(mlpnet[encl_slot].block==NULL)
+		return(-1);
+	return(mlp_check(&mlpnet[encl_slot],level,MLPCHECKTOL));
+}
+
+void encl_mlp_free(void)
+{
+	mlp_free(&mlpnet[encl_slot]);
+}
+
 //////////////////////////////////////////LuDecomposition/////////////////////////////////////////////////////////
 /******************
 ** build_problem **
@@ -2503,6 +3960,137 @@ for(i=0;i<numarrays;i++)
 
 }
 
+/*
+** LU (BLOCKED) keeps one n x n problem in buffers its ECALLs
+** are handed: the seed matrix and right-hand side (seed,
+** rhs), the matrix being factored (work) and its row
+** interchanges (indx), and 2n doubles of scratch.  A handle
+** that is bad, or too small for n, fails the call.
+*/
+
+/*********************
+** lu_build_problem **
+**********************
+** build_problem() for an n x n matrix.
+*/
+static void lu_build_problem(double *a, double *b, long n)
+{
+long i,j,k,k1;
+double rcon;
+
+randnum((int32)13);
+for(i=0;i<n;i++)
+{	b[i]=(double)(abs_randwc((int32)100)+(int32)1);
+	for(j=0;j<n;j++)
+		if(i==j)
+			a[i*n+j]=(double)(abs_randwc((int32)1000)+(int32)1);
+		else
+			a[i*n+j]=(double)0.0;
+}
+for(i=0;i<8*n;i++)
+{	k=abs_randwc((int32)n);
+	k1=abs_randwc((int32)n);
+	if(k!=k1)
+	{	rcon=k<k1 ? (double)1.0 : (double)-1.0;
+		for(j=0;j<n;j++)
+			a[k*n+j]+=a[k1*n+j]*rcon;
+		b[k]+=b[k1]*rcon;
+	}
+}
+}
+
+/*
+** Build the seed problem of LU (BLOCKED).  Returns 0, or -1
+** on a bad handle.
+*/
+int encl_lu_build(long n, int seed, int rhs)
+{
+double *a=(double *)buf_get(seed,(size_t)n*(size_t)n*sizeof(double));
+double *b=(double *)buf_get(rhs,(size_t)n*sizeof(double));
+
+if(a==NULL || b==NULL)
+	return(-1);
+lu_build_problem(a,b,n);
+return(0);
+}
+
+/*
+** Copy the seed matrix over the one to be factored.  Returns
+** 0, or -1 on a bad handle.
+*/
+int encl_lu_reset(long n, int seed, int work)
+{
+size_t bytes=(size_t)n*(size_t)n*sizeof(double);
+void *a0=buf_get(seed,bytes);
+void *a=buf_get(work,bytes);
+
+if(a0==NULL || a==NULL)
+	return(-1);
+memcpy(a,a0,bytes);
+return(0);
+}
+
+/*
+** Factor the matrix with the LUKERNEL_xxx kernel; level is
+** the SIMD_xxx of the blocked kernel's multiply.  Returns 0,
+** -1 if the matrix is singular, or -2 on a bad handle.
+*/
+int encl_lu_factor(long n, long nb, int kernel, int level, int work,
+	int indx, int scratch)
+{
+double *a=(double *)buf_get(work,(size_t)n*(size_t)n*sizeof(double));
+int *ix=(int *)buf_get(indx,(size_t)n*sizeof(int));
+double *vv=(double *)buf_get(scratch,(size_t)2*(size_t)n*sizeof(double));
+int ok;
+
+if(a==NULL || ix==NULL || vv==NULL)
+	return(-2);
+if(kernel==LUKERNEL_CLASSIC)
+	ok=lu_crout(a,n,ix,vv);
+else
+	ok=lu_blocked(level,a,n,nb,ix);
+return(ok ? 0 : -1);
+}
+
+/*
+** Solve the seed problem with the last factorization and
+** check the residual: |A x - b| must stay within LUCHECKTOL
+** times |A| |x| n epsilon (infinity norms).  Returns 0, or -1
+** if it does not or a handle is bad.
+*/
+int encl_lu_check(long n, int seed, int rhs, int work, int indx,
+	int scratch)
+{
+size_t bytes=(size_t)n*(size_t)n*sizeof(double);
+const double *a0=(const double *)buf_get(seed,bytes);
+const double *b0=(const double *)buf_get(rhs,(size_t)n*sizeof(double));
+const double *a=(const double *)buf_get(work,bytes);
+const int *ix=(const int *)buf_get(indx,(size_t)n*sizeof(int));
+double *x=(double *)buf_get(scratch,(size_t)2*(size_t)n*sizeof(double));
+double r, anorm, xnorm, rnorm, rowsum;
+long i, j;
+
+if(a0==NULL || b0==NULL || a==NULL || ix==NULL || x==NULL)
+	return(-1);
+memcpy(x,b0,(size_t)n*sizeof(double));
+lu_solve(a,n,ix,x);
+anorm=xnorm=rnorm=(double)0.0;
+for(i=0;i<n;i++)
+{	r=-b0[i];
+	rowsum=(double)0.0;
+	for(j=0;j<n;j++)
+	{	r+=a0[i*n+j]*x[j];
+		rowsum+=fabs(a0[i*n+j]);
+	}
+	if(fabs(r)>rnorm) rnorm=fabs(r);
+	if(rowsum>anorm) anorm=rowsum;
+	if(fabs(x[i])>xnorm) xnorm=fabs(x[i]);
+}
+if(rnorm>LUCHECKTOL*anorm*xnorm*(double)n*DBL_EPSILON)
+	return(-1);
+return(0);
+}
+
 
 
 /***************
@@ -2874,6 +4462,35 @@ do {
 
 }
 
+/*
+** Huffman (table): the same round trip as encl_callHuffman()
+** on the same plaintext, with the canonical coder of
+** encl_huffman.c.  The compressed text may take up to
+** HUFFTABLECOMP(arraysize) bytes.  Returns 0, HUFFMISMATCH
+** if a round trip does not give the plaintext back, or
+** HUFFOVERFLOW if the compressed text does not fit.
+*/
+int encl_callHuffmanTable(unsigned long nloops, unsigned long arraysize)
+{
+	const unsigned char *plaintext;
+	unsigned char *comparray;
+	unsigned char *decomparray;
+	long status;
+
+	plaintext=(const unsigned char *)enclave_buffer;
+	comparray=(unsigned char *)enclave_buffer2;
+	decomparray=(unsigned char *)enclave_buffer3;
+
+	while(nloops--)
+	{
+		status=huff_table_roundtrip(plaintext,(long)arraysize,
+		  comparray,HUFFTABLECOMP((long)arraysize),decomparray);
+		if(status<0)
+			return((int)status);
+	}
+	return(0);
+}
+
 
 
 
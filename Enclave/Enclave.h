@@ -32,51 +32,125 @@
 extern "C" {
 #endif
 
+#ifndef ENCLAVE_NATIVE
 void printf(const char *fmt, ...);
+#endif
 void test_function(const char *str);
 void nothing();
+
+/*Transition microbenchmarks*/
+void encl_ecall_in(const void *buf, size_t len);
+void encl_ecall_out(void *buf, size_t len);
+void encl_ecall_user_check(void *buf, size_t len);
+void encl_ocall_loop(unsigned long count);
 /*Setup*/
-void encl_AllocateMemory(size_t size);
-void encl_AllocateMemory2(size_t size);
-void encl_AllocateMemory3(size_t size);
+void encl_thread_bind(int slot);
+int encl_AllocateMemory(size_t size);
+int encl_AllocateMemory2(size_t size);
+int encl_AllocateMemory3(size_t size);
+int encl_AllocateMemory4(size_t size);
+int encl_AllocateMemory5(size_t size);
 void encl_FreeMemory();
 void encl_FreeMemory2();
 void encl_FreeMemory3();
+void encl_FreeMemory4();
+void encl_FreeMemory5();
+int encl_heap_probe(size_t size);
+int encl_buf_create(size_t size, size_t align);
+int encl_buf_bind(int k, int h);
+void encl_buf_destroy(int h);
+int encl_arena_create(size_t size);
+int encl_arena_use(int h);
+int encl_arena_reset(int h);
+size_t encl_arena_peak(int h);
+void encl_arena_destroy(int h);
 
 /*NumSort*/
 void encl_LoadNumArrayWithRand(unsigned long arraysize,unsigned int numarrays);
 void encl_NumHeapSort( unsigned long base_offset,unsigned long bottom,unsigned long top);
+int encl_sortpool_start(unsigned long arraysize, int nparts, int algo);
+int encl_sortpool_worker(int id, int part);
+int encl_sortpool_run(unsigned long numarrays);
+void encl_sortpool_stop(void);
+int encl_NumSortCheck(unsigned long arraysize, unsigned long numarrays);
 
 /*StringSort*/
 void encl_StrHeapSort(unsigned long *optrarray, unsigned char *strarray, unsigned long numstrings, unsigned long bottom, unsigned long top);
 unsigned long encl_LoadStringArray(unsigned int numarrays,unsigned long arraysize);
 void encl_call_StrHeapSort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+int encl_call_StrKeySort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+int encl_StrSortCheck(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+
+/*BitSort*/
+unsigned long encl_bitSetup(long bitfieldarraysize, long bitoparraysize);
+void encl_ToggleBitRun(unsigned long bit_addr, unsigned long nbits, unsigned int val);
+void encl_FlipBitRun(long bit_addr,long nbits);
+void encl_DoBitfieldIteration(long bitoparraysize);
+void encl_DoBitfieldIterationWord(long bitoparraysize, int kernel);
+int encl_checkBitfieldWord(long bitfieldarraysize, long bitoparraysize, int kernel);
 
 /*Floating Point*/
 void encl_SetupCPUEmFloatArrays(unsigned long arraysize);
 void encl_DoEmFloatIteration(unsigned long arraysize, unsigned long loops);
+int encl_SetupWideEmFloatArrays(unsigned long arraysize, int a, int b);
+int encl_DoWideEmFloatIteration(unsigned long arraysize, unsigned long loops, int a, int b, int c);
+int encl_checkWideEmFloat(unsigned long arraysize, unsigned long loops);
+int encl_SetupSortedEmFloatArrays(unsigned long arraysize, int a, int b, int c, int order);
+int encl_emfloat_start(void);
+int encl_emfloat_worker(int id);
+int encl_emfloat_run(unsigned long arraysize, unsigned long loops, int a, int b, int c, int order);
+void encl_emfloat_stop(void);
+int encl_checkSortedEmFloat(unsigned long arraysize, unsigned long loops, int a, int b, int c);
 
 /*Fourier*/
 void encl_DoFPUTransIteration(unsigned long arraysize); 
+int encl_fourier_start(int level);
+int encl_fourier_worker(int id);
+int encl_fourier_run(unsigned long arraysize, int a, int b);
+void encl_fourier_stop(void);
+int encl_fourier_check(unsigned long arraysize, int a, int b);
 
 /*Assignment*/
 void encl_LoadAssignArrayWithRand(unsigned long numarrays);
 void encl_call_AssignmentTest(unsigned int numarrays);
+int encl_assign_build(long n, int costs);
+long encl_assign_solve(long n, int costs, int duals, int perm, int scratch);
+int encl_assign_check(long n, long cost, int costs, int duals, int perm);
+
+/*IDEA*/
+void encl_app_loadIDEA(unsigned long arraysize);
+void encl_callIDEA(unsigned long arraysize, unsigned short *Z, unsigned short *DK, unsigned long nloops);
+void encl_callIDEAsimd(unsigned long arraysize, unsigned short *Z, unsigned short *DK, unsigned long nloops, int level);
+int encl_checkIDEAsimd(unsigned long arraysize, unsigned short *Z, unsigned short *DK, int level);
+
+/*Streaming IDEA*/
+int encl_stream_init(size_t chunk, unsigned short *Z, int level);
+void encl_stream_free(void);
+int encl_stream_stage(int stage, const void *in, void *out, size_t len);
+void encl_stream_abort(void);
+int encl_stream_reference(const void *in, void *out, size_t len);
 
 /*Neural Net*/
-void encl_set_numpats(int npats);
-double encl_get_in_pats(int patt, int element);
-void encl_set_in_pats(int patt, int element, double val);
-void encl_set_out_pats(int patt, int element, double val);
+int encl_load_pats(int npats, const double *pats, size_t count);
 void encl_DoNNetIteration(unsigned long nloops);
+int encl_mlp_setup(long in, long hid, long out, long npats, long batch);
+void encl_mlp_train(unsigned long nepochs, int level);
+int encl_mlp_check(int level);
+void encl_mlp_free(void);
 
 /*LU Decomposition*/
 void encl_moveSeedArrays(unsigned long numarrays);
 void encl_build_problem();
+void encl_call_lusolve(unsigned long numarrays);
+int encl_lu_build(long n, int seed, int rhs);
+int encl_lu_reset(long n, int seed, int work);
+int encl_lu_factor(long n, long nb, int kernel, int level, int work, int indx, int scratch);
+int encl_lu_check(long n, int seed, int rhs, int work, int indx, int scratch);
 
 /*Huffman*/
 void encl_buildHuffman(unsigned long arraysize);
 void encl_callHuffman(unsigned long nloops, unsigned long arraysize);
+int encl_callHuffmanTable(unsigned long nloops, unsigned long arraysize);
 
 #if defined(__cplusplus)
 }
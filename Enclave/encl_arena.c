@@ -0,0 +1,104 @@
+/*
+** encl_arena.c
+** Region allocator for the enclave buffers (ARENAKB=).
+**
+** The blocks are a stack: block[0] is the oldest, used the
+** end of the newest.  A tag owns at most one block, and the
+** stack is short (a test has five buffers), so finding a
+** tag's block is a scan of a few entries.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "encl_arena.h"
+
+/***************
+** arena_init **
+****************
+** See encl_arena.h.  malloc() only promises 16 bytes, so
+** the region is ARENAALIGN-1 bytes longer and base is rounded
+** up within it; the offsets of the blocks are then cache
+** lines apart.  The whole region is written once so that its
+** pages are in place before any test is timed.
+*/
+int arena_init(Arena *a, size_t size)
+{
+memset(a,0,sizeof(*a));
+if(size>(size_t)-1-(ARENAALIGN-1))
+        return(-1);
+a->raw=malloc(size+ARENAALIGN-1);
+if(a->raw==NULL)
+        return(-1);
+a->base=(unsigned char *)(((size_t)a->raw+ARENAALIGN-1) &
+        ~(size_t)(ARENAALIGN-1));
+memset(a->base,0,size);
+a->size=size;
+return(0);
+}
+
+/******************
+** arena_destroy **
+*******************
+** See encl_arena.h.
+*/
+void arena_destroy(Arena *a)
+{
+free(a->raw);
+memset(a,0,sizeof(*a));
+}
+
+/****************
+** arena_alloc **
+*****************
+** See encl_arena.h.
+*/
+void *arena_alloc(Arena *a, int tag, size_t size)
+{
+size_t start;
+
+arena_free(a,tag);
+if(a->nblocks>=ARENAMAXBLOCKS)
+        return(NULL);
+start=(a->used+ARENAALIGN-1) & ~(size_t)(ARENAALIGN-1);
+if(start>a->size || size>a->size-start)
+        return(NULL);
+a->block[a->nblocks].start=start;
+a->block[a->nblocks].tag=tag;
+a->block[a->nblocks].live=1;
+a->nblocks++;
+a->used=start+size;
+if(a->used>a->peak)
+        a->peak=a->used;
+return(a->base+start);
+}
+
+/***************
+** arena_free **
+****************
+** See encl_arena.h.
+*/
+void arena_free(Arena *a, int tag)
+{
+int i;
+
+for(i=a->nblocks-1;i>=0;i--)
+        if(a->block[i].live && a->block[i].tag==tag)
+        {       a->block[i].live=0;
+                break;
+        }
+while(a->nblocks>0 && !a->block[a->nblocks-1].live)
+{       a->nblocks--;
+        a->used=a->block[a->nblocks].start;
+}
+}
+
+/****************
+** arena_reset **
+*****************
+** See encl_arena.h.
+*/
+void arena_reset(Arena *a)
+{
+a->nblocks=0;
+a->used=0;
+}
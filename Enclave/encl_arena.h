@@ -0,0 +1,71 @@
+/*
+** encl_arena.h
+** Region allocator for the enclave buffers (ARENAKB=).
+**
+** An arena is one region of the enclave heap, set aside and
+** touched once, from which the buffers of a test are cut in
+** order: an allocation moves a pointer up, freeing the
+** newest block moves it back down, and a reset empties the
+** arena in one step.  So the self-adjusting loops and the
+** per-iteration buffers of the tests never reach malloc()
+** and free(), and how much of the heap a test really needs
+** can be read off the high-water mark.
+*/
+
+#ifndef _ENCL_ARENA_H_
+#define _ENCL_ARENA_H_
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define ARENAALIGN 64           /* Blocks start on a cache line */
+#define ARENAMAXBLOCKS 16       /* Blocks live at once */
+
+typedef struct {
+        void *raw;              /* From malloc() */
+        unsigned char *base;    /* The region, on a cache line in raw */
+        size_t size;            /* Its bytes */
+        size_t used;            /* Bytes up to the end of the newest block */
+        size_t peak;            /* Most ever used */
+        int nblocks;            /* Blocks on the stack */
+        struct {
+                size_t start;   /* Offset of the block */
+                int tag;        /* Who owns it */
+                int live;       /* 0 once freed */
+        } block[ARENAMAXBLOCKS];
+} Arena;
+
+/*
+** Allocate and touch size bytes for the arena.  Returns 0,
+** or -1 if there is no room.
+*/
+extern int arena_init(Arena *a, size_t size);
+extern void arena_destroy(Arena *a);
+
+/*
+** A block of size bytes for tag, or NULL if the arena (or
+** its block stack) is full.  A block tag already owns is
+** freed first.
+*/
+extern void *arena_alloc(Arena *a, int tag, size_t size);
+
+/*
+** Free the block of tag, if any.  Blocks are given back
+** from the top: freeing one under a live block only marks
+** it, and it goes with the live one.
+*/
+extern void arena_free(Arena *a, int tag);
+
+/*
+** Free every block at once.
+*/
+extern void arena_reset(Arena *a);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_ARENA_H_ */
@@ -0,0 +1,154 @@
+/*
+** encl_assign.c
+** Linear assignment of an n x n cost matrix, for
+** Assignment (JV).
+**
+** The duals start from the column minima, and each column
+** goes to the row of its minimum if that row is still free
+** (the column reduction of Jonker and Volgenant), which
+** leaves only a fraction of the rows to augment.  For each
+** free row the search labels the columns in order of their
+** distance d[] from it; a labelled column that is assigned
+** passes its row on, which is scanned along its row of c[]
+** (one contiguous sweep per step).  The search stops at the
+** first free column, and the path back to the row is flipped.
+** Each search is O(n**2), the whole O(n**3) at worst.
+*/
+
+#include "nmglobal.h"
+#include "encl_assign.h"
+
+/*****************
+** assign_solve **
+******************
+** See encl_assign.h.
+*/
+long assign_solve(const long *c, long n, long *u, long *v,
+        long *rowcol, long *colrow, long *scratch, char *done)
+{
+long *d=scratch;                /* Distance of each column */
+long *pred=scratch+n;           /* Row it was reached from */
+long *scan=scratch+2*n;         /* Columns labelled, in order */
+const long *row;
+long i, j, f, jmin, nscan, dmin, dj, ui, cost;
+
+/*
+** Column reduction.
+*/
+for(j=0;j<n;j++)
+{       v[j]=c[j];
+        pred[j]=0;
+}
+for(i=1;i<n;i++)
+{       row=c+i*n;
+        for(j=0;j<n;j++)
+                if(row[j]<v[j])
+                {       v[j]=row[j];
+                        pred[j]=i;
+                }
+}
+for(i=0;i<n;i++)
+{       u[i]=0;
+        rowcol[i]=-1;
+}
+for(j=0;j<n;j++)
+        if(rowcol[pred[j]]<0)
+        {       rowcol[pred[j]]=j;
+                colrow[j]=pred[j];
+        }
+        else
+                colrow[j]=-1;
+
+/*
+** Augment from each row left free.
+*/
+for(f=0;f<n;f++)
+{       if(rowcol[f]>=0)
+                continue;
+        row=c+f*n;
+        for(j=0;j<n;j++)
+        {       d[j]=row[j]-u[f]-v[j];
+                pred[j]=f;
+                done[j]=0;
+        }
+        nscan=0;
+        for(;;)
+        {       /* The nearest column not yet labelled */
+                jmin=-1;
+                dmin=0;
+                for(j=0;j<n;j++)
+                        if(!done[j] && (jmin<0 || d[j]<dmin))
+                        {       dmin=d[j];
+                                jmin=j;
+                        }
+                done[jmin]=1;
+                scan[nscan++]=jmin;
+                if(colrow[jmin]<0)
+                        break;
+
+                /* Relax the columns through its row */
+                i=colrow[jmin];
+                row=c+i*n;
+                ui=dmin-u[i];
+                for(j=0;j<n;j++)
+                        if(!done[j])
+                        {       dj=row[j]+ui-v[j];
+                                if(dj<d[j])
+                                {       d[j]=dj;
+                                        pred[j]=i;
+                                }
+                        }
+        }
+
+        /*
+        ** Move the duals of everything labelled so that the
+        ** path is all zero reduced costs, then flip it.
+        */
+        u[f]+=dmin;
+        for(i=0;i<nscan-1;i++)
+        {       j=scan[i];
+                v[j]-=dmin-d[j];
+                u[colrow[j]]+=dmin-d[j];
+        }
+        j=jmin;
+        do {
+                i=pred[j];
+                colrow[j]=i;
+                dj=rowcol[i];
+                rowcol[i]=j;
+                j=dj;
+        } while(i!=f);
+}
+
+cost=0;
+for(i=0;i<n;i++)
+        cost+=c[i*n+rowcol[i]];
+return(cost);
+}
+
+/*****************
+** assign_check **
+******************
+** See encl_assign.h.
+*/
+int assign_check(const long *c, long n, const long *u,
+        const long *v, const long *rowcol, const long *colrow, long cost)
+{
+const long *row;
+long i, j, dual;
+
+dual=0;
+for(i=0;i<n;i++)
+{       j=rowcol[i];
+        if(j<0 || j>=n || colrow[j]!=i)
+                return(-1);
+        row=c+i*n;
+        for(j=0;j<n;j++)
+                if(row[j]-u[i]-v[j]<0)
+                        return(-1);
+        if(row[rowcol[i]]-u[i]-v[rowcol[i]]!=0)
+                return(-1);
+        dual+=u[i]+v[i];
+}
+return(dual==cost ? 0 : -1);
+}
@@ -0,0 +1,46 @@
+/*
+** encl_assign.h
+** Linear assignment of an n x n cost matrix, for
+** Assignment (JV).
+**
+** The shortest augmenting path method of Jonker and
+** Volgenant: the rows are assigned one at a time along the
+** cheapest path in the reduced costs, found with Dijkstra's
+** algorithm, and the dual variables (u of the rows, v of the
+** columns) are moved so that the reduced costs
+** c[i][j]-u[i]-v[j] stay non-negative and are zero on every
+** assigned cell.  The duals are a certificate that the
+** assignment is a cheapest one, which assign_check() tests.
+*/
+
+#ifndef _ENCL_ASSIGN_H_
+#define _ENCL_ASSIGN_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+** Assign the rows of the row-major n x n matrix c to its
+** columns at the least total cost, which is returned.  On
+** return rowcol[i] is the column of row i, colrow[j] the row
+** of column j and u[], v[] the duals.  scratch[] is 3n longs
+** and done[] n chars.
+*/
+extern long assign_solve(const long *c, long n, long *u, long *v,
+        long *rowcol, long *colrow, long *scratch, char *done);
+
+/*
+** Check that rowcol[] and colrow[] are inverse permutations,
+** that no reduced cost is negative and that those of the
+** assigned cells are zero, and that the duals add up to
+** cost.  Returns 0, or -1 if any of it fails.
+*/
+extern int assign_check(const long *c, long n, const long *u,
+        const long *v, const long *rowcol, const long *colrow, long cost);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_ASSIGN_H_ */
@@ -0,0 +1,115 @@
+/*
+** encl_bitrun.c
+** Word-at-a-time bit runs for Bitfield (WORD).
+**
+** A run of bits covers a partial word at each end and whole
+** words in between.  The end words get a mask; the whole
+** words are set to all ones, cleared or complemented 64 or
+** 256 bits at a time.  The bitmap ends up exactly as the
+** bit-by-bit loops of Enclave.cpp leave it.
+*/
+
+#include <immintrin.h>
+#include "nmglobal.h"
+#include "encl_bitrun.h"
+
+/*
+** Apply op to the bits of *w that are set in mask.
+*/
+#define APPLY(op,w,mask) \
+        do { if((op)==BITRUN_SET) *(w)|=(mask); \
+             else if((op)==BITRUN_CLEAR) *(w)&=~(mask); \
+             else *(w)^=(mask); } while(0)
+
+/****************
+** words_64bit **
+*****************
+** op on the n whole words at w, one word at a time.
+*/
+static void words_64bit(unsigned long *w, unsigned long n, int op)
+{
+unsigned long i;
+
+switch(op)
+{       case BITRUN_SET:
+                for(i=0;i<n;i++)
+                        w[i]=~0UL;
+                break;
+        case BITRUN_CLEAR:
+                for(i=0;i<n;i++)
+                        w[i]=0UL;
+                break;
+        default:
+                for(i=0;i<n;i++)
+                        w[i]=~w[i];
+                break;
+}
+return;
+}
+
+/***************
+** words_avx2 **
+****************
+** op on the n whole words at w, four words per 256-bit
+** store; the last 0 to 3 words one at a time.
+*/
+__attribute__((target("avx2")))
+static void words_avx2(unsigned long *w, unsigned long n, int op)
+{
+__m256i ones, v;
+unsigned long i;
+
+ones=_mm256_set1_epi64x(-1LL);
+i=0;
+switch(op)
+{       case BITRUN_SET:
+                for(;i+4<=n;i+=4)
+                        _mm256_storeu_si256((__m256i *)(w+i),ones);
+                break;
+        case BITRUN_CLEAR:
+                for(;i+4<=n;i+=4)
+                        _mm256_storeu_si256((__m256i *)(w+i),
+                                _mm256_setzero_si256());
+                break;
+        default:
+                for(;i+4<=n;i+=4)
+                {       v=_mm256_loadu_si256((const __m256i *)(w+i));
+                        _mm256_storeu_si256((__m256i *)(w+i),
+                                _mm256_xor_si256(v,ones));
+                }
+                break;
+}
+words_64bit(w+i,n-i,op);
+return;
+}
+
+/***********
+** bitrun **
+************
+** See encl_bitrun.h.
+*/
+void bitrun(int kernel, unsigned long *map,
+        unsigned long bit_addr, unsigned long nbits, int op)
+{
+unsigned long first, last;      /* Words holding the end bits */
+unsigned long lomask, himask;   /* Bits of the run in them */
+
+if(nbits==0)
+        return;
+first=bit_addr>>6;
+last=(bit_addr+nbits-1)>>6;
+lomask=~0UL<<(bit_addr & 63);
+himask=~0UL>>(63-((bit_addr+nbits-1) & 63));
+
+if(first==last)
+{       APPLY(op,map+first,lomask & himask);
+        return;
+}
+APPLY(op,map+first,lomask);
+if(kernel==BITKERNEL_AVX2)
+        words_avx2(map+first+1,last-first-1,op);
+else
+        words_64bit(map+first+1,last-first-1,op);
+APPLY(op,map+last,himask);
+return;
+}
@@ -0,0 +1,38 @@
+/*
+** encl_bitrun.h
+** Word-at-a-time bit runs for Bitfield (WORD).
+**
+** Same operations as encl_ToggleBitRun() and
+** encl_FlipBitRun(), on whole words: the partial words at
+** either end of a run are done with masks, the words in
+** between with 64-bit or AVX2 stores.  The App picks the
+** BITKERNEL_xxx.
+*/
+
+#ifndef _ENCL_BITRUN_H_
+#define _ENCL_BITRUN_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+** Operations, in the order the bitfield test cycles
+** through them (index % 3).
+*/
+#define BITRUN_SET 0
+#define BITRUN_CLEAR 1
+#define BITRUN_FLIP 2
+
+/*
+** Set, clear or complement (op) nbits bits of map from bit
+** bit_addr on, with kernel BITKERNEL_xxx.
+*/
+extern void bitrun(int kernel, unsigned long *map,
+        unsigned long bit_addr, unsigned long nbits, int op);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_BITRUN_H_ */
@@ -0,0 +1,193 @@
+/*
+** encl_buffers.c
+** Registry of the enclave buffers.
+**
+** The -threads workers create and destroy buffers at the
+** same time, so taking or giving back a table entry is done
+** under a spin lock; the memory itself is allocated outside
+** it (each slot has its own arena).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "nmglobal.h"
+#include "encl_buffers.h"
+
+EnclBuffer buf_table[MAXBUFFERS];
+int buf_slots[MAXTHREADS][BUFSLOTS];
+
+static int buf_lock;            /* Guards the live flags */
+
+static void lock_table(void)
+{
+while(__atomic_exchange_n(&buf_lock,1,__ATOMIC_ACQUIRE))
+        ;
+}
+
+static void unlock_table(void)
+{
+__atomic_store_n(&buf_lock,0,__ATOMIC_RELEASE);
+}
+
+/*
+** Unbind handle h from every slot.  Call with the lock held.
+*/
+static void unbind_all(int h)
+{
+int i, k;
+
+for(i=0;i<MAXTHREADS;i++)
+        for(k=0;k<BUFSLOTS;k++)
+                if(buf_slots[i][k]==h+1)
+                        buf_slots[i][k]=0;
+}
+
+/****************
+** buf_create **
+*****************
+** See encl_buffers.h.  The block is align-1 bytes longer
+** than asked for, and base is rounded up within it.
+*/
+int buf_create(size_t size, size_t align, int owner, Arena *arena)
+{
+EnclBuffer *b;
+unsigned char *p;
+int h;
+
+if(align==0)
+        align=BUFALIGN_LINE;
+if((align & (align-1))!=0 || size>(size_t)-1-align)
+        return(-1);
+
+lock_table();
+for(h=0;h<MAXBUFFERS;h++)
+        if(!buf_table[h].live)
+                break;
+if(h<MAXBUFFERS)
+        buf_table[h].live=1;
+unlock_table();
+if(h==MAXBUFFERS)
+        return(-1);
+
+b=&buf_table[h];
+if(arena!=NULL)
+{       b->raw=NULL;
+        p=(unsigned char *)arena_alloc(arena,h,size+align-1);
+}
+else
+{       b->raw=malloc(size+align-1);
+        p=(unsigned char *)b->raw;
+}
+if(p==NULL)
+{       __atomic_store_n(&b->live,0,__ATOMIC_RELEASE);
+        return(-1);
+}
+b->base=(void *)(((size_t)p+align-1) & ~(align-1));
+b->size=size;
+b->align=align;
+b->arena=arena;
+b->owner=owner;
+return(h);
+}
+
+/*****************
+** buf_destroy **
+******************
+** See encl_buffers.h.
+*/
+void buf_destroy(int h)
+{
+EnclBuffer *b;
+
+if(h<0 || h>=MAXBUFFERS || !buf_table[h].live)
+        return;
+b=&buf_table[h];
+if(b->arena!=NULL)
+        arena_free(b->arena,h);
+else
+        free(b->raw);
+lock_table();
+unbind_all(h);
+memset(b,0,sizeof(*b));
+unlock_table();
+}
+
+/**************
+** buf_base **
+***************
+** See encl_buffers.h.
+*/
+void *buf_base(int h)
+{
+if(h<0 || h>=MAXBUFFERS || !buf_table[h].live)
+        return(NULL);
+return(buf_table[h].base);
+}
+
+/**************
+** buf_size **
+***************
+** See encl_buffers.h.
+*/
+size_t buf_size(int h)
+{
+if(h<0 || h>=MAXBUFFERS || !buf_table[h].live)
+        return(0);
+return(buf_table[h].size);
+}
+
+/*************
+** buf_get **
+**************
+** See encl_buffers.h.
+*/
+void *buf_get(int h, size_t size)
+{
+if(buf_size(h)<size)
+        return(NULL);
+return(buf_base(h));
+}
+
+/**************
+** buf_bind **
+***************
+** See encl_buffers.h.
+*/
+int buf_bind(int slot, int k, int h)
+{
+if(slot<0 || slot>=MAXTHREADS || k<0 || k>=BUFSLOTS ||
+  h<-1 || h>=MAXBUFFERS || (h>=0 && !buf_table[h].live))
+        return(-1);
+buf_slots[slot][k]=h+1;
+return(0);
+}
+
+/***************
+** buf_bound **
+****************
+** See encl_buffers.h.
+*/
+int buf_bound(int slot, int k)
+{
+if(slot<0 || slot>=MAXTHREADS || k<0 || k>=BUFSLOTS)
+        return(-1);
+return(buf_slots[slot][k]-1);
+}
+
+/********************
+** buf_drop_arena **
+*********************
+** See encl_buffers.h.
+*/
+void buf_drop_arena(const Arena *arena)
+{
+int h;
+
+lock_table();
+for(h=0;h<MAXBUFFERS;h++)
+        if(buf_table[h].live && buf_table[h].arena==arena)
+        {       unbind_all(h);
+                memset(&buf_table[h],0,sizeof(buf_table[h]));
+        }
+unlock_table();
+}
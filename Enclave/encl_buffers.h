@@ -0,0 +1,104 @@
+/*
+** encl_buffers.h
+** Registry of the enclave buffers.
+**
+** Every working buffer of a test is an entry of one table,
+** known by its handle: it has a size, an alignment and an
+** owner slot, and lives from buf_create() to buf_destroy().
+** A slot sees up to BUFSLOTS of them as its numbered
+** buffers (enclave_buffer..enclave_buffer5), by binding the
+** handles.  The older kernels find their memory that way;
+** the newer ones are handed the handles by their ECALLs and
+** find it with buf_get().
+** So two slots never share a buffer unless a handle is bound
+** to both, and a buffer can start on a page where a kernel
+** wants it to.
+*/
+
+#ifndef _ENCL_BUFFERS_H_
+#define _ENCL_BUFFERS_H_
+
+/* Include after nmglobal.h, for MAXTHREADS and BUFALIGN_xxx. */
+
+#include <stddef.h>
+#include "encl_arena.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define BUFSLOTS 5              /* Numbered buffers of a slot */
+#define MAXBUFFERS (MAXTHREADS*BUFSLOTS*2) /* Buffers live at once */
+
+typedef struct {
+        void *raw;              /* From malloc(), or NULL if cut from arena */
+        void *base;             /* First aligned byte */
+        size_t size;            /* Bytes from base */
+        size_t align;           /* Power of two base is a multiple of */
+        Arena *arena;           /* Arena of the block, or NULL */
+        int owner;              /* Slot that made it */
+        int live;               /* 0 for a free entry */
+} EnclBuffer;
+
+extern EnclBuffer buf_table[MAXBUFFERS];
+extern int buf_slots[MAXTHREADS][BUFSLOTS];     /* Handle+1, 0 for none */
+
+/*
+** A buffer of size bytes starting on a multiple of align (a
+** power of two; 0 for BUFALIGN_LINE), for slot owner.  It is
+** cut from arena, or taken from malloc() if arena is NULL.
+** Returns its handle, or -1 if there is no room, no free
+** handle or align is not a power of two.
+*/
+extern int buf_create(size_t size, size_t align, int owner, Arena *arena);
+
+/*
+** Give buffer h back and unbind it from every slot.  A bad
+** handle, -1 included, is ignored.
+*/
+extern void buf_destroy(int h);
+
+/*
+** Start and bytes of buffer h; NULL and 0 for a bad handle.
+*/
+extern void *buf_base(int h);
+extern size_t buf_size(int h);
+
+/*
+** buf_base() of h if it holds at least size bytes, else NULL.
+** What a kernel handed a handle checks it with.
+*/
+extern void *buf_get(int h, size_t size);
+
+/*
+** Make buffer h numbered buffer k of slot, or leave k unbound
+** with h of -1.  Returns 0, or -1 on a bad slot, k or h.
+*/
+extern int buf_bind(int slot, int k, int h);
+
+/*
+** Handle bound as numbered buffer k of slot, or -1.
+*/
+extern int buf_bound(int slot, int k);
+
+/*
+** Forget the buffers cut from arena, which is being emptied
+** or given back; their handles go free without touching it.
+*/
+extern void buf_drop_arena(const Arena *arena);
+
+/*
+** Numbered buffer k of slot, or NULL if none is bound.
+*/
+static inline void *encl_buffer(int slot, int k)
+{
+        int h=buf_slots[slot][k];
+
+        return(h ? buf_table[h-1].base : NULL);
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_BUFFERS_H_ */
@@ -25,15 +25,43 @@
 
 
 #include <string.h>
+#include <stdlib.h>
 #include "nmglobal.h"
 #include "emfloat.h"
+#include "encl_thread.h"
+#include "encl_workpool.h"
 
-extern void* enclave_buffer;
-extern void* enclave_buffer2;
-extern void* enclave_buffer3;
 
 extern int32 randnum(int32 lngval);
 extern int32 randwc(int32 num);
+
+/*
+** Operation of element i: jtable[i % 16], 0 add, 1 subtract,
+** 2 multiply, 3 divide.
+*/
+static uchar jtable[16] = {0,0,0,0,1,1,1,1,2,2,2,2,2,3,3,3};
+
+/*
+** FP Emulation (SORTED): where each operation's indices
+** start in the order array of a slot; the last entry is the
+** array size.  The order array is handed out EMFUNIT indices
+** at a time to the calling thread and the helpers parked in
+** encl_emfloat_worker(), with the passes of the run in
+** emfloops and the arrays it was handed in emfarrays.
+*/
+#define EMFUNIT 64              /* Indices per unit of the pool */
+
+typedef struct {
+        InternalFPF *abase;
+        InternalFPF *bbase;
+        InternalFPF *cbase;
+        ulong *order;
+} EmFloatArrays;
+
+static ulong emfgroup[MAXTHREADS][5];
+static EmFloatArrays emfarrays[MAXTHREADS];
+static ulong emfloops[MAXTHREADS];
+static WorkPool emfpool[MAXTHREADS];
 /*
 ** Floating-point emulator.
 ** These routines are only "sort of" IEEE-compliant.  All work is
@@ -65,11 +93,22 @@ void encl_SetupCPUEmFloatArrays(/*InternalFPF *abase,
                 InternalFPF *cbase,*/
                 ulong arraysize)
 {
+EmFloatSetup((InternalFPF *)enclave_buffer,(InternalFPF *)enclave_buffer2,
+        arraysize);
+}
+
+/*****************
+** EmFloatSetup **
+******************
+** The body of the above, on any arrays; FP Emulation (WIDE)
+** checks its own arrays against these.
+*/
+void EmFloatSetup(InternalFPF *abase,
+                InternalFPF *bbase,
+                ulong arraysize)
+{
 ulong i;
 InternalFPF locFPF1,locFPF2;
-InternalFPF *abase = enclave_buffer;
-InternalFPF *bbase = enclave_buffer2;
-InternalFPF *cbase = enclave_buffer3;
 /*
 ** Reset random number generator so things repeat. Inserted by Uwe F. Mayer.
 */
@@ -101,12 +140,22 @@ void encl_DoEmFloatIteration(/*InternalFPF *abase,
                 InternalFPF *cbase,*/
                 ulong arraysize, ulong loops)
 {
+EmFloatLoops((InternalFPF *)enclave_buffer,(InternalFPF *)enclave_buffer2,
+        (InternalFPF *)enclave_buffer3,arraysize,loops);
+}
+
+/*****************
+** EmFloatLoops **
+******************
+** The body of the above, on any arrays.
+*/
+void EmFloatLoops(InternalFPF *abase,
+                InternalFPF *bbase,
+                InternalFPF *cbase,
+                ulong arraysize, ulong loops)
+{
 ulong elapsed;          /* For the stopwatch */
-static uchar jtable[16] = {0,0,0,0,1,1,1,1,2,2,2,2,2,3,3,3};
 ulong i;
-InternalFPF *abase = enclave_buffer;
-InternalFPF *bbase = enclave_buffer2;
-InternalFPF *cbase = enclave_buffer3;
 #ifdef DEBUG
 int number_of_loops;
 #endif
@@ -191,6 +240,198 @@ while(loops--)
 //return elapsed;
 }
 
+/********************
+** emfloat_arrays **
+*********************
+** Find the arrays of FP Emulation (SORTED) of arraysize
+** numbers from their handles; order is not looked up if it
+** is -1.  Returns 0, or -1 if a handle is bad or its buffer
+** too small.
+*/
+static int emfloat_arrays(EmFloatArrays *e, ulong arraysize, int a, int b,
+        int c, int order)
+{
+size_t bytes=arraysize*sizeof(InternalFPF);
+
+e->abase=(InternalFPF *)buf_get(a,bytes);
+e->bbase=(InternalFPF *)buf_get(b,bytes);
+e->cbase=(InternalFPF *)buf_get(c,bytes);
+e->order=order<0 ? NULL : (ulong *)buf_get(order,arraysize*sizeof(ulong));
+if(e->abase==NULL || e->bbase==NULL || e->cbase==NULL ||
+  (order>=0 && e->order==NULL))
+        return(-1);
+return(0);
+}
+
+/*********************************
+** encl_SetupSortedEmFloatArrays **
+***********************************
+** Set up the arrays of FP Emulation (SORTED) as those of
+** FP Emulation, with cbase zeroed so that runs can be
+** compared, and sort the indices by operation once: the
+** adds, then the subtracts, multiplies and divides, each in
+** increasing order, into order.  a, b, c and order are the
+** handles of the arrays.  Returns the slot, or -1 on a bad
+** handle.
+*/
+int encl_SetupSortedEmFloatArrays(ulong arraysize, int a, int b, int c,
+        int order)
+{
+EmFloatArrays *e=&emfarrays[encl_slot];
+ulong *first=emfgroup[encl_slot];
+ulong next[4];
+ulong i;
+int op;
+
+if(emfloat_arrays(e,arraysize,a,b,c,order)!=0)
+        return(-1);
+EmFloatSetup(e->abase,e->bbase,arraysize);
+memset(e->cbase,0,arraysize*sizeof(InternalFPF));
+
+for(op=0;op<5;op++)
+        first[op]=0;
+for(i=0;i<arraysize;i++)
+        first[jtable[i % 16]+1]++;
+for(op=0;op<4;op++)
+{       first[op+1]+=first[op];
+        next[op]=first[op];
+}
+for(i=0;i<arraysize;i++)
+        e->order[next[jtable[i % 16]]++]=i;
+return(encl_slot);
+}
+
+/*****************
+** emfloat_unit **
+******************
+** emfloops[id] passes of order[EMFUNIT*u] on of slot id, an
+** operation at a time.  Each element only ever meets its own
+** operation, so it goes through the very steps of
+** EmFloatLoops() whatever order the elements are taken in.
+*/
+static void emfloat_unit(int id, unsigned long u)
+{
+InternalFPF *abase, *bbase, *cbase;
+ulong *order, *first;
+ulong lo, hi, from[4], to[4], loops, k, i;
+int op;
+
+abase=emfarrays[id].abase;
+bbase=emfarrays[id].bbase;
+cbase=emfarrays[id].cbase;
+order=emfarrays[id].order;
+first=emfgroup[id];
+lo=u*EMFUNIT;
+hi=first[4]-lo<EMFUNIT ? first[4] : lo+EMFUNIT;
+for(op=0;op<4;op++)
+{       from[op]=first[op]<lo ? lo : first[op];
+        to[op]=first[op+1]>hi ? hi : first[op+1];
+}
+
+for(loops=emfloops[id];loops--;)
+{
+        for(k=from[0];k<to[0];k++)
+        {       i=order[k];
+                AddSubInternalFPF(0,abase+i,bbase+i,cbase+i);
+        }
+        for(k=from[1];k<to[1];k++)
+        {       i=order[k];
+                AddSubInternalFPF(1,abase+i,bbase+i,cbase+i);
+        }
+        for(k=from[2];k<to[2];k++)
+        {       i=order[k];
+                MultiplyInternalFPF(abase+i,bbase+i,cbase+i);
+        }
+        for(k=from[3];k<to[3];k++)
+        {       i=order[k];
+                DivideInternalFPF(abase+i,bbase+i,cbase+i);
+        }
+}
+}
+
+/************************
+** encl_emfloat_start **
+*************************
+** Set up the pool of the calling thread's slot, before any
+** helper is started.  Returns the slot, for
+** encl_emfloat_worker().
+*/
+int encl_emfloat_start(void)
+{
+workpool_start(&emfpool[encl_slot],encl_slot,emfloat_unit);
+return(encl_slot);
+}
+
+/*************************
+** encl_emfloat_worker **
+**************************
+** Body of a helper of the pool of slot id, until
+** encl_emfloat_stop().  Returns 0, or -1 on a bad id.
+*/
+int encl_emfloat_worker(int id)
+{
+if(id<0 || id>=MAXTHREADS)
+        return(-1);
+workpool_worker(&emfpool[id]);
+return(0);
+}
+
+/**********************
+** encl_emfloat_run **
+***********************
+** loops passes over the arrays a, b, c and order, with the
+** pool of the calling thread's slot.  Returns 0, or -1 if
+** they were not set up for arraysize or a handle is bad.
+*/
+int encl_emfloat_run(ulong arraysize, ulong loops, int a, int b, int c,
+        int order)
+{
+if(arraysize==0 || emfgroup[encl_slot][4]!=arraysize ||
+  emfloat_arrays(&emfarrays[encl_slot],arraysize,a,b,c,order)!=0)
+        return(-1);
+emfloops[encl_slot]=loops;
+workpool_run(&emfpool[encl_slot],(arraysize+EMFUNIT-1)/EMFUNIT);
+return(0);
+}
+
+void encl_emfloat_stop(void)
+{
+workpool_stop(&emfpool[encl_slot]);
+}
+
+/****************************
+** encl_checkSortedEmFloat **
+*****************************
+** Run loops passes of EmFloatLoops() from the start of
+** encl_SetupSortedEmFloatArrays() on arrays of its own, and
+** compare every number of the three arrays with those of a,
+** b and c.  Returns 0, -1 if any differs or a handle is bad,
+** or -2 if there is no room.
+*/
+int encl_checkSortedEmFloat(ulong arraysize, ulong loops, int a, int b,
+        int c)
+{
+EmFloatArrays e;
+InternalFPF *fpf;
+int status;
+
+if(emfloat_arrays(&e,arraysize,a,b,c,-1)!=0)
+        return(-1);
+fpf=(InternalFPF *)calloc(3*arraysize,sizeof(InternalFPF));
+if(fpf==NULL)
+        return(-2);
+EmFloatSetup(fpf,fpf+arraysize,arraysize);
+EmFloatLoops(fpf,fpf+arraysize,fpf+2*arraysize,arraysize,loops);
+
+status=0;
+if(memcmp(fpf,e.abase,arraysize*sizeof(InternalFPF))!=0 ||
+  memcmp(fpf+arraysize,e.bbase,arraysize*sizeof(InternalFPF))!=0 ||
+  memcmp(fpf+2*arraysize,e.cbase,arraysize*sizeof(InternalFPF))!=0)
+        status=-1;
+free(fpf);
+return(status);
+}
+
 /***********************
 ** SetInternalFPFZero **
 ************************
@@ -0,0 +1,666 @@
+/*
+** encl_emfloat_wide.c
+** The floating-point emulator of encl_emfloat.c, for FP
+** Emulation (WIDE), on a 64-bit mantissa.
+**
+** The 64 bits of mantissa that InternalFPF keeps in four
+** 16-bit words are one unsigned long long here, so that a
+** carry or borrow is one compare, normalizing is a count of
+** leading zeros and one shift, a sticky shift right is one
+** shift and a mask of the bits shifted out, the product is
+** one 64 x 64 -> 128-bit multiply and the quotient one
+** 128 / 64-bit divide.  Every result, the quirks included
+** (the operand overwritten by memmove() in some special
+** cases, the sticky bit of a product set when the bits
+** below it are all zero, the truncated quotient), is bit for
+** bit that of encl_emfloat.c; encl_checkWideEmFloat() makes
+** sure of it.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include "nmglobal.h"
+#include "emfloat.h"
+#include "encl_thread.h"
+
+extern int32 randnum(int32 lngval);
+extern int32 randwc(int32 num);
+
+#define WIDE_TOP 0x8000000000000000ULL  /* mantissa[0] & 0x8000 */
+#define WIDE_BITS 64                    /* INTERNAL_FPF_PRECISION * 16 */
+
+typedef unsigned long long u64w;
+typedef unsigned __int128 u128w;
+
+static void AddSubWideFPF(uchar operation, WideFPF *x, WideFPF *y,
+        WideFPF *z);
+static void MultiplyWideFPF(WideFPF *x, WideFPF *y, WideFPF *z);
+static void DivideWideFPF(WideFPF *x, WideFPF *y, WideFPF *z);
+static void Int32ToWideFPF(int32 mylong, WideFPF *dest);
+
+/*****************
+** WideFPFSetup **
+******************
+** EmFloatSetup() for WideFPF arrays.
+*/
+void WideFPFSetup(WideFPF *abase,
+                WideFPF *bbase,
+                ulong arraysize)
+{
+ulong i;
+WideFPF locFPF1,locFPF2;
+
+randnum((int32)13);
+
+for(i=0;i<arraysize;i++)
+{       Int32ToWideFPF(randwc((int32)50000),&locFPF1);
+        Int32ToWideFPF(randwc((int32)50000)+(int32)1,&locFPF2);
+        DivideWideFPF(&locFPF1,&locFPF2,abase+i);
+        Int32ToWideFPF(randwc((int32)50000)+(int32)1,&locFPF2);
+        DivideWideFPF(&locFPF1,&locFPF2,bbase+i);
+}
+return;
+}
+
+/*****************
+** WideFPFLoops **
+******************
+** EmFloatLoops() for WideFPF arrays: the same mix of 4 adds,
+** 4 subtracts, 5 multiplies and 3 divides in 16.
+*/
+void WideFPFLoops(WideFPF *abase,
+                WideFPF *bbase,
+                WideFPF *cbase,
+                ulong arraysize, ulong loops)
+{
+static uchar jtable[16] = {0,0,0,0,1,1,1,1,2,2,2,2,2,3,3,3};
+ulong i;
+
+while(loops--)
+{
+        for(i=0;i<arraysize;i++)
+                switch(jtable[i % 16])
+                {
+                        case 0: /* Add */
+                                AddSubWideFPF(0,abase+i,bbase+i,cbase+i);
+                                break;
+                        case 1: /* Subtract */
+                                AddSubWideFPF(1,abase+i,bbase+i,cbase+i);
+                                break;
+                        case 2: /* Multiply */
+                                MultiplyWideFPF(abase+i,bbase+i,cbase+i);
+                                break;
+                        case 3: /* Divide */
+                                DivideWideFPF(abase+i,bbase+i,cbase+i);
+                                break;
+                }
+}
+return;
+}
+
+/*
+** The arrays of FP Emulation (WIDE) are those of a, b and c,
+** of arraysize numbers each.  Both return 0, or -1 on a bad
+** handle.
+*/
+int encl_SetupWideEmFloatArrays(ulong arraysize, int a, int b)
+{
+WideFPF *abase=(WideFPF *)buf_get(a,arraysize*sizeof(WideFPF));
+WideFPF *bbase=(WideFPF *)buf_get(b,arraysize*sizeof(WideFPF));
+
+if(abase==NULL || bbase==NULL)
+        return(-1);
+WideFPFSetup(abase,bbase,arraysize);
+return(0);
+}
+
+int encl_DoWideEmFloatIteration(ulong arraysize, ulong loops, int a, int b,
+        int c)
+{
+WideFPF *abase=(WideFPF *)buf_get(a,arraysize*sizeof(WideFPF));
+WideFPF *bbase=(WideFPF *)buf_get(b,arraysize*sizeof(WideFPF));
+WideFPF *cbase=(WideFPF *)buf_get(c,arraysize*sizeof(WideFPF));
+
+if(abase==NULL || bbase==NULL || cbase==NULL)
+        return(-1);
+WideFPFLoops(abase,bbase,cbase,arraysize,loops);
+return(0);
+}
+
+/**************************
+** encl_checkWideEmFloat **
+***************************
+** Run loops passes of both emulators from the same start on
+** arrays of their own, and compare every number of the three
+** arrays (the operands can change too).  Returns 0, -1 if
+** any differs, or -2 if there is no room.
+*/
+int encl_checkWideEmFloat(ulong arraysize, ulong loops)
+{
+InternalFPF *fpf;
+WideFPF *wide;
+ulong i;
+int j, status;
+u64w m;
+
+fpf=(InternalFPF *)calloc(3*arraysize,sizeof(InternalFPF));
+wide=(WideFPF *)calloc(3*arraysize,sizeof(WideFPF));
+if(fpf==NULL || wide==NULL)
+{       free(fpf);
+        free(wide);
+        return(-2);
+}
+EmFloatSetup(fpf,fpf+arraysize,arraysize);
+EmFloatLoops(fpf,fpf+arraysize,fpf+2*arraysize,arraysize,loops);
+WideFPFSetup(wide,wide+arraysize,arraysize);
+WideFPFLoops(wide,wide+arraysize,wide+2*arraysize,arraysize,loops);
+
+status=0;
+for(i=0;i<3*arraysize && status==0;i++)
+{       m=0;
+        for(j=0;j<INTERNAL_FPF_PRECISION;j++)
+                m=(m<<16)|fpf[i].mantissa[j];
+        if(fpf[i].type!=wide[i].type || fpf[i].sign!=wide[i].sign ||
+           fpf[i].exp!=wide[i].exp || m!=wide[i].mant)
+                status=-1;
+}
+free(fpf);
+free(wide);
+return(status);
+}
+
+/*********************
+** SetWideFPFZero   **
+** SetWideFPFInfinity **
+** SetWideFPFNaN    **
+**********************
+** As SetInternalFPFZero(), ...Infinity() and ...NaN().
+*/
+static void SetWideFPFZero(WideFPF *dest, uchar sign)
+{
+dest->type=IFPF_IS_ZERO;
+dest->sign=sign;
+dest->exp=MIN_EXP;
+dest->mant=0;
+}
+
+static void SetWideFPFInfinity(WideFPF *dest, uchar sign)
+{
+dest->type=IFPF_IS_INFINITY;
+dest->sign=sign;
+dest->exp=MIN_EXP;
+dest->mant=0;
+}
+
+static void SetWideFPFNaN(WideFPF *dest)
+{
+dest->type=IFPF_IS_NAN;
+dest->exp=MAX_EXP;
+dest->sign=1;
+dest->mant=(u64w)0x4000<<48;
+}
+
+/**************************
+** StickyShiftRightWide **
+***************************
+** StickyShiftRightMant() in one step: a bit shifted out
+** one at a time is ORed back into the lowest bit, which the
+** next shift carries out again, so the result is the shifted
+** mantissa with bit 0 set if any bit was lost.
+*/
+static void StickyShiftRightWide(WideFPF *ptr, int amount)
+{
+if(ptr->type!=IFPF_IS_ZERO)
+{       if(amount>=WIDE_BITS)
+                ptr->mant=1;
+        else if(amount>0)
+                ptr->mant=(ptr->mant>>amount) |
+                        ((ptr->mant & (((u64w)1<<amount)-1))!=0);
+}
+return;
+}
+
+/******************
+** normalizeWide **
+*******************
+** Shift the leading 1 to the top; a zero mantissa (which
+** normalize() would never get past) is left alone.
+*/
+static void normalizeWide(WideFPF *ptr)
+{
+int n;
+
+if(ptr->mant!=0)
+{       n=__builtin_clzll(ptr->mant);
+        ptr->mant<<=n;
+        ptr->exp-=n;
+}
+return;
+}
+
+/********************
+** denormalizeWide **
+*********************
+** As denormalize().
+*/
+static void denormalizeWide(WideFPF *ptr, int minimum_exponent)
+{
+long exponent_difference;
+
+exponent_difference = ptr->exp-minimum_exponent;
+if (exponent_difference < 0)
+{
+        exponent_difference = -exponent_difference;
+        if (exponent_difference >= WIDE_BITS)
+                SetWideFPFZero(ptr, ptr->sign);
+        else
+        {
+                ptr->exp+=exponent_difference;
+                StickyShiftRightWide(ptr, (int)exponent_difference);
+        }
+}
+return;
+}
+
+/*****************
+** RoundWideFPF **
+******************
+** As RoundInternalFPF(): chop the low 3 bits.
+*/
+static void RoundWideFPF(WideFPF *ptr)
+{
+if (ptr->type == IFPF_IS_NORMAL ||
+        ptr->type == IFPF_IS_SUBNORMAL)
+{
+        denormalizeWide(ptr, MIN_EXP);
+        if (ptr->type != IFPF_IS_ZERO)
+                ptr->mant &= ~(u64w)7;
+}
+return;
+}
+
+/********************
+** choose_nan_wide **
+*********************
+** As choose_nan(), which copies z over x or y.
+*/
+static void choose_nan_wide(WideFPF *x, WideFPF *y, WideFPF *z,
+                int intel_flag)
+{
+if (x->mant > y->mant)
+        *x = *z;
+else if (x->mant < y->mant)
+        *y = *z;
+else if (!intel_flag)
+        *x = *z;
+else
+        *y = *z;
+return;
+}
+
+/*******************
+** AddSubWideFPF **
+********************
+** As AddSubInternalFPF().
+*/
+static void AddSubWideFPF(uchar operation,
+                WideFPF *x,
+                WideFPF *y,
+                WideFPF *z)
+{
+int exponent_difference;
+WideFPF locx,locy;
+
+switch ((x->type * IFPF_TYPE_COUNT) + y->type)
+{
+case ZERO_ZERO:
+        *x = *z;
+        if (x->sign ^ y->sign ^ operation)
+                z->sign = 0;
+        break;
+
+case NAN_ZERO:
+case NAN_SUBNORMAL:
+case NAN_NORMAL:
+case NAN_INFINITY:
+case SUBNORMAL_ZERO:
+case NORMAL_ZERO:
+case INFINITY_ZERO:
+case INFINITY_SUBNORMAL:
+case INFINITY_NORMAL:
+        *x = *z;
+        break;
+
+case ZERO_NAN:
+case SUBNORMAL_NAN:
+case NORMAL_NAN:
+case INFINITY_NAN:
+        *y = *z;
+        break;
+
+case ZERO_SUBNORMAL:
+case ZERO_NORMAL:
+case ZERO_INFINITY:
+case SUBNORMAL_INFINITY:
+case NORMAL_INFINITY:
+        *y = *z;
+        z->sign ^= operation;
+        break;
+
+case SUBNORMAL_SUBNORMAL:
+case SUBNORMAL_NORMAL:
+case NORMAL_SUBNORMAL:
+case NORMAL_NORMAL:
+        locx = *x;
+        locy = *y;
+
+        exponent_difference = locx.exp-locy.exp;
+        if (exponent_difference == 0)
+        {
+                if (locx.type == IFPF_IS_SUBNORMAL ||
+                  locy.type == IFPF_IS_SUBNORMAL)
+                        z->type = IFPF_IS_SUBNORMAL;
+                else
+                        z->type = IFPF_IS_NORMAL;
+                z->sign = locx.sign;
+                z->exp= locx.exp;
+        }
+        else
+                if (exponent_difference > 0)
+                {
+                        StickyShiftRightWide(&locy, exponent_difference);
+                        z->type = locx.type;
+                        z->sign = locx.sign;
+                        z->exp = locx.exp;
+                }
+                else
+                {
+                        StickyShiftRightWide(&locx, -exponent_difference);
+                        z->type = locy.type;
+                        z->sign = locy.sign ^ operation;
+                        z->exp = locy.exp;
+                }
+
+                if (locx.sign ^ locy.sign ^ operation)
+                {
+                        /*
+                        ** Subtract; a borrow out means y was the
+                        ** larger, so negate and flip the sign.
+                        */
+                        z->mant = locx.mant - locy.mant;
+                        if (locx.mant < locy.mant)
+                        {
+                                z->sign = locy.sign ^ operation;
+                                z->mant = (u64w)0 - z->mant;
+                        }
+
+                        if (z->mant == 0)
+                        {
+                                z->type = IFPF_IS_ZERO;
+                                z->sign = 0;
+                        }
+                        else
+                                if (locx.type == IFPF_IS_NORMAL ||
+                                         locy.type == IFPF_IS_NORMAL)
+                                        normalizeWide(z);
+                }
+                else
+                {
+                        z->mant = locx.mant + locy.mant;
+                        if (z->mant < locx.mant)
+                        {
+                                /* Carry out: shift it back in */
+                                z->exp++;
+                                z->mant = (z->mant >> 1) | WIDE_TOP;
+                                z->type = IFPF_IS_NORMAL;
+                        }
+                        else
+                                if (z->mant & WIDE_TOP)
+                                        z->type = IFPF_IS_NORMAL;
+        }
+        break;
+
+case INFINITY_INFINITY:
+        SetWideFPFNaN(z);
+        break;
+
+case NAN_NAN:
+        choose_nan_wide(x, y, z, 1);
+        break;
+}
+
+RoundWideFPF(z);
+return;
+}
+
+/*********************
+** MultiplyWideFPF **
+**********************
+** As MultiplyInternalFPF(): the 128-bit product, shifted
+** until its top bit is set, keeps the high half; the low half
+** only decides the sticky bit.
+*/
+static void MultiplyWideFPF(WideFPF *x,
+                        WideFPF *y,
+                        WideFPF *z)
+{
+u128w product;
+u64w extra_bits;
+int n;
+
+switch ((x->type * IFPF_TYPE_COUNT) + y->type)
+{
+case INFINITY_SUBNORMAL:
+case INFINITY_NORMAL:
+case INFINITY_INFINITY:
+case ZERO_ZERO:
+case ZERO_SUBNORMAL:
+case ZERO_NORMAL:
+        *x = *z;
+        z->sign ^= y->sign;
+        break;
+
+case SUBNORMAL_INFINITY:
+case NORMAL_INFINITY:
+case SUBNORMAL_ZERO:
+case NORMAL_ZERO:
+        *y = *z;
+        z->sign ^= x->sign;
+        break;
+
+case ZERO_INFINITY:
+case INFINITY_ZERO:
+        SetWideFPFNaN(z);
+        break;
+
+case NAN_ZERO:
+case NAN_SUBNORMAL:
+case NAN_NORMAL:
+case NAN_INFINITY:
+        *x = *z;
+        break;
+
+case ZERO_NAN:
+case SUBNORMAL_NAN:
+case NORMAL_NAN:
+case INFINITY_NAN:
+        *y = *z;
+        break;
+
+case SUBNORMAL_SUBNORMAL:
+case SUBNORMAL_NORMAL:
+case NORMAL_SUBNORMAL:
+case NORMAL_NORMAL:
+        if (x->type == IFPF_IS_SUBNORMAL ||
+            y->type == IFPF_IS_SUBNORMAL)
+                z->type = IFPF_IS_SUBNORMAL;
+        else
+                z->type = IFPF_IS_NORMAL;
+
+        z->sign = x->sign ^ y->sign;
+        z->exp = x->exp + y->exp;
+        product = (u128w)x->mant * y->mant;
+        if (product != 0)
+        {
+                n = (u64w)(product >> 64) != 0 ?
+                        __builtin_clzll((u64w)(product >> 64)) :
+                        64 + __builtin_clzll((u64w)product);
+                product <<= n;
+                z->exp -= n;
+        }
+        z->mant = (u64w)(product >> 64);
+        extra_bits = (u64w)product;
+
+        /* Sticky bit, as the original sets it */
+        if (extra_bits == 0)
+                z->mant |= 1;
+        break;
+
+case NAN_NAN:
+        choose_nan_wide(x, y, z, 0);
+        break;
+}
+
+RoundWideFPF(z);
+return;
+}
+
+/*******************
+** DivideWideFPF **
+********************
+** As DivideInternalFPF(), whose long division stops at the
+** first quotient with its top bit set: that is x and y,
+** normalized, divided with x shifted up 63 bits, or 64 if it
+** is the smaller.  The remainder is dropped, as there.
+*/
+static void DivideWideFPF(WideFPF *x,
+                        WideFPF *y,
+                        WideFPF *z)
+{
+u64w xn, yn, hi, lo, q, r;
+int cx, cy, s;
+
+switch ((x->type * IFPF_TYPE_COUNT) + y->type)
+{
+case ZERO_ZERO:
+case INFINITY_INFINITY:
+        SetWideFPFNaN(z);
+        break;
+
+case ZERO_SUBNORMAL:
+case ZERO_NORMAL:
+        if (y->mant == 0)
+        {
+                SetWideFPFNaN(z);
+                break;
+        }
+
+case ZERO_INFINITY:
+case SUBNORMAL_INFINITY:
+case NORMAL_INFINITY:
+        SetWideFPFZero(z, x->sign ^ y->sign);
+        break;
+
+case SUBNORMAL_ZERO:
+case NORMAL_ZERO:
+        if (x->mant == 0)
+        {
+                SetWideFPFNaN(z);
+                break;
+        }
+
+case INFINITY_ZERO:
+case INFINITY_SUBNORMAL:
+case INFINITY_NORMAL:
+        SetWideFPFInfinity(z, 0);
+        z->sign = x->sign ^ y->sign;
+        break;
+
+case NAN_ZERO:
+case NAN_SUBNORMAL:
+case NAN_NORMAL:
+case NAN_INFINITY:
+        *x = *z;
+        break;
+
+case ZERO_NAN:
+case SUBNORMAL_NAN:
+case NORMAL_NAN:
+case INFINITY_NAN:
+        *y = *z;
+        break;
+
+case SUBNORMAL_SUBNORMAL:
+case NORMAL_SUBNORMAL:
+case SUBNORMAL_NORMAL:
+case NORMAL_NORMAL:
+        if (x->mant == 0)
+        {
+                if (y->mant == 0)
+                        SetWideFPFNaN(z);
+                else
+                        SetWideFPFZero(z, 0);
+                break;
+        }
+        if (y->mant == 0)
+        {
+                SetWideFPFInfinity(z, 0);
+                break;
+        }
+
+        z->type = x->type;
+        z->sign = x->sign ^ y->sign;
+        cx = __builtin_clzll(x->mant);
+        cy = __builtin_clzll(y->mant);
+        xn = x->mant << cx;
+        yn = y->mant << cy;
+        s = xn < yn ? 64 : 63;
+        hi = xn >> (64 - s);
+        lo = s == 64 ? 0 : xn << s;
+
+        /* hi < yn, so the quotient fits in 64 bits */
+        __asm__ ("divq %4" : "=a" (q), "=d" (r) : "a" (lo), "d" (hi),
+                "rm" (yn));
+        z->mant = q;
+
+        /* One quotient bit per step of the original */
+        z->exp = x->exp - y->exp + 2 * WIDE_BITS;
+        z->exp -= (s + 64) + cx - cy;
+        break;
+
+case NAN_NAN:
+        choose_nan_wide(x, y, z, 0);
+        break;
+}
+
+RoundWideFPF(z);
+}
+
+/*******************
+** Int32ToWideFPF **
+********************
+** As Int32ToInternalFPF().
+*/
+static void Int32ToWideFPF(int32 mylong,
+                WideFPF *dest)
+{
+if(mylong<(int32)0)
+{       dest->sign=1;
+        mylong=(int32)0-mylong;
+}
+else
+        dest->sign=0;
+
+dest->type=IFPF_IS_NORMAL;
+dest->mant=0;
+if(mylong==0)
+{       dest->type=IFPF_IS_ZERO;
+        dest->exp=0;
+        return;
+}
+
+dest->exp=32;
+dest->mant=(u64w)(u32)mylong<<32;
+normalizeWide(dest);
+return;
+}
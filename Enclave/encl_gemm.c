@@ -0,0 +1,222 @@
+/*
+** encl_gemm.c
+** Cache-blocked double-precision matrix multiply.
+**
+** C is walked in blocks of GEMMKC rows of B by GEMMNC
+** columns, small enough for the block of B to stay in the
+** L2 cache while every row of A goes past it.  Inside a
+** block, a 4-row strip of C is kept in registers while the
+** strip of A and the block of B are read once.  The columns
+** that do not fill the vectors, and the last rows, go
+** through the scalar kernel.
+*/
+
+#include <immintrin.h>
+#include "nmglobal.h"
+#include "encl_gemm.h"
+
+#define GEMMKC 128              /* Rows of B per block */
+#define GEMMNC 512              /* Columns of B per block */
+
+/*****************
+** strip_scalar **
+******************
+** C[0..mr)[0..nr) += alpha * A[0..mr)[0..kc) * B[0..kc)[0..nr).
+*/
+static void strip_scalar(long mr, long nr, long kc, double alpha,
+        const double *a, long lda, const double *b, long ldb,
+        double *c, long ldc)
+{
+long i, j, p;
+double aip;
+
+for(i=0;i<mr;i++)
+        for(p=0;p<kc;p++)
+        {       aip=alpha*a[i*lda+p];
+                for(j=0;j<nr;j++)
+                        c[i*ldc+j]+=aip*b[p*ldb+j];
+        }
+}
+
+/***************
+** strip_sse2 **
+****************
+** 4 rows by nr columns, 4 columns at a time; returns the
+** # of columns done.  SSE2 is part of x86-64, so it needs
+** no target attribute.
+*/
+#define SSE2_ROW(r) \
+        do { va=_mm_set1_pd(a[(r)*lda+p]); \
+             c##r##0=_mm_add_pd(c##r##0,_mm_mul_pd(va,b0)); \
+             c##r##1=_mm_add_pd(c##r##1,_mm_mul_pd(va,b1)); } while(0)
+#define SSE2_STORE(r) \
+        do { _mm_storeu_pd(c+(r)*ldc+j,_mm_add_pd( \
+                _mm_loadu_pd(c+(r)*ldc+j),_mm_mul_pd(va,c##r##0))); \
+             _mm_storeu_pd(c+(r)*ldc+j+2,_mm_add_pd( \
+                _mm_loadu_pd(c+(r)*ldc+j+2),_mm_mul_pd(va,c##r##1))); \
+        } while(0)
+
+static long strip_sse2(long nr, long kc, double alpha, const double *a,
+        long lda, const double *b, long ldb, double *c, long ldc)
+{
+long j, p;
+__m128d c00, c01, c10, c11, c20, c21, c30, c31;
+__m128d b0, b1, va;
+
+for(j=0;j+4<=nr;j+=4)
+{       c00=c01=c10=c11=c20=c21=c30=c31=_mm_setzero_pd();
+        for(p=0;p<kc;p++)
+        {       b0=_mm_loadu_pd(b+p*ldb+j);
+                b1=_mm_loadu_pd(b+p*ldb+j+2);
+                SSE2_ROW(0);
+                SSE2_ROW(1);
+                SSE2_ROW(2);
+                SSE2_ROW(3);
+        }
+        va=_mm_set1_pd(alpha);
+        SSE2_STORE(0);
+        SSE2_STORE(1);
+        SSE2_STORE(2);
+        SSE2_STORE(3);
+}
+return(j);
+}
+
+/***************
+** strip_avx2 **
+****************
+** 4 rows by nr columns, 8 columns at a time; returns the
+** # of columns done.  AVX2 does not imply FMA, so the
+** products are added separately.
+*/
+#define AVX2_ROW(r) \
+        do { va=_mm256_set1_pd(a[(r)*lda+p]); \
+             c##r##0=_mm256_add_pd(c##r##0,_mm256_mul_pd(va,b0)); \
+             c##r##1=_mm256_add_pd(c##r##1,_mm256_mul_pd(va,b1)); } while(0)
+#define AVX2_STORE(r) \
+        do { _mm256_storeu_pd(c+(r)*ldc+j,_mm256_add_pd( \
+                _mm256_loadu_pd(c+(r)*ldc+j),_mm256_mul_pd(va,c##r##0))); \
+             _mm256_storeu_pd(c+(r)*ldc+j+4,_mm256_add_pd( \
+                _mm256_loadu_pd(c+(r)*ldc+j+4),_mm256_mul_pd(va,c##r##1))); \
+        } while(0)
+
+static __attribute__((target("avx2"))) long strip_avx2(long nr, long kc,
+        double alpha, const double *a, long lda, const double *b,
+        long ldb, double *c, long ldc)
+{
+long j, p;
+__m256d c00, c01, c10, c11, c20, c21, c30, c31;
+__m256d b0, b1, va;
+
+for(j=0;j+8<=nr;j+=8)
+{       c00=c01=c10=c11=c20=c21=c30=c31=_mm256_setzero_pd();
+        for(p=0;p<kc;p++)
+        {       b0=_mm256_loadu_pd(b+p*ldb+j);
+                b1=_mm256_loadu_pd(b+p*ldb+j+4);
+                AVX2_ROW(0);
+                AVX2_ROW(1);
+                AVX2_ROW(2);
+                AVX2_ROW(3);
+        }
+        va=_mm256_set1_pd(alpha);
+        AVX2_STORE(0);
+        AVX2_STORE(1);
+        AVX2_STORE(2);
+        AVX2_STORE(3);
+}
+return(j);
+}
+
+/*****************
+** strip_avx512 **
+******************
+** 4 rows by nr columns, 16 columns at a time, with fused
+** multiply-adds (part of AVX-512F); returns the # of
+** columns done.
+*/
+#define AVX512_ROW(r) \
+        do { va=_mm512_set1_pd(a[(r)*lda+p]); \
+             c##r##0=_mm512_fmadd_pd(va,b0,c##r##0); \
+             c##r##1=_mm512_fmadd_pd(va,b1,c##r##1); } while(0)
+#define AVX512_STORE(r) \
+        do { _mm512_storeu_pd(c+(r)*ldc+j,_mm512_fmadd_pd(va,c##r##0, \
+                _mm512_loadu_pd(c+(r)*ldc+j))); \
+             _mm512_storeu_pd(c+(r)*ldc+j+8,_mm512_fmadd_pd(va,c##r##1, \
+                _mm512_loadu_pd(c+(r)*ldc+j+8))); } while(0)
+
+static __attribute__((target("avx512f"))) long strip_avx512(long nr,
+        long kc, double alpha, const double *a, long lda,
+        const double *b, long ldb, double *c, long ldc)
+{
+long j, p;
+__m512d c00, c01, c10, c11, c20, c21, c30, c31;
+__m512d b0, b1, va;
+
+for(j=0;j+16<=nr;j+=16)
+{       c00=c01=c10=c11=c20=c21=c30=c31=_mm512_setzero_pd();
+        for(p=0;p<kc;p++)
+        {       b0=_mm512_loadu_pd(b+p*ldb+j);
+                b1=_mm512_loadu_pd(b+p*ldb+j+8);
+                AVX512_ROW(0);
+                AVX512_ROW(1);
+                AVX512_ROW(2);
+                AVX512_ROW(3);
+        }
+        va=_mm512_set1_pd(alpha);
+        AVX512_STORE(0);
+        AVX512_STORE(1);
+        AVX512_STORE(2);
+        AVX512_STORE(3);
+}
+return(j);
+}
+
+/*********
+** gemm **
+**********
+** See encl_gemm.h.
+*/
+void gemm(int level, long m, long n, long k, double alpha,
+        const double *a, long lda, const double *b, long ldb,
+        double *c, long ldc)
+{
+long p0, j0, i, kc, nc, done;
+
+for(p0=0;p0<k;p0+=GEMMKC)
+{       kc=k-p0<GEMMKC ? k-p0 : GEMMKC;
+        for(j0=0;j0<n;j0+=GEMMNC)
+        {       nc=n-j0<GEMMNC ? n-j0 : GEMMNC;
+                for(i=0;i+4<=m;i+=4)
+                {       switch(level)
+                        {       case SIMD_AVX512:
+                                        done=strip_avx512(nc,kc,alpha,
+                                                a+i*lda+p0,lda,
+                                                b+p0*ldb+j0,ldb,
+                                                c+i*ldc+j0,ldc);
+                                        break;
+                                case SIMD_AVX2:
+                                        done=strip_avx2(nc,kc,alpha,
+                                                a+i*lda+p0,lda,
+                                                b+p0*ldb+j0,ldb,
+                                                c+i*ldc+j0,ldc);
+                                        break;
+                                default:
+                                        done=strip_sse2(nc,kc,alpha,
+                                                a+i*lda+p0,lda,
+                                                b+p0*ldb+j0,ldb,
+                                                c+i*ldc+j0,ldc);
+                        }
+                        if(done<nc)
+                                strip_scalar(4,nc-done,kc,alpha,
+                                        a+i*lda+p0,lda,
+                                        b+p0*ldb+j0+done,ldb,
+                                        c+i*ldc+j0+done,ldc);
+                }
+                if(i<m)
+                        strip_scalar(m-i,nc,kc,alpha,
+                                a+i*lda+p0,lda,
+                                b+p0*ldb+j0,ldb,
+                                c+i*ldc+j0,ldc);
+        }
+}
+}
@@ -0,0 +1,29 @@
+/*
+** encl_gemm.h
+** Cache-blocked double-precision matrix multiply.
+**
+** The kernels work on 4 rows at a time, 1 (scalar), 4 (SSE2),
+** 8 (AVX2) or 16 (AVX-512F) columns wide, as the SIMD_xxx
+** level passed in allows.
+*/
+
+#ifndef _ENCL_GEMM_H_
+#define _ENCL_GEMM_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+** C += alpha * A * B, all row-major: A is m x k with rows
+** lda apart, B k x n (ldb), C m x n (ldc).
+*/
+extern void gemm(int level, long m, long n, long k, double alpha,
+        const double *a, long lda, const double *b, long ldb,
+        double *c, long ldc);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_GEMM_H_ */
@@ -0,0 +1,266 @@
+/*
+** encl_huffman.c
+** Table-driven canonical Huffman coder, the codec of the
+** Huffman (table) test.
+**
+** Same job as encl_callHuffman() -- count the bytes, build a
+** code, compress, decompress -- done the way a production
+** coder would:
+**  the tree is built from the symbols sorted by count, with
+**   two queues (leaves, then merged nodes), in linear time
+**  code lengths are capped at HUFFMAXBITS and turned into a
+**   canonical code, one table entry per symbol
+**  the coder ORs whole codes into a 64-bit bit buffer and
+**   stores 32 bits at a time
+**  the decoder looks up HUFFMAXBITS bits at once in a table
+**   that gives the symbol and its length
+** Bits are kept LSB first, so codes are stored bit-reversed.
+*/
+
+#include <string.h>
+#include "nmglobal.h"
+#include "encl_huffman.h"
+
+/*
+** Longest code; the decoding table has 2**HUFFMAXBITS
+** entries.
+*/
+#define HUFFMAXBITS 12
+#define HUFFLUTSIZE (1<<HUFFMAXBITS)
+
+typedef struct {
+        u32 count[256];         /* Occurrences of each byte */
+        u8 len[256];            /* Code length, 0 if unused */
+        u16 rcode[256];         /* Code, bit-reversed */
+        u16 lut[HUFFLUTSIZE];   /* Symbol<<4 | length, 0 if invalid */
+} HuffTable;
+
+static void huff_lengths(HuffTable *t);
+static void huff_codes(HuffTable *t);
+
+/*************************
+** huff_table_roundtrip **
+**************************
+** See encl_huffman.h.
+*/
+long huff_table_roundtrip(const unsigned char *plain, long n,
+        unsigned char *comp, long compsize,
+        unsigned char *decomp)
+{
+HuffTable t;                    /* Code and decoding table */
+unsigned long long bitbuf;      /* Pending bits, LSB first */
+int bits;                       /* # of bits in bitbuf */
+long pos;                       /* Byte offset in comp */
+long complen;                   /* Compressed length */
+u32 word;
+u16 e;                          /* Decoding table entry */
+long i;
+
+/*
+** Count the bytes and build the code.
+*/
+memset(t.count,0,sizeof(t.count));
+for(i=0;i<n;i++)
+        t.count[plain[i]]++;
+huff_lengths(&t);
+huff_codes(&t);
+
+/*
+** Compress.  A code is at most HUFFMAXBITS long, so after
+** each flush of 32 bits there is room for the next one.
+*/
+bitbuf=0;
+bits=0;
+pos=0;
+for(i=0;i<n;i++)
+{       bitbuf|=(unsigned long long)t.rcode[plain[i]]<<bits;
+        bits+=t.len[plain[i]];
+        if(bits>=32)
+        {       if(pos+4>compsize)
+                        return(HUFFOVERFLOW);
+                word=(u32)bitbuf;
+                memcpy(comp+pos,&word,4);
+                pos+=4;
+                bitbuf>>=32;
+                bits-=32;
+        }
+}
+while(bits>0)
+{       if(pos>=compsize)
+                return(HUFFOVERFLOW);
+        comp[pos++]=(unsigned char)bitbuf;
+        bitbuf>>=8;
+        bits-=8;
+}
+complen=pos;
+
+/*
+** Decompress: one table lookup per symbol.  Past the end
+** of the data the bit buffer is padded with zeros.
+*/
+bitbuf=0;
+bits=0;
+pos=0;
+for(i=0;i<n;i++)
+{       if(bits<HUFFMAXBITS)
+        {       if(pos+4<=complen)
+                {       memcpy(&word,comp+pos,4);
+                        bitbuf|=(unsigned long long)word<<bits;
+                        pos+=4;
+                        bits+=32;
+                }
+                else
+                {       while(bits<=56 && pos<complen)
+                        {       bitbuf|=(unsigned long long)comp[pos++]<<bits;
+                                bits+=8;
+                        }
+                        if(bits<HUFFMAXBITS)
+                                bits=HUFFMAXBITS;
+                }
+        }
+        e=t.lut[bitbuf & (HUFFLUTSIZE-1)];
+        if(e==0)
+                return(HUFFMISMATCH);
+        decomp[i]=(unsigned char)(e>>4);
+        bitbuf>>=(e & 15);
+        bits-=(e & 15);
+}
+
+if(memcmp(decomp,plain,n)!=0)
+        return(HUFFMISMATCH);
+return(complen);
+}
+
+/*****************
+** huff_lengths **
+******************
+** Code length of every byte that occurs.  The symbols are
+** sorted by count; merged nodes come out of the merge in
+** order of weight, so the two lightest nodes are always at
+** the head of one of the two queues.  Lengths over
+** HUFFMAXBITS are cut back and the code is made complete
+** again by lengthening shorter codes.
+*/
+static void huff_lengths(HuffTable *t)
+{
+u16 sym[256];                   /* Symbols, by ascending count */
+u32 weight[511];                /* Leaves, then merged nodes */
+u16 parent[511];
+u8 depth[511];
+int numlen[HUFFMAXBITS+1];      /* # of codes of each length */
+u32 total;                      /* Kraft sum, in 2**-HUFFMAXBITS */
+int n;                          /* # of symbols */
+int i, j, k, a, b, next, l;
+u16 s;
+
+memset(t->len,0,sizeof(t->len));
+n=0;
+for(i=0;i<256;i++)
+        if(t->count[i]!=0)
+        {       /* Insertion sort; there are few symbols */
+                for(j=n;j>0 && t->count[sym[j-1]]>t->count[i];j--)
+                        sym[j]=sym[j-1];
+                sym[j]=(u16)i;
+                n++;
+        }
+if(n==0)
+        return;
+if(n==1)
+{       t->len[sym[0]]=1;
+        return;
+}
+
+for(i=0;i<n;i++)
+        weight[i]=t->count[sym[i]];
+i=0;                            /* Head of the leaves */
+j=n;                            /* Head of the merged nodes */
+for(next=n;next<2*n-1;next++)
+{       if(i<n && (j>=next || weight[i]<=weight[j]))
+                a=i++;
+        else
+                a=j++;
+        if(i<n && (j>=next || weight[i]<=weight[j]))
+                b=i++;
+        else
+                b=j++;
+        weight[next]=weight[a]+weight[b];
+        parent[a]=parent[b]=(u16)next;
+}
+depth[2*n-2]=0;
+for(k=2*n-3;k>=0;k--)
+        depth[k]=depth[parent[k]]+1;
+
+/*
+** Count the lengths, cutting at HUFFMAXBITS.  Each step of
+** the loop drops one longest code and splits the next
+** shorter one in two, which lowers the Kraft sum by one.
+*/
+memset(numlen,0,sizeof(numlen));
+for(k=0;k<n;k++)
+        numlen[depth[k]>HUFFMAXBITS ? HUFFMAXBITS : depth[k]]++;
+total=0;
+for(l=1;l<=HUFFMAXBITS;l++)
+        total+=(u32)numlen[l]<<(HUFFMAXBITS-l);
+while(total>(1U<<HUFFMAXBITS))
+{       numlen[HUFFMAXBITS]--;
+        for(l=HUFFMAXBITS-1;l>0;l--)
+                if(numlen[l]!=0)
+                {       numlen[l]--;
+                        numlen[l+1]+=2;
+                        break;
+                }
+        total--;
+}
+
+/*
+** Shortest codes to the most frequent symbols.
+*/
+k=n-1;
+for(l=1;l<=HUFFMAXBITS;l++)
+        for(i=0;i<numlen[l];i++)
+        {       s=sym[k--];
+                t->len[s]=(u8)l;
+        }
+return;
+}
+
+/***************
+** huff_codes **
+****************
+** Canonical code from the lengths: codes of one length are
+** consecutive, in symbol order.  Fills in the bit-reversed
+** codes and the decoding table, where a code of length l
+** owns every entry whose low l bits are the code.
+*/
+static void huff_codes(HuffTable *t)
+{
+int numlen[HUFFMAXBITS+1];      /* # of codes of each length */
+u16 nextcode[HUFFMAXBITS+1];    /* Next code of each length */
+u16 code, rev;
+int s, l, k;
+
+memset(numlen,0,sizeof(numlen));
+for(s=0;s<256;s++)
+        numlen[t->len[s]]++;
+numlen[0]=0;
+code=0;
+for(l=1;l<=HUFFMAXBITS;l++)
+{       code=(u16)((code+numlen[l-1])<<1);
+        nextcode[l]=code;
+}
+
+memset(t->lut,0,sizeof(t->lut));
+for(s=0;s<256;s++)
+{       l=t->len[s];
+        if(l==0)
+                continue;
+        code=nextcode[l]++;
+        rev=0;
+        for(k=0;k<l;k++)
+                rev|=(u16)(((code>>k) & 1)<<(l-1-k));
+        t->rcode[s]=rev;
+        for(k=rev;k<HUFFLUTSIZE;k+=1<<l)
+                t->lut[k]=(u16)((s<<4) | l);
+}
+return;
+}
@@ -0,0 +1,30 @@
+/*
+** encl_huffman.h
+** Table-driven canonical Huffman coder.
+*/
+
+#ifndef _ENCL_HUFFMAN_H_
+#define _ENCL_HUFFMAN_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Include after nmglobal.h, for HUFFMISMATCH and HUFFOVERFLOW. */
+
+/*
+** Compress n bytes of plain into comp (compsize bytes at
+** most), decompress that into decomp and check it against
+** plain.  Returns the compressed length, HUFFOVERFLOW if
+** comp is too small or HUFFMISMATCH if the round trip does
+** not match.
+*/
+extern long huff_table_roundtrip(const unsigned char *plain, long n,
+        unsigned char *comp, long compsize,
+        unsigned char *decomp);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_HUFFMAN_H_ */
@@ -0,0 +1,123 @@
+/*
+** encl_idea_kernel.h
+** Body of the multi-block IDEA kernel.
+**
+** Included by encl_idea_simd.c once per instruction set,
+** after defining:
+**  KERNEL          name of the function
+**  TARGET          its target attribute (may be empty)
+**  VEC             vector type
+**  V_LOAD(p)       unaligned load
+**  V_STORE(p,v)    unaligned store
+**  V_SET1(x)       broadcast a 16-bit word
+**  V_ADD, V_XOR    add modulo 2**16, exclusive or
+**  V_MUL           multiply modulo 2**16+1, as mul()
+**  V_LO16 .. V_HI64 unpack 16/32/64-bit words
+** A VEC holds one word of as many blocks as it has 16-bit
+** lanes; four VECs make a group.
+*/
+
+static TARGET unsigned long KERNEL(const unsigned short *in,
+        unsigned short *out,
+        unsigned long nblocks,
+        const unsigned short *Z)
+{
+VEC key[KEYLEN];                /* Subkeys, one per lane */
+const VEC *k;                   /* Subkeys of this round */
+VEC a0, a1, a2, a3;             /* Blocks as loaded */
+VEC t0, t1, t2, t3;
+VEC x1, x2, x3, x4, s1, s2;
+unsigned long lanes;            /* Blocks in a group */
+unsigned long done;             /* Blocks done */
+int r;
+
+lanes=sizeof(VEC)/sizeof(unsigned short);
+for(r=0;r<KEYLEN;r++)
+        key[r]=V_SET1(Z[r]);
+
+for(done=0;done+lanes<=nblocks;done+=lanes)
+{
+        /*
+        ** Gather word j of every block into xj.  The unpacks
+        ** work within 128-bit lanes, so wider vectors hold the
+        ** blocks out of order; the stores below undo that.
+        */
+        a0=V_LOAD(in);
+        a1=V_LOAD(in+lanes);
+        a2=V_LOAD(in+2*lanes);
+        a3=V_LOAD(in+3*lanes);
+        t0=V_LO16(a0,a1);
+        t1=V_HI16(a0,a1);
+        t2=V_LO16(a2,a3);
+        t3=V_HI16(a2,a3);
+        a0=V_LO16(t0,t1);
+        a1=V_HI16(t0,t1);
+        a2=V_LO16(t2,t3);
+        a3=V_HI16(t2,t3);
+        x1=V_LO64(a0,a2);
+        x2=V_HI64(a0,a2);
+        x3=V_LO64(a1,a3);
+        x4=V_HI64(a1,a3);
+
+        /*
+        ** Same rounds as cipher_idea().
+        */
+        k=key;
+        for(r=0;r<ROUNDS;r++)
+        {       x1=V_MUL(x1,k[0]);
+                x2=V_ADD(x2,k[1]);
+                x3=V_ADD(x3,k[2]);
+                x4=V_MUL(x4,k[3]);
+
+                s2=V_XOR(x1,x3);
+                s2=V_MUL(s2,k[4]);
+                s1=V_ADD(s2,V_XOR(x2,x4));
+                s1=V_MUL(s1,k[5]);
+                s2=V_ADD(s1,s2);
+
+                x1=V_XOR(x1,s1);
+                x4=V_XOR(x4,s2);
+
+                s2=V_XOR(s2,x2);
+                x2=V_XOR(x3,s1);
+                x3=s2;
+                k+=6;
+        }
+        x1=V_MUL(x1,k[0]);
+        s1=V_ADD(x3,k[1]);
+        s2=V_ADD(x2,k[2]);
+        x4=V_MUL(x4,k[3]);
+
+        /*
+        ** Scatter x1, x3+Z, x2+Z, x4 back into blocks.
+        */
+        t0=V_LO16(x1,s1);
+        t1=V_LO16(s2,x4);
+        t2=V_HI16(x1,s1);
+        t3=V_HI16(s2,x4);
+        V_STORE(out,V_LO32(t0,t1));
+        V_STORE(out+lanes,V_HI32(t0,t1));
+        V_STORE(out+2*lanes,V_LO32(t2,t3));
+        V_STORE(out+3*lanes,V_HI32(t2,t3));
+
+        in+=4*lanes;
+        out+=4*lanes;
+}
+return(done);
+}
+
+#undef KERNEL
+#undef TARGET
+#undef VEC
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ADD
+#undef V_XOR
+#undef V_MUL
+#undef V_LO16
+#undef V_HI16
+#undef V_LO32
+#undef V_HI32
+#undef V_LO64
+#undef V_HI64
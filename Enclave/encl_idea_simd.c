@@ -0,0 +1,170 @@
+/*
+** encl_idea_simd.c
+** Multi-block IDEA for SSE2, AVX2 and AVX-512BW.
+**
+** IDEA works on 16-bit words, so a block fits one 16-bit
+** lane per word: x1..x4 of 8, 16 or 32 blocks are held in
+** four vectors and go through the rounds together.  The
+** multiply modulo 2**16+1 uses the low and high halves of
+** the 16x16 product (pmullw/pmulhuw) and a compare for the
+** carry, and picks 1-a-b for lanes where a or b is zero --
+** exactly what mul() returns, so the output is bit-identical
+** to cipher_idea().
+*/
+
+#include <immintrin.h>
+#include "nmglobal.h"
+#include "encl_idea_simd.h"
+
+#define ROUNDS 8                /* Same as Enclave.cpp */
+#define KEYLEN (6*ROUNDS+4)
+
+/*************
+** mul_sse2 **
+**************
+** mul() on 8 lanes.
+*/
+static inline __m128i mul_sse2(__m128i a, __m128i b)
+{
+__m128i lo, hi, sign, borrow, r, zero, z;
+
+lo=_mm_mullo_epi16(a,b);
+hi=_mm_mulhi_epu16(a,b);
+sign=_mm_set1_epi16((short)0x8000);
+borrow=_mm_cmpgt_epi16(_mm_xor_si128(hi,sign),_mm_xor_si128(lo,sign));
+r=_mm_sub_epi16(_mm_sub_epi16(lo,hi),borrow);
+zero=_mm_setzero_si128();
+z=_mm_or_si128(_mm_cmpeq_epi16(a,zero),_mm_cmpeq_epi16(b,zero));
+return(_mm_or_si128(_mm_andnot_si128(z,r),
+        _mm_and_si128(z,_mm_sub_epi16(_mm_sub_epi16(_mm_set1_epi16(1),a),b))));
+}
+
+#define KERNEL idea_sse2
+#define TARGET
+#define VEC __m128i
+#define V_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define V_STORE(p,v) _mm_storeu_si128((__m128i *)(p),v)
+#define V_SET1(x) _mm_set1_epi16((short)(x))
+#define V_ADD _mm_add_epi16
+#define V_XOR _mm_xor_si128
+#define V_MUL mul_sse2
+#define V_LO16 _mm_unpacklo_epi16
+#define V_HI16 _mm_unpackhi_epi16
+#define V_LO32 _mm_unpacklo_epi32
+#define V_HI32 _mm_unpackhi_epi32
+#define V_LO64 _mm_unpacklo_epi64
+#define V_HI64 _mm_unpackhi_epi64
+#include "encl_idea_kernel.h"
+
+/*************
+** mul_avx2 **
+**************
+** mul() on 16 lanes.
+*/
+static inline __attribute__((target("avx2"))) __m256i mul_avx2(__m256i a,
+        __m256i b)
+{
+__m256i lo, hi, sign, borrow, r, zero, z;
+
+lo=_mm256_mullo_epi16(a,b);
+hi=_mm256_mulhi_epu16(a,b);
+sign=_mm256_set1_epi16((short)0x8000);
+borrow=_mm256_cmpgt_epi16(_mm256_xor_si256(hi,sign),
+        _mm256_xor_si256(lo,sign));
+r=_mm256_sub_epi16(_mm256_sub_epi16(lo,hi),borrow);
+zero=_mm256_setzero_si256();
+z=_mm256_or_si256(_mm256_cmpeq_epi16(a,zero),_mm256_cmpeq_epi16(b,zero));
+return(_mm256_blendv_epi8(r,
+        _mm256_sub_epi16(_mm256_sub_epi16(_mm256_set1_epi16(1),a),b),z));
+}
+
+#define KERNEL idea_avx2
+#define TARGET __attribute__((target("avx2")))
+#define VEC __m256i
+#define V_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define V_STORE(p,v) _mm256_storeu_si256((__m256i *)(p),v)
+#define V_SET1(x) _mm256_set1_epi16((short)(x))
+#define V_ADD _mm256_add_epi16
+#define V_XOR _mm256_xor_si256
+#define V_MUL mul_avx2
+#define V_LO16 _mm256_unpacklo_epi16
+#define V_HI16 _mm256_unpackhi_epi16
+#define V_LO32 _mm256_unpacklo_epi32
+#define V_HI32 _mm256_unpackhi_epi32
+#define V_LO64 _mm256_unpacklo_epi64
+#define V_HI64 _mm256_unpackhi_epi64
+#include "encl_idea_kernel.h"
+
+/***************
+** mul_avx512 **
+****************
+** mul() on 32 lanes; the carry and the zero lanes are
+** handled with mask registers.
+*/
+static inline __attribute__((target("avx512f,avx512bw"))) __m512i mul_avx512(
+        __m512i a, __m512i b)
+{
+__m512i lo, hi, one, zero, r;
+__mmask32 z;
+
+lo=_mm512_mullo_epi16(a,b);
+hi=_mm512_mulhi_epu16(a,b);
+one=_mm512_set1_epi16(1);
+zero=_mm512_setzero_si512();
+r=_mm512_sub_epi16(lo,hi);
+r=_mm512_mask_add_epi16(r,_mm512_cmplt_epu16_mask(lo,hi),r,one);
+z=_mm512_cmpeq_epi16_mask(a,zero) | _mm512_cmpeq_epi16_mask(b,zero);
+return(_mm512_mask_blend_epi16(z,r,
+        _mm512_sub_epi16(_mm512_sub_epi16(one,a),b)));
+}
+
+#define KERNEL idea_avx512
+#define TARGET __attribute__((target("avx512f,avx512bw")))
+#define VEC __m512i
+#define V_LOAD(p) _mm512_loadu_si512((const void *)(p))
+#define V_STORE(p,v) _mm512_storeu_si512((void *)(p),v)
+#define V_SET1(x) _mm512_set1_epi16((short)(x))
+#define V_ADD _mm512_add_epi16
+#define V_XOR _mm512_xor_si512
+#define V_MUL mul_avx512
+#define V_LO16 _mm512_unpacklo_epi16
+#define V_HI16 _mm512_unpackhi_epi16
+#define V_LO32 _mm512_unpacklo_epi32
+#define V_HI32 _mm512_unpackhi_epi32
+#define V_LO64 _mm512_unpacklo_epi64
+#define V_HI64 _mm512_unpackhi_epi64
+#include "encl_idea_kernel.h"
+
+/**************
+** idea_simd **
+***************
+** Run the kernel of the given SIMD_xxx level.
+*/
+unsigned long idea_simd(int level, const unsigned short *in,
+        unsigned short *out, unsigned long nblocks,
+        const unsigned short *Z)
+{
+switch(level)
+{       case SIMD_AVX512:
+                return(idea_avx512(in,out,nblocks,Z));
+        case SIMD_AVX2:
+                return(idea_avx2(in,out,nblocks,Z));
+}
+return(idea_sse2(in,out,nblocks,Z));
+}
+
+/*********************
+** idea_simd_blocks **
+**********************
+** Blocks per group of the given level.
+*/
+int idea_simd_blocks(int level)
+{
+switch(level)
+{       case SIMD_AVX512:
+                return(32);
+        case SIMD_AVX2:
+                return(16);
+}
+return(8);
+}
@@ -0,0 +1,33 @@
+/*
+** encl_idea_simd.h
+** Multi-block IDEA kernels.
+**
+** The kernels run cipher_idea() on 8 (SSE2), 16 (AVX2) or
+** 32 (AVX-512BW) blocks at once, one block per 16-bit lane;
+** the SIMD_xxx level passed in picks the kernel.
+*/
+
+#ifndef _ENCL_IDEA_SIMD_H_
+#define _ENCL_IDEA_SIMD_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+** Encrypt (or, with the decryption subkeys, decrypt)
+** nblocks 8-byte blocks from in to out.  Only whole groups
+** of idea_simd_blocks(level) blocks are done; the return
+** value is the # of blocks done, the caller finishes the
+** rest one block at a time.
+*/
+extern unsigned long idea_simd(int level, const unsigned short *in,
+        unsigned short *out, unsigned long nblocks,
+        const unsigned short *Z);
+extern int idea_simd_blocks(int level);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_IDEA_SIMD_H_ */
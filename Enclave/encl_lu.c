@@ -0,0 +1,196 @@
+/*
+** encl_lu.c
+** LU decomposition of an n x n matrix, for LU (BLOCKED).
+**
+** lu_crout() is ludcmp() of Enclave.cpp for any n: each
+** element of a column is a dot product down a column of a[],
+** which strides across the whole matrix once n outgrows the
+** cache.  lu_blocked() factors nb columns (the panel) with
+** rank-1 updates, and then updates the rest of the matrix
+** all at once: a triangular solve for the rows of the panel
+** and one matrix multiply, which does nearly all the flops,
+** for the trailing matrix.
+*/
+
+#include <math.h>
+#include "nmglobal.h"
+#include "encl_gemm.h"
+#include "encl_lu.h"
+
+#define LUTINY 1.0e-20          /* Stands in for a zero pivot */
+
+/**************
+** lu_crout **
+**************
+** See encl_lu.h.
+*/
+int lu_crout(double *a, long n, int *indx, double *vv)
+{
+double big, sum, dum;
+long i, j, k;
+long imax=0;
+
+for(i=0;i<n;i++)
+{       big=0.0;
+        for(j=0;j<n;j++)
+                if(fabs(a[i*n+j])>big)
+                        big=fabs(a[i*n+j]);
+        if(big==0.0) return(0);
+        vv[i]=1.0/big;
+}
+
+for(j=0;j<n;j++)
+{       for(i=0;i<j;i++)
+        {       sum=a[i*n+j];
+                for(k=0;k<i;k++)
+                        sum-=a[i*n+k]*a[k*n+j];
+                a[i*n+j]=sum;
+        }
+        big=0.0;
+        for(i=j;i<n;i++)
+        {       sum=a[i*n+j];
+                for(k=0;k<j;k++)
+                        sum-=a[i*n+k]*a[k*n+j];
+                a[i*n+j]=sum;
+                dum=vv[i]*fabs(sum);
+                if(dum>=big)
+                {       big=dum;
+                        imax=i;
+                }
+        }
+        if(j!=imax)
+        {       for(k=0;k<n;k++)
+                {       dum=a[imax*n+k];
+                        a[imax*n+k]=a[j*n+k];
+                        a[j*n+k]=dum;
+                }
+                dum=vv[imax];
+                vv[imax]=vv[j];
+                vv[j]=dum;
+        }
+        indx[j]=(int)imax;
+        if(a[j*n+j]==0.0)
+                a[j*n+j]=LUTINY;
+        dum=1.0/a[j*n+j];
+        for(i=j+1;i<n;i++)
+                a[i*n+j]*=dum;
+}
+return(1);
+}
+
+/************
+** lu_swap **
+*************
+** Interchange rows i and j of a.
+*/
+static void lu_swap(double *a, long n, long i, long j)
+{
+double *ri=a+i*n, *rj=a+j*n, t;
+long k;
+
+for(k=0;k<n;k++)
+{       t=ri[k];
+        ri[k]=rj[k];
+        rj[k]=t;
+}
+}
+
+/***************
+** lu_blocked **
+****************
+** See encl_lu.h.  Whole rows are interchanged, so the
+** columns left of the panel end up in the order of the
+** final permutation, as with ludcmp().
+*/
+int lu_blocked(int level, double *a, long n, long nb, int *indx)
+{
+long i, j, k, c, k0, kend, p;
+double big, piv, l;
+double *rj, *ri;
+
+for(i=0;i<n;i++)
+{       for(j=0;j<n;j++)
+                if(a[i*n+j]!=0.0) break;
+        if(j==n) return(0);
+}
+if(nb<1) nb=1;
+
+for(k0=0;k0<n;k0+=nb)
+{       kend=k0+nb<n ? k0+nb : n;
+
+        /*
+        ** Panel: columns k0..kend-1, every row from k0 down.
+        */
+        for(j=k0;j<kend;j++)
+        {       big=0.0;
+                p=j;
+                for(i=j;i<n;i++)
+                        if(fabs(a[i*n+j])>big)
+                        {       big=fabs(a[i*n+j]);
+                                p=i;
+                        }
+                if(p!=j)
+                        lu_swap(a,n,p,j);
+                indx[j]=(int)p;
+                rj=a+j*n;
+                if(rj[j]==0.0)
+                        rj[j]=LUTINY;
+                piv=1.0/rj[j];
+                for(i=j+1;i<n;i++)
+                {       ri=a+i*n;
+                        l=ri[j]*=piv;
+                        for(c=j+1;c<kend;c++)
+                                ri[c]-=l*rj[c];
+                }
+        }
+        if(kend==n) break;
+
+        /*
+        ** Rows of the panel right of it: solve with the unit
+        ** lower triangle of the panel.
+        */
+        for(j=k0;j<kend;j++)
+        {       rj=a+j*n;
+                for(i=j+1;i<kend;i++)
+                {       ri=a+i*n;
+                        l=ri[j];
+                        for(c=kend;c<n;c++)
+                                ri[c]-=l*rj[c];
+                }
+        }
+
+        /*
+        ** Trailing matrix: A22 -= L21 * U12.
+        */
+        k=kend-k0;
+        gemm(level,n-kend,n-kend,k,-1.0,
+                a+kend*n+k0,n,a+k0*n+kend,n,a+kend*n+kend,n);
+}
+return(1);
+}
+
+/*************
+** lu_solve **
+**************
+** See encl_lu.h.
+*/
+void lu_solve(const double *a, long n, const int *indx, double *b)
+{
+long i, j, ip;
+double sum;
+
+for(i=0;i<n;i++)
+{       ip=indx[i];
+        sum=b[ip];
+        b[ip]=b[i];
+        for(j=0;j<i;j++)
+                sum-=a[i*n+j]*b[j];
+        b[i]=sum;
+}
+for(i=n-1;i>=0;i--)
+{       sum=b[i];
+        for(j=i+1;j<n;j++)
+                sum-=a[i*n+j]*b[j];
+        b[i]=sum/a[i*n+i];
+}
+}
@@ -0,0 +1,42 @@
+/*
+** encl_lu.h
+** LU decomposition of an n x n matrix, for LU (BLOCKED).
+**
+** Both kernels leave the unit lower and the upper triangle
+** in a[] and record the row interchanges in indx[] the way
+** ludcmp() of Enclave.cpp does, so lu_solve() works after
+** either of them.
+*/
+
+#ifndef _ENCL_LU_H_
+#define _ENCL_LU_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+** ludcmp() for a row-major n x n matrix: Crout's algorithm
+** with implicit pivoting, one column at a time.  vv[] is n
+** doubles of scratch.  Returns 0 if a is singular, else 1.
+*/
+extern int lu_crout(double *a, long n, int *indx, double *vv);
+
+/*
+** Right-looking LU with partial pivoting, nb columns at a
+** time; the trailing matrix is updated with gemm() at the
+** SIMD_xxx level.  Returns 0 if a is singular, else 1.
+*/
+extern int lu_blocked(int level, double *a, long n, long nb, int *indx);
+
+/*
+** lubksb(): solve A x = b with the decomposition of a and
+** indx; b[] is replaced by x.
+*/
+extern void lu_solve(const double *a, long n, const int *indx, double *b);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_LU_H_ */
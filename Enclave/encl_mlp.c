@@ -0,0 +1,371 @@
+/*
+** encl_mlp.c
+** Multi-layer perceptron trained in mini-batches, for
+** Neural Net (MLP).
+**
+** For a batch X of b patterns with targets T:
+**   H  = f(X W1)                  Y = f(H W2)
+**   E2 = (T - Y) Y (1 - Y)        E1 = (E2 W2') H (1 - H)
+**   V2 = a V2 + (r/b) H' E2       W2 += V2
+**   V1 = a V1 + (r/b) X' E1       W1 += V1
+** with f the sigmoid, a the momentum and r the learning
+** rate; ' is a transpose, which is made explicitly since
+** gemm() only multiplies row-major matrices as they are.
+** The updates are those of Neural Net, averaged over the
+** batch.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "nmglobal.h"
+#include "encl_gemm.h"
+#include "encl_vmath.h"
+#include "encl_mlp.h"
+
+#define MLPRATE 0.5             /* Learning rate */
+#define MLPMOMENTUM 0.9         /* Momentum */
+#define MLPEXPMAX 700.0         /* Sigmoid inputs are clamped to this */
+#define MLPSEED 13UL
+
+/*
+** Uniform in [0,1), from a 64-bit xorshift generator.
+*/
+static double mlp_rand(unsigned long *state)
+{
+*state^=*state<<13;
+*state^=*state>>7;
+*state^=*state<<17;
+return((double)(*state>>11)*(1.0/9007199254740992.0));
+}
+
+/**************
+** transpose **
+***************
+** dst (cols x rows) = src' (rows x cols).
+*/
+static void transpose(const double *src, long rows, long cols, double *dst)
+{
+long i, j;
+
+for(i=0;i<rows;i++)
+        for(j=0;j<cols;j++)
+                dst[j*rows+i]=src[i*cols+j];
+}
+
+/************
+** sigmoid **
+*************
+** z[i] = 1/(1+exp(-z[i])), the exponentials n at a time.
+*/
+static void sigmoid(int level, double *z, long n)
+{
+long i;
+
+for(i=0;i<n;i++)
+{       z[i]=-z[i];
+        if(z[i]>MLPEXPMAX) z[i]=MLPEXPMAX;
+        if(z[i]<-MLPEXPMAX) z[i]=-MLPEXPMAX;
+}
+vm_exp(level,z,z,n);
+for(i=0;i<n;i++)
+        z[i]=1.0/(1.0+z[i]);
+}
+
+/**************
+** mlp_setup **
+***************
+** See encl_mlp.h.
+*/
+int mlp_setup(MLPNet *net, long in, long hid, long out,
+        long npats, long batch)
+{
+double *p, *teacher, sum;
+unsigned long state;
+long i, j, k;
+size_t total;
+
+memset(net,0,sizeof(*net));
+if(in<1 || hid<1 || out<1 || npats<1 || batch<1)
+        return(-1);
+if(batch>npats)
+        batch=npats;
+total=(size_t)npats*(in+out)+           /* x, t */
+        2*(size_t)(in*hid+hid*out)+     /* w1, w2, v1, v2 */
+        (size_t)batch*(2*hid+2*out)+    /* h, y, e1, e2 */
+        (size_t)in*batch+(size_t)hid*batch+(size_t)out*hid;
+p=(double *)malloc(total*sizeof(double));
+teacher=(double *)malloc((size_t)in*out*sizeof(double));
+if(p==NULL || teacher==NULL)
+{       free(p);
+        free(teacher);
+        return(-1);
+}
+net->in=in;
+net->hid=hid;
+net->out=out;
+net->npats=npats;
+net->batch=batch;
+net->block=p;
+net->x=p;       p+=npats*in;
+net->t=p;       p+=npats*out;
+net->w1=p;      p+=in*hid;
+net->w2=p;      p+=hid*out;
+net->v1=p;      p+=in*hid;
+net->v2=p;      p+=hid*out;
+net->h=p;       p+=batch*hid;
+net->y=p;       p+=batch*out;
+net->e1=p;      p+=batch*hid;
+net->e2=p;      p+=batch*out;
+net->xt=p;      p+=in*batch;
+net->ht=p;      p+=hid*batch;
+net->w2t=p;
+
+state=MLPSEED;
+for(i=0;i<in*out;i++)
+        teacher[i]=mlp_rand(&state)-0.5;
+for(i=0;i<npats*in;i++)
+        net->x[i]=mlp_rand(&state);
+for(i=0;i<npats;i++)
+        for(k=0;k<out;k++)
+        {       sum=0.0;
+                for(j=0;j<in;j++)
+                        sum+=(net->x[i*in+j]-0.5)*teacher[j*out+k];
+                net->t[i*out+k]=sum>0.0 ? 0.9 : 0.1;
+        }
+free(teacher);
+mlp_reset(net);
+return(0);
+}
+
+/*************
+** mlp_free **
+**************
+** See encl_mlp.h.
+*/
+void mlp_free(MLPNet *net)
+{
+free(net->block);
+memset(net,0,sizeof(*net));
+}
+
+/**************
+** mlp_reset **
+***************
+** Weights uniform in +-1/sqrt(fan-in); no momentum yet.
+*/
+void mlp_reset(MLPNet *net)
+{
+unsigned long state;
+double s;
+long i;
+
+state=MLPSEED*7919UL;
+s=2.0/sqrt((double)net->in);
+for(i=0;i<net->in*net->hid;i++)
+        net->w1[i]=(mlp_rand(&state)-0.5)*s;
+s=2.0/sqrt((double)net->hid);
+for(i=0;i<net->hid*net->out;i++)
+        net->w2[i]=(mlp_rand(&state)-0.5)*s;
+memset(net->v1,0,(size_t)net->in*net->hid*sizeof(double));
+memset(net->v2,0,(size_t)net->hid*net->out*sizeof(double));
+}
+
+/****************
+** mlp_forward **
+*****************
+** h and y of the b patterns from x.
+*/
+static void mlp_forward(MLPNet *net, int level, const double *x, long b)
+{
+memset(net->h,0,(size_t)b*net->hid*sizeof(double));
+gemm(level,b,net->hid,net->in,1.0,x,net->in,net->w1,net->hid,
+        net->h,net->hid);
+sigmoid(level,net->h,b*net->hid);
+memset(net->y,0,(size_t)b*net->out*sizeof(double));
+gemm(level,b,net->out,net->hid,1.0,net->h,net->hid,net->w2,net->out,
+        net->y,net->out);
+sigmoid(level,net->y,b*net->out);
+}
+
+/**************
+** mlp_epoch **
+***************
+** See encl_mlp.h.
+*/
+void mlp_epoch(MLPNet *net, int level)
+{
+long in=net->in, hid=net->hid, out=net->out;
+long p0, b, i;
+const double *x, *t;
+double rate;
+
+for(p0=0;p0<net->npats;p0+=net->batch)
+{       b=net->npats-p0<net->batch ? net->npats-p0 : net->batch;
+        x=net->x+p0*in;
+        t=net->t+p0*out;
+        rate=MLPRATE/(double)b;
+
+        mlp_forward(net,level,x,b);
+
+        /*
+        ** Errors of the output layer, then of the hidden one.
+        */
+        for(i=0;i<b*out;i++)
+                net->e2[i]=(t[i]-net->y[i])*net->y[i]*(1.0-net->y[i]);
+        transpose(net->w2,hid,out,net->w2t);
+        memset(net->e1,0,(size_t)b*hid*sizeof(double));
+        gemm(level,b,hid,out,1.0,net->e2,out,net->w2t,hid,net->e1,hid);
+        for(i=0;i<b*hid;i++)
+                net->e1[i]*=net->h[i]*(1.0-net->h[i]);
+
+        /*
+        ** Weight changes, with momentum.
+        */
+        transpose(net->h,b,hid,net->ht);
+        for(i=0;i<hid*out;i++)
+                net->v2[i]*=MLPMOMENTUM;
+        gemm(level,hid,out,b,rate,net->ht,b,net->e2,out,net->v2,out);
+        for(i=0;i<hid*out;i++)
+                net->w2[i]+=net->v2[i];
+
+        transpose(x,b,in,net->xt);
+        for(i=0;i<in*hid;i++)
+                net->v1[i]*=MLPMOMENTUM;
+        gemm(level,in,hid,b,rate,net->xt,b,net->e1,hid,net->v1,hid);
+        for(i=0;i<in*hid;i++)
+                net->w1[i]+=net->v1[i];
+}
+}
+
+/******************
+** mlp_epoch_ref **
+*******************
+** mlp_epoch() with plain loops and the libc exp(), on the
+** weights and changes w1, w2, v1 and v2; h, y, e1 and e2 are
+** room for a batch.
+*/
+static void mlp_epoch_ref(const MLPNet *net, double *w1, double *w2,
+        double *v1, double *v2, double *h, double *y, double *e1,
+        double *e2)
+{
+long in=net->in, hid=net->hid, out=net->out;
+long p0, b, i, j, k;
+const double *x, *t;
+double rate, sum;
+
+for(p0=0;p0<net->npats;p0+=net->batch)
+{       b=net->npats-p0<net->batch ? net->npats-p0 : net->batch;
+        x=net->x+p0*in;
+        t=net->t+p0*out;
+        rate=MLPRATE/(double)b;
+
+        for(i=0;i<b;i++)
+        {       for(j=0;j<hid;j++)
+                {       sum=0.0;
+                        for(k=0;k<in;k++)
+                                sum+=x[i*in+k]*w1[k*hid+j];
+                        h[i*hid+j]=1.0/(1.0+exp(-sum));
+                }
+                for(j=0;j<out;j++)
+                {       sum=0.0;
+                        for(k=0;k<hid;k++)
+                                sum+=h[i*hid+k]*w2[k*out+j];
+                        y[i*out+j]=1.0/(1.0+exp(-sum));
+                        e2[i*out+j]=(t[i*out+j]-y[i*out+j])*
+                                y[i*out+j]*(1.0-y[i*out+j]);
+                }
+                for(j=0;j<hid;j++)
+                {       sum=0.0;
+                        for(k=0;k<out;k++)
+                                sum+=e2[i*out+k]*w2[j*out+k];
+                        e1[i*hid+j]=sum*h[i*hid+j]*(1.0-h[i*hid+j]);
+                }
+        }
+
+        for(j=0;j<hid;j++)
+                for(k=0;k<out;k++)
+                {       sum=0.0;
+                        for(i=0;i<b;i++)
+                                sum+=h[i*hid+j]*e2[i*out+k];
+                        v2[j*out+k]=MLPMOMENTUM*v2[j*out+k]+rate*sum;
+                        w2[j*out+k]+=v2[j*out+k];
+                }
+        for(k=0;k<in;k++)
+                for(j=0;j<hid;j++)
+                {       sum=0.0;
+                        for(i=0;i<b;i++)
+                                sum+=x[i*in+k]*e1[i*hid+j];
+                        v1[k*hid+j]=MLPMOMENTUM*v1[k*hid+j]+rate*sum;
+                        w1[k*hid+j]+=v1[k*hid+j];
+                }
+}
+}
+
+/**************
+** mlp_check **
+***************
+** See encl_mlp.h.  The weights are compared relative to
+** 1 + their size.
+*/
+int mlp_check(MLPNet *net, int level, double tol)
+{
+long in=net->in, hid=net->hid, out=net->out;
+long b, i, j, k, nw1, nw2;
+double *h, *ref, sum;
+int status;
+
+b=net->batch;
+nw1=in*hid;
+nw2=hid*out;
+h=(double *)malloc((size_t)hid*sizeof(double));
+ref=(double *)malloc((2*(size_t)(nw1+nw2)+
+        (size_t)b*(2*hid+2*out))*sizeof(double));
+if(h==NULL || ref==NULL)
+{       free(h);
+        free(ref);
+        return(-1);
+}
+mlp_forward(net,level,net->x,b);
+status=0;
+for(i=0;i<b && status==0;i++)
+{       for(j=0;j<hid;j++)
+        {       sum=0.0;
+                for(k=0;k<in;k++)
+                        sum+=net->x[i*in+k]*net->w1[k*hid+j];
+                h[j]=1.0/(1.0+exp(-sum));
+        }
+        for(j=0;j<out;j++)
+        {       sum=0.0;
+                for(k=0;k<hid;k++)
+                        sum+=h[k]*net->w2[k*out+j];
+                if(fabs(1.0/(1.0+exp(-sum))-net->y[i*out+j])>tol)
+                        status=-1;
+        }
+}
+
+/*
+** One epoch of training, from the same weights and changes.
+*/
+if(status==0)
+{       memcpy(ref,net->w1,(size_t)nw1*sizeof(double));
+        memcpy(ref+nw1,net->w2,(size_t)nw2*sizeof(double));
+        memcpy(ref+nw1+nw2,net->v1,(size_t)nw1*sizeof(double));
+        memcpy(ref+2*nw1+nw2,net->v2,(size_t)nw2*sizeof(double));
+        mlp_epoch_ref(net,ref,ref+nw1,ref+nw1+nw2,ref+2*nw1+nw2,
+                ref+2*(nw1+nw2),ref+2*(nw1+nw2)+b*hid,
+                ref+2*(nw1+nw2)+b*(hid+out),
+                ref+2*(nw1+nw2)+b*(2*hid+out));
+        mlp_epoch(net,level);
+        for(i=0;i<nw1 && status==0;i++)
+                if(fabs(net->w1[i]-ref[i])>tol*(1.0+fabs(ref[i])))
+                        status=-1;
+        for(i=0;i<nw2 && status==0;i++)
+                if(fabs(net->w2[i]-ref[nw1+i])>
+                  tol*(1.0+fabs(ref[nw1+i])))
+                        status=-1;
+}
+free(h);
+free(ref);
+return(status);
+}
@@ -0,0 +1,64 @@
+/*
+** encl_mlp.h
+** Multi-layer perceptron trained in mini-batches, for
+** Neural Net (MLP).
+**
+** One hidden layer of sigmoid units, like the net of Neural
+** Net, but with the sizes given at run time; the forward and
+** back passes of a batch are matrix multiplies (gemm()).
+*/
+
+#ifndef _ENCL_MLP_H_
+#define _ENCL_MLP_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct {
+        long in, hid, out;      /* Layer sizes */
+        long npats;             /* Training patterns */
+        long batch;             /* Patterns per batch */
+        double *block;          /* All of the below, one allocation */
+        double *x, *t;          /* Inputs, targets (npats rows) */
+        double *w1, *w2;        /* Weights, in x hid and hid x out */
+        double *v1, *v2;        /* Last weight changes (momentum) */
+        double *h, *y;          /* Hidden and output layer, a batch */
+        double *e1, *e2;        /* Their errors */
+        double *xt, *ht, *w2t;  /* Transposes */
+} MLPNet;
+
+/*
+** Allocate the net and make up its patterns: random inputs
+** in [0,1), and targets of 0.9 or 0.1 by the sign of a
+** fixed random linear function of them.  Returns 0, or -1
+** if there is no room.
+*/
+extern int mlp_setup(MLPNet *net, long in, long hid, long out,
+        long npats, long batch);
+extern void mlp_free(MLPNet *net);
+
+/*
+** Start over from the same random weights.
+*/
+extern void mlp_reset(MLPNet *net);
+
+/*
+** One pass over all patterns, a batch at a time, with the
+** gemm() and vm_exp() kernels of SIMD_xxx level.
+*/
+extern void mlp_epoch(MLPNet *net, int level);
+
+/*
+** Run the first batch forward, then train one epoch, with
+** gemm() and with plain loops and the libc exp(); returns 0,
+** or -1 if an output or a weight differs by more than tol
+** (or there is no room).  Leaves the net one epoch on.
+*/
+extern int mlp_check(MLPNet *net, int level, double tol);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_MLP_H_ */
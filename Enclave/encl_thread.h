@@ -0,0 +1,39 @@
+/*
+** encl_thread.h
+** Per-thread state of the enclave.
+**
+** Each benchmark keeps its working buffers in the enclave
+** between ECALLs.  So that several App threads can run the
+** same benchmark at once (-threads=N), that state lives in
+** one slot per thread.  encl_thread_bind() picks the slot of
+** the calling thread; a thread that never binds uses slot 0,
+** which is what the single-threaded run (and switchless
+** calls, which can land on any trusted worker) relies on.
+** The numbered buffers of a slot are handles of the buffer
+** registry (encl_buffers.h) bound to it.
+*/
+
+#ifndef _ENCL_THREAD_H_
+#define _ENCL_THREAD_H_
+
+/* Include after nmglobal.h, for MAXTHREADS. */
+
+#include "encl_buffers.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+extern __thread int encl_slot;  /* Slot of the calling thread */
+
+#define enclave_buffer (encl_buffer(encl_slot,0))
+#define enclave_buffer2 (encl_buffer(encl_slot,1))
+#define enclave_buffer3 (encl_buffer(encl_slot,2))
+#define enclave_buffer4 (encl_buffer(encl_slot,3))
+#define enclave_buffer5 (encl_buffer(encl_slot,4))
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_THREAD_H_ */
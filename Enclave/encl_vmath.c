@@ -0,0 +1,203 @@
+/*
+** encl_vmath.c
+** exp, log, sin and cos on arrays of doubles, for AVX2 and
+** AVX-512F.
+**
+** The usual reductions, done without branches so that every
+** lane takes the same path: exp and sincos round x to a
+** multiple of ln2 or pi/2 and evaluate a polynomial on what
+** is left, log splits off the exponent and takes 2 atanh of
+** the mantissa.  The polynomials are the Taylor series of
+** exp and atanh and the minimax ones of fdlibm's sin and
+** cos.  Integers go in and out of the doubles by adding
+** 1.5 * 2**52 (VM_MAGIC), which needs no 64-bit conversion
+** instructions.
+*/
+
+#include <math.h>
+#include <immintrin.h>
+#include "nmglobal.h"
+#include "encl_vmath.h"
+
+#define VM_MAGIC 6755399441055744.0     /* 1.5 * 2**52 */
+#define VM_MANTISSA 0x000fffffffffffffLL
+
+#define VM_LOG2E 1.44269504088896338700e+00
+#define VM_LN2HI 6.93147180369123816490e-01     /* ln2, top 32 bits */
+#define VM_LN2LO 1.90821492927058770002e-10     /* ln2 - VM_LN2HI */
+#define VM_SQRT2 1.41421356237309504880e+00
+
+/* 1/n! */
+#define VM_E3 1.66666666666666666667e-01
+#define VM_E4 4.16666666666666666667e-02
+#define VM_E5 8.33333333333333333333e-03
+#define VM_E6 1.38888888888888888889e-03
+#define VM_E7 1.98412698412698412698e-04
+#define VM_E8 2.48015873015873015873e-05
+#define VM_E9 2.75573192239858906526e-06
+#define VM_E10 2.75573192239858906526e-07
+#define VM_E11 2.50521083854417187751e-08
+#define VM_E12 2.08767569878680989792e-09
+#define VM_E13 1.60590438368216145994e-10
+
+/* 1/n */
+#define VM_L3 (1.0/3.0)
+#define VM_L5 (1.0/5.0)
+#define VM_L7 (1.0/7.0)
+#define VM_L9 (1.0/9.0)
+#define VM_L11 (1.0/11.0)
+#define VM_L13 (1.0/13.0)
+#define VM_L15 (1.0/15.0)
+#define VM_L17 (1.0/17.0)
+#define VM_L19 (1.0/19.0)
+#define VM_L21 (1.0/21.0)
+
+#define VM_TWOOPI 6.36619772367581382433e-01    /* 2/pi */
+#define VM_PIO2_1 1.57079632673412561417e+00    /* pi/2, top 33 bits */
+#define VM_PIO2_2 6.07710050630396597660e-11    /* next 33 bits */
+#define VM_PIO2_3 2.02226624871116645580e-21    /* the rest */
+
+#define VM_S1 -1.66666666666666324348e-01
+#define VM_S2 8.33333333332248946124e-03
+#define VM_S3 -1.98412698298579493134e-04
+#define VM_S4 2.75573137070700676789e-06
+#define VM_S5 -2.50507602534068634195e-08
+#define VM_S6 1.58969099521155010221e-10
+
+#define VM_C1 4.16666666666666019037e-02
+#define VM_C2 -1.38888888888741095749e-03
+#define VM_C3 2.48015872894767294178e-05
+#define VM_C4 -2.75573143513906633035e-07
+#define VM_C5 2.08757232129817482790e-09
+#define VM_C6 -1.13596475577881948265e-11
+
+#define KERNEL_EXP exp_avx2
+#define KERNEL_LOG log_avx2
+#define KERNEL_SINCOS sincos_avx2
+#define TARGET __attribute__((target("avx2")))
+#define VD __m256d
+#define VI __m256i
+#define MASK __m256d
+#define D_LOAD(p) _mm256_loadu_pd(p)
+#define D_STORE(p,v) _mm256_storeu_pd(p,v)
+#define D_SET1(x) _mm256_set1_pd(x)
+#define D_ADD _mm256_add_pd
+#define D_SUB _mm256_sub_pd
+#define D_MUL _mm256_mul_pd
+#define D_DIV _mm256_div_pd
+#define D_ROUND(v) _mm256_round_pd(v,_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC)
+#define D_CMPGT(a,b) _mm256_cmp_pd(a,b,_CMP_GT_OQ)
+#define D_BLEND(m,a,b) _mm256_blendv_pd(a,b,m)
+#define D_AS_I _mm256_castpd_si256
+#define I_AS_D _mm256_castsi256_pd
+#define I_SET1(x) _mm256_set1_epi64x(x)
+#define I_ADD _mm256_add_epi64
+#define I_SUB _mm256_sub_epi64
+#define I_AND _mm256_and_si256
+#define I_OR _mm256_or_si256
+#define I_XOR _mm256_xor_si256
+#define I_SLLI _mm256_slli_epi64
+#define I_SRLI _mm256_srli_epi64
+#define I_ISZERO(v) _mm256_castsi256_pd(_mm256_cmpeq_epi64(v,_mm256_setzero_si256()))
+#include "encl_vmath_kernel.h"
+
+#define KERNEL_EXP exp_avx512
+#define KERNEL_LOG log_avx512
+#define KERNEL_SINCOS sincos_avx512
+#define TARGET __attribute__((target("avx512f")))
+#define VD __m512d
+#define VI __m512i
+#define MASK __mmask8
+#define D_LOAD(p) _mm512_loadu_pd(p)
+#define D_STORE(p,v) _mm512_storeu_pd(p,v)
+#define D_SET1(x) _mm512_set1_pd(x)
+#define D_ADD _mm512_add_pd
+#define D_SUB _mm512_sub_pd
+#define D_MUL _mm512_mul_pd
+#define D_DIV _mm512_div_pd
+#define D_ROUND(v) _mm512_roundscale_pd(v,_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC)
+#define D_CMPGT(a,b) _mm512_cmp_pd_mask(a,b,_CMP_GT_OQ)
+#define D_BLEND(m,a,b) _mm512_mask_blend_pd(m,a,b)
+#define D_AS_I _mm512_castpd_si512
+#define I_AS_D _mm512_castsi512_pd
+#define I_SET1(x) _mm512_set1_epi64(x)
+#define I_ADD _mm512_add_epi64
+#define I_SUB _mm512_sub_epi64
+#define I_AND _mm512_and_si512
+#define I_OR _mm512_or_si512
+#define I_XOR _mm512_xor_si512
+#define I_SLLI _mm512_slli_epi64
+#define I_SRLI _mm512_srli_epi64
+#define I_ISZERO(v) _mm512_testn_epi64_mask(v,v)
+#include "encl_vmath_kernel.h"
+
+/***********
+** vm_exp **
+************
+** See encl_vmath.h.
+*/
+void vm_exp(int level, const double *x, double *y, long n)
+{
+long i;
+
+switch(level)
+{       case SIMD_AVX512:
+                i=exp_avx512(x,y,n);
+                break;
+        case SIMD_AVX2:
+                i=exp_avx2(x,y,n);
+                break;
+        default:
+                i=0;
+}
+for(;i<n;i++)
+        y[i]=exp(x[i]);
+}
+
+/***********
+** vm_log **
+************
+** See encl_vmath.h.
+*/
+void vm_log(int level, const double *x, double *y, long n)
+{
+long i;
+
+switch(level)
+{       case SIMD_AVX512:
+                i=log_avx512(x,y,n);
+                break;
+        case SIMD_AVX2:
+                i=log_avx2(x,y,n);
+                break;
+        default:
+                i=0;
+}
+for(;i<n;i++)
+        y[i]=log(x[i]);
+}
+
+/**************
+** vm_sincos **
+***************
+** See encl_vmath.h.
+*/
+void vm_sincos(int level, const double *x, double *s, double *c, long n)
+{
+long i;
+
+switch(level)
+{       case SIMD_AVX512:
+                i=sincos_avx512(x,s,c,n);
+                break;
+        case SIMD_AVX2:
+                i=sincos_avx2(x,s,c,n);
+                break;
+        default:
+                i=0;
+}
+for(;i<n;i++)
+{       s[i]=sin(x[i]);
+        c[i]=cos(x[i]);
+}
+}
@@ -0,0 +1,41 @@
+/*
+** encl_vmath.h
+** exp, log, sin and cos on arrays of doubles.
+**
+** The trusted libc only has the scalar functions; these do
+** 4 (AVX2) or 8 (AVX-512F) arguments at a time, to within a
+** few units in the last place, as the SIMD_xxx level passed
+** in allows.  At SIMD_SSE2, and for the arguments left over
+** from the last whole vector, the libc functions are called.
+*/
+
+#ifndef _ENCL_VMATH_H_
+#define _ENCL_VMATH_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+** y[i]=exp(x[i]), for results in the normal range
+** (-708 < x < 709).
+*/
+extern void vm_exp(int level, const double *x, double *y, long n);
+
+/*
+** y[i]=log(x[i]), for positive normal x.
+*/
+extern void vm_log(int level, const double *x, double *y, long n);
+
+/*
+** s[i]=sin(x[i]), c[i]=cos(x[i]), for |x| < 1.6e6 (the
+** reduction by pi/2 is exact up to 2**20 quadrants).
+*/
+extern void vm_sincos(int level, const double *x, double *s, double *c,
+        long n);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_VMATH_H_ */
@@ -0,0 +1,180 @@
+/*
+** encl_vmath_kernel.h
+** Bodies of the vector exp, log and sincos.
+**
+** Included by encl_vmath.c once per instruction set, after
+** defining:
+**  KERNEL_EXP, KERNEL_LOG, KERNEL_SINCOS  names of the functions
+**  TARGET          their target attribute
+**  VD, VI, MASK    vector of doubles, of 64-bit integers, and
+**                  the result of a compare
+**  D_LOAD(p), D_STORE(p,v), D_SET1(x)
+**  D_ADD, D_SUB, D_MUL, D_DIV
+**  D_ROUND(v)      round to the nearest integer
+**  D_CMPGT(a,b)    lanes where a > b
+**  D_BLEND(m,a,b)  b in the lanes of m, a elsewhere
+**  D_AS_I, I_AS_D  reinterpret the bits
+**  I_SET1, I_ADD, I_SUB, I_AND, I_OR, I_XOR on 64-bit lanes
+**  I_SLLI(v,n), I_SRLI(v,n)  shift 64-bit lanes
+**  I_ISZERO(v)     lanes that are zero
+** Each function does whole vectors only and returns the #
+** of elements done.
+*/
+
+static TARGET long KERNEL_EXP(const double *x, double *y, long n)
+{
+VD v, k, r, p;
+VI ki;
+long lanes, i;
+
+lanes=sizeof(VD)/sizeof(double);
+for(i=0;i+lanes<=n;i+=lanes)
+{       v=D_LOAD(x+i);
+        /*
+        ** x = k ln2 + r, |r| <= ln2/2; exp(r) by its Taylor
+        ** series, then 2**k added to the exponent.
+        */
+        k=D_ROUND(D_MUL(v,D_SET1(VM_LOG2E)));
+        r=D_SUB(D_SUB(v,D_MUL(k,D_SET1(VM_LN2HI))),
+                D_MUL(k,D_SET1(VM_LN2LO)));
+        p=D_SET1(VM_E13);
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E12));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E11));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E10));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E9));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E8));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E7));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E6));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E5));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E4));
+        p=D_ADD(D_MUL(p,r),D_SET1(VM_E3));
+        p=D_ADD(D_MUL(p,r),D_SET1(0.5));
+        p=D_ADD(D_MUL(p,r),D_SET1(1.0));
+        p=D_ADD(D_MUL(p,r),D_SET1(1.0));
+        ki=I_SUB(D_AS_I(D_ADD(k,D_SET1(VM_MAGIC))),D_AS_I(D_SET1(VM_MAGIC)));
+        D_STORE(y+i,I_AS_D(I_ADD(D_AS_I(p),I_SLLI(ki,52))));
+}
+return(i);
+}
+
+static TARGET long KERNEL_LOG(const double *x, double *y, long n)
+{
+VD m, e, f, s, z, p;
+VI bits;
+MASK big;
+long lanes, i;
+
+lanes=sizeof(VD)/sizeof(double);
+for(i=0;i+lanes<=n;i+=lanes)
+{       /*
+        ** x = 2**e m, sqrt(2)/2 <= m < sqrt(2);
+        ** log(m) = 2 atanh(s), s = (m-1)/(m+1).
+        */
+        bits=D_AS_I(D_LOAD(x+i));
+        m=I_AS_D(I_OR(I_AND(bits,I_SET1(VM_MANTISSA)),
+                D_AS_I(D_SET1(1.0))));
+        e=D_SUB(I_AS_D(I_ADD(I_SUB(I_SRLI(bits,52),I_SET1(1023)),
+                D_AS_I(D_SET1(VM_MAGIC)))),D_SET1(VM_MAGIC));
+        big=D_CMPGT(m,D_SET1(VM_SQRT2));
+        m=D_BLEND(big,m,D_MUL(m,D_SET1(0.5)));
+        e=D_BLEND(big,e,D_ADD(e,D_SET1(1.0)));
+        f=D_SUB(m,D_SET1(1.0));
+        s=D_DIV(f,D_ADD(f,D_SET1(2.0)));
+        z=D_MUL(s,s);
+        p=D_SET1(VM_L21);
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L19));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L17));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L15));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L13));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L11));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L9));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L7));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L5));
+        p=D_ADD(D_MUL(p,z),D_SET1(VM_L3));
+        p=D_MUL(D_MUL(p,z),s);
+        /* 2s + 2s p + e ln2, small terms first */
+        p=D_ADD(D_MUL(D_ADD(s,p),D_SET1(2.0)),D_MUL(e,D_SET1(VM_LN2LO)));
+        D_STORE(y+i,D_ADD(p,D_MUL(e,D_SET1(VM_LN2HI))));
+}
+return(i);
+}
+
+static TARGET long KERNEL_SINCOS(const double *x, double *s, double *c,
+        long n)
+{
+VD v, k, r, z, ps, pc, sv, cv;
+VI ki;
+MASK even;
+long lanes, i;
+
+lanes=sizeof(VD)/sizeof(double);
+for(i=0;i+lanes<=n;i+=lanes)
+{       /*
+        ** x = k pi/2 + r, |r| <= pi/4, with pi/2 in three
+        ** parts so that k times each of the first two is
+        ** exact.  Quadrant k mod 4 swaps sin and cos and sets
+        ** their signs.
+        */
+        v=D_LOAD(x+i);
+        k=D_ROUND(D_MUL(v,D_SET1(VM_TWOOPI)));
+        r=D_SUB(v,D_MUL(k,D_SET1(VM_PIO2_1)));
+        r=D_SUB(r,D_MUL(k,D_SET1(VM_PIO2_2)));
+        r=D_SUB(r,D_MUL(k,D_SET1(VM_PIO2_3)));
+        z=D_MUL(r,r);
+        ps=D_SET1(VM_S6);
+        ps=D_ADD(D_MUL(ps,z),D_SET1(VM_S5));
+        ps=D_ADD(D_MUL(ps,z),D_SET1(VM_S4));
+        ps=D_ADD(D_MUL(ps,z),D_SET1(VM_S3));
+        ps=D_ADD(D_MUL(ps,z),D_SET1(VM_S2));
+        ps=D_ADD(D_MUL(ps,z),D_SET1(VM_S1));
+        ps=D_ADD(r,D_MUL(D_MUL(ps,z),r));
+        pc=D_SET1(VM_C6);
+        pc=D_ADD(D_MUL(pc,z),D_SET1(VM_C5));
+        pc=D_ADD(D_MUL(pc,z),D_SET1(VM_C4));
+        pc=D_ADD(D_MUL(pc,z),D_SET1(VM_C3));
+        pc=D_ADD(D_MUL(pc,z),D_SET1(VM_C2));
+        pc=D_ADD(D_MUL(pc,z),D_SET1(VM_C1));
+        pc=D_ADD(D_SUB(D_SET1(1.0),D_MUL(z,D_SET1(0.5))),
+                D_MUL(D_MUL(z,z),pc));
+        /* Low bits of the mantissa hold k + 2**51 */
+        ki=D_AS_I(D_ADD(k,D_SET1(VM_MAGIC)));
+        even=I_ISZERO(I_AND(ki,I_SET1(1)));
+        sv=D_BLEND(even,pc,ps);
+        cv=D_BLEND(even,ps,pc);
+        sv=I_AS_D(I_XOR(D_AS_I(sv),I_SLLI(I_AND(ki,I_SET1(2)),62)));
+        cv=I_AS_D(I_XOR(D_AS_I(cv),
+                I_SLLI(I_AND(I_ADD(ki,I_SET1(1)),I_SET1(2)),62)));
+        D_STORE(s+i,sv);
+        D_STORE(c+i,cv);
+}
+return(i);
+}
+
+#undef KERNEL_EXP
+#undef KERNEL_LOG
+#undef KERNEL_SINCOS
+#undef TARGET
+#undef VD
+#undef VI
+#undef MASK
+#undef D_LOAD
+#undef D_STORE
+#undef D_SET1
+#undef D_ADD
+#undef D_SUB
+#undef D_MUL
+#undef D_DIV
+#undef D_ROUND
+#undef D_CMPGT
+#undef D_BLEND
+#undef D_AS_I
+#undef I_AS_D
+#undef I_SET1
+#undef I_ADD
+#undef I_SUB
+#undef I_AND
+#undef I_OR
+#undef I_XOR
+#undef I_SLLI
+#undef I_SRLI
+#undef I_ISZERO
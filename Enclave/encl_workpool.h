@@ -0,0 +1,61 @@
+/*
+** encl_workpool.h
+** Pool of parked helper threads.
+**
+** Fourier (SIMD) and FP Emulation (SORTED) split each run
+** into units that the caller and its helpers take one at a
+** time off a shared counter.  The helpers enter the enclave
+** once for the whole test and park in workpool_worker()
+** between runs; one that finds no free TCS never shows up,
+** and the others take its units.  A run is open while the
+** generation is odd, as with the Numeric Sort (PAR) pool.
+** The code is in Enclave.cpp, next to that pool.
+*/
+
+#ifndef _ENCL_WORKPOOL_H_
+#define _ENCL_WORKPOOL_H_
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef struct {
+	void (*unit)(int id, unsigned long u);  /* Does unit u for slot id */
+	int id;                         /* Slot of the test */
+	unsigned long nunits;           /* Units of the run */
+	unsigned long next;             /* Next unit to take */
+	unsigned long done;             /* Units done in the run */
+	unsigned long generation;       /* Odd while a run is open */
+	int busy;                       /* Helpers in the run */
+	int stop;                       /* Helpers return */
+} WorkPool;
+
+/*
+** Set up pool for slot id, with unit as the work of a unit.
+** No helper may be in it.
+*/
+extern void workpool_start(WorkPool *pool, int id,
+	void (*unit)(int id, unsigned long u));
+
+/*
+** Body of a helper: join every run until workpool_stop().
+*/
+extern void workpool_worker(WorkPool *pool);
+
+/*
+** Do units 0 to nunits-1 with the helpers that are there,
+** and return once all are done and no helper is left in
+** the run.
+*/
+extern void workpool_run(WorkPool *pool, unsigned long nunits);
+
+/*
+** Send the helpers home.
+*/
+extern void workpool_stop(WorkPool *pool);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_ENCL_WORKPOOL_H_ */
@@ -30,6 +30,8 @@
 #include "emfloat.h"
 
 extern void app_DoEmFloatIteration(ulong arraysize, ulong loops);
+extern int app_DoWideEmFloatIteration(ulong arraysize, ulong loops, int a, int b, int c);
+extern void ErrorExit(void);
 
 /*
 ** Floating-point emulator.
@@ -105,6 +107,25 @@ app_DoEmFloatIteration(arraysize, loops);
 return(StopStopwatch(elapsed));
 }
 
+/***************************
+** DoWideEmFloatIteration **
+****************************
+** The same for FP Emulation (WIDE), on the arrays of WideFPF
+** in the enclave buffers of handles a, b and c.
+*/
+ulong DoWideEmFloatIteration(int a, int b, int c, ulong arraysize,
+        ulong loops)
+{
+ulong elapsed;          /* For the stopwatch */
+
+elapsed=StartStopwatch();
+if(app_DoWideEmFloatIteration(arraysize, loops, a, b, c)!=0)
+{       printf("CPU:Floating Emulation (WIDE) -- no arrays\n");
+        ErrorExit();
+}
+return(StopStopwatch(elapsed));
+}
+
 /***********************
 ** SetInternalFPFZero **
 ************************
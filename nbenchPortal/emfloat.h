@@ -107,6 +107,19 @@ typedef struct
         u16 mantissa[INTERNAL_FPF_PRECISION];
 } InternalFPF;
 
+/*
+** The same number for FP Emulation (WIDE): the mantissa is
+** one 64-bit limb, mantissa[0] of InternalFPF in its top 16
+** bits.
+*/
+typedef struct
+{
+        u8 type;
+        u8 sign;
+        short exp;
+        unsigned long long mant;
+} WideFPF;
+
 /*
 ** PROTOTYPES
 */
@@ -115,6 +128,8 @@ void SetupCPUEmFloatArrays(InternalFPF *abase,
 ulong DoEmFloatIteration(InternalFPF *abase,
         InternalFPF *bbase, InternalFPF *cbase,
         ulong arraysize, ulong loops);
+ulong DoWideEmFloatIteration(int a, int b, int c, ulong arraysize,
+        ulong loops);
 static void SetInternalFPFZero(InternalFPF *dest,
                         uchar sign);
 static void SetInternalFPFInfinity(InternalFPF *dest,
@@ -144,6 +159,16 @@ static void Int32ToInternalFPF(int32 mylong,
 static int InternalFPFToString(char *dest,
                 InternalFPF *src);
 #endif
+void EmFloatSetup(InternalFPF *abase, InternalFPF *bbase, ulong arraysize);
+void EmFloatLoops(InternalFPF *abase, InternalFPF *bbase,
+        InternalFPF *cbase, ulong arraysize, ulong loops);
+
+/*
+** FP Emulation (WIDE), from encl_emfloat_wide.c
+*/
+void WideFPFSetup(WideFPF *abase, WideFPF *bbase, ulong arraysize);
+void WideFPFLoops(WideFPF *abase, WideFPF *bbase, WideFPF *cbase,
+        ulong arraysize, ulong loops);
 
 /*
 ** EXTERNALS
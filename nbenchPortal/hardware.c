@@ -155,18 +155,14 @@ static void readProcCpuInfo (char *model, char *cache) {
 }
 
 
-/*************
-** hardware **
-**************
-** Runs the system command "uname -s -r"
-** Reads /proc/cpuinfo if on a linux system
-** Writes output
+/*******************
+** hardware_info **
+********************
+** Fills in the CPU model, the L2 cache and the OS, as
+** hardware() prints them.  Each buffer must hold BUF_SIZ
+** characters.
 */
-void hardware(const int write_to_file, FILE *global_ofile) {
-  char buffer[BUF_SIZ];
-  char os[BUF_SIZ];
-  char model[BUF_SIZ];
-  char cache[BUF_SIZ];
+void hardware_info(char *model, char *cache, char *os) {
   char os_command[] = "uname -s -r";
 #ifdef NO_UNAME
   os[0] = '\0';
@@ -179,6 +175,58 @@ void hardware(const int write_to_file, FILE *global_ofile) {
     model[0] = '\0';
     cache[0] = '\0';
   }
+}
+
+/******************
+** cpu_identity **
+*******************
+** The CPU model name and microcode revision of the first
+** CPU in /proc/cpuinfo, without the clock and CPU count that
+** hardware_info() adds, so that they stay the same from run
+** to run.  Empty where they are not found.  Each buffer must
+** hold BUF_SIZ characters.
+*/
+void cpu_identity(char *model, char *microcode) {
+  FILE * info;
+  char * cp;
+  char * dest;
+  char buffer[BUF_SIZ];
+
+  model[0] = microcode[0] = '\0';
+  info = fopen("/proc/cpuinfo", "r");
+  if(info == NULL)
+    return;
+  while(NULL != fgets(buffer, BUF_SIZ, info)){
+    if(! strncmp(buffer, "model name", 10)) {
+      dest = model;
+    } else if(! strncmp(buffer, "microcode", 9)) {
+      dest = microcode;
+    } else {
+      continue;
+    }
+    cp = strchr(buffer, ':');
+    if(dest[0] != '\0' || cp == NULL)
+      continue;
+    cp++;
+    while(*cp == ' ' || *cp == '\t')
+      cp++;
+    strcpy(dest, cp);
+    removeNewLine(dest);
+  }
+  fclose(info);
+}
+
+/*************
+** hardware **
+**************
+** Writes what hardware_info() finds
+*/
+void hardware(const int write_to_file, FILE *global_ofile) {
+  char buffer[BUF_SIZ];
+  char os[BUF_SIZ];
+  char model[BUF_SIZ];
+  char cache[BUF_SIZ];
+  hardware_info(model, cache, os);
   sprintf(buffer, "CPU                 : %s\n", model);
   output_string(buffer, write_to_file, global_ofile);
   sprintf(buffer, "L2 Cache            : %s\n", cache);
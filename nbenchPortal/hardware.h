@@ -1,2 +1,6 @@
 extern
 void hardware(const int write_to_file, FILE *global_ofile);
+extern
+void hardware_info(char *model, char *cache, char *os);
+extern
+void cpu_identity(char *model, char *microcode);
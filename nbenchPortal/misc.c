@@ -107,7 +107,7 @@ long randnum(long lngval)
 int32 randnum(int32 lngval)
 {
 	register int32 interm;
-	static int32 randw[2] = { (int32)13 , (int32)117 };
+	static THREADLOCAL int32 randw[2] = { (int32)13 , (int32)117 };
 
 	if (lngval!=(int32)0)
 	{	randw[0]=(int32)13; randw[1]=(int32)117; }
@@ -51,6 +51,7 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <pthread.h>
 #include "nmglobal.h"
 #include "nbench0.h"
 #include "hardware.h"
@@ -75,6 +76,14 @@ double lx_fpindex;      /* Linux floating-point index */
 double intindex;        /* Integer index */
 double fpindex;         /* Floating-point index */
 ulong bnumrun;          /* # of runs */
+size_t arenapeak;       /* Most of an arena a test used */
+int regressions;        /* # of tests slower than the baseline */
+int calibrating;        /* Test self-adjusts this run */
+long cached;            /* Size it starts from, -1 for none */
+char *calibname;        /* Name and final value of that size */
+ulong calibsize;
+
+regressions=0;
 
 #ifdef MAC
         MaxApplZone();
@@ -109,10 +118,28 @@ if(!(lpfn=GetProcAddress(hThlp,"TimerCount")))
 /*
 ** Set global parameters to default.
 */
+#ifdef TIMERSELECT
+global_min_ticks=0;             /* Set once the timer is known */
+global_timer=TIMER_MONORAW;
+#else
 global_min_ticks=MINIMUM_TICKS;
+#endif
 global_min_seconds=MINIMUM_SECONDS;
 global_allstats=0;
 global_custrun=0;
+global_threads=1;
+global_diff=0;
+global_arenakb=0;
+for(i=0;i<MAXTHREADS;i++)
+        arena_handle[i]=-1;
+global_jsonfile[0]='\0';
+global_csvfile[0]='\0';
+global_baseline[0]='\0';
+global_regression=REGRESSIONPCT;
+global_calibcache[0]='\0';
+calib_count=0;
+calib_changed=0;
+calib_hits=0;
 global_align=8;
 write_to_file=0;
 lx_memindex=(double)1.0;        /* set for geometric mean computations */
@@ -131,8 +158,8 @@ mem_array_ents=0;               /* Nothing in mem array */
 //tests_to_do = INTEGER ARRAY FILLED WITH 1
 int passed_num = 0;
 
-if(argc <= 1 || atoi(argv[1]) <= 0 || atoi(argv[1]) > 10){
-    for(i=0;i<NUMTESTS;i++)
+if(argc <= 1 || atoi(argv[1]) <= 0 || atoi(argv[1]) > NUMALLTESTS){
+    for(i=0;i<NUMALLTESTS;i++)
 	tests_to_do[i]=1;
 	
 }else{
@@ -148,29 +175,86 @@ set_request_secs();     /* Set all request_secs fields */
 global_numsortstruct.adjust=0;
 global_numsortstruct.arraysize=NUMARRAYSIZE;
 
+global_numsortparstruct.adjust=0;
+global_numsortparstruct.arraysize=NUMARRAYSIZE;
+global_numsortparstruct.workers=SORTWORKERS;
+global_numsortparstruct.algo=SORT_HEAP;
+
 global_strsortstruct.adjust=0;
 global_strsortstruct.arraysize=STRINGARRAYSIZE;
 
+global_strsortkeystruct.adjust=0;
+global_strsortkeystruct.arraysize=STRINGARRAYSIZE;
+
 global_bitopstruct.adjust=0;
 global_bitopstruct.bitfieldarraysize=BITFARRAYSIZE;
 
+global_bitopecallstruct.adjust=0;
+global_bitopecallstruct.bitfieldarraysize=BITFARRAYSIZE;
+
+global_bitopwordstruct.adjust=0;
+global_bitopwordstruct.bitfieldarraysize=BITFARRAYSIZE;
+global_bitopwordstruct.kernel=BITKERNEL_AVX2;
+
 global_emfloatstruct.adjust=0;
 global_emfloatstruct.arraysize=EMFARRAYSIZE;
 
+global_emfloatwidestruct.adjust=0;
+global_emfloatwidestruct.arraysize=EMFARRAYSIZE;
+
+global_emfloatsortstruct.adjust=0;
+global_emfloatsortstruct.arraysize=EMFARRAYSIZE;
+global_emfloatsortstruct.workers=EMFWORKERS;
+
 global_fourierstruct.adjust=0;
 
+global_fouriersimdstruct.adjust=0;
+global_fouriersimdstruct.workers=FOURWORKERS;
+
 global_assignstruct.adjust=0;
 
 global_ideastruct.adjust=0;
 global_ideastruct.arraysize=IDEAARRAYSIZE;
 
+global_ideasimdstruct.adjust=0;
+global_ideasimdstruct.arraysize=IDEAARRAYSIZE;
+
 global_huffstruct.adjust=0;
 global_huffstruct.arraysize=HUFFARRAYSIZE;
 
+global_hufftablestruct.adjust=0;
+global_hufftablestruct.arraysize=HUFFARRAYSIZE;
+
 global_nnetstruct.adjust=0;
 
+global_mlpstruct.adjust=0;
+global_mlpstruct.in=MLPIN;
+global_mlpstruct.hid=MLPHIDDEN;
+global_mlpstruct.out=MLPOUT;
+global_mlpstruct.npats=MLPPATTERNS;
+global_mlpstruct.batch=MLPBATCH;
+
 global_lustruct.adjust=0;
 
+global_assignjvstruct.n=ASSIGNSIZE;
+
+global_lublockstruct.n=LUSIZE;
+global_lublockstruct.nb=LUBLOCK;
+global_lublockstruct.kernel=LUKERNEL_BLOCKED;
+
+global_transstruct.dotrans=0;
+global_transstruct.samples=TRANSSAMPLES;
+global_transstruct.threads=1;
+
+global_sweepstruct.test=SWEEP_NONE;
+global_sweepstruct.minkb=SWEEPMINKB;
+global_sweepstruct.maxkb=SWEEPMAXKB;
+
+global_streamstruct.dostream=0;
+global_streamstruct.mb=STREAMMB;
+global_streamstruct.minkb=STREAMMINKB;
+global_streamstruct.maxkb=STREAMMAXKB;
+
 /*
 ** For Macintosh -- read the command line.
 */
@@ -188,6 +272,101 @@ if(argc>1)
                         exit(0);
                 }
 
+#ifdef TIMERSELECT
+/*
+** Start the stopwatch that was asked for, falling back to
+** clock() if it is not there.  Unless GLOBALMINTICKS was
+** given, keep the minimum timed span that MINIMUM_TICKS
+** gives with clock().
+*/
+if(SelectStopwatch(global_timer)!=0)
+{       printf("**Timer not available, using clock()\n");
+        global_timer=TIMER_CLOCK;
+        SelectStopwatch(TIMER_CLOCK);
+}
+
+/*
+** clock() is the CPU time of the whole process, which
+** -threads adds up across the threads.
+*/
+if(global_threads>1 && global_timer==TIMER_CLOCK)
+{       printf("**-threads cannot be timed with clock() (TIMER=CLOCK)\n");
+        exit(1);
+}
+if(global_min_ticks==0)
+        global_min_ticks=SecsToTicks((double)MINIMUM_TICKS/
+                (double)CLOCKS_PER_SEC);
+#endif
+
+/*
+** Each thread keeps its state in the enclave slot it binds
+** to; a switchless call runs on whichever trusted worker is
+** free, so it would not find it.
+*/
+if(global_threads>1 && app_switchless)
+{       printf("**-threads cannot be combined with -s\n");
+        exit(1);
+}
+
+/*
+** The differential run needs the native build of the
+** enclave code.
+*/
+if(global_diff && app_native_load()!=0)
+        exit(1);
+
+/*
+** Read the baseline now, so a bad file stops the run before
+** the tests.
+*/
+if(global_baseline[0]!='\0')
+        load_baseline(global_baseline);
+
+/*
+** The SIMD level of the kernels (nmglobal.h).
+*/
+global_simd=simd_level();
+
+/*
+** Bitfield (WORD) falls back to 64-bit words where AVX2
+** is missing.
+*/
+if(global_simd<SIMD_AVX2)
+        global_bitopwordstruct.kernel=BITKERNEL_WORD;
+
+/*
+** The sweep, and LU (BLOCKED), Neural Net (MLP) or Assignment
+** (JV) on a large problem, outgrow the normal enclave heap; switch to the
+** enclave built for the sweep.
+*/
+if(global_sweepstruct.test!=SWEEP_NONE ||
+  (tests_to_do[TF_LUBLOCK] && (double)global_threads*2.0*sizeof(double)*
+  (double)global_lublockstruct.n*(double)global_lublockstruct.n>
+  (double)LUHEAPBYTES) ||
+  (tests_to_do[TF_NNETMLP] && (double)global_threads*mlp_bytes()>
+  (double)MLPHEAPBYTES) ||
+  (tests_to_do[TF_ASSIGNJV] && (double)global_threads*sizeof(long)*
+  (double)global_assignjvstruct.n*(double)global_assignjvstruct.n>
+  (double)ASSIGNHEAPBYTES))
+{       if(app_sweep_enclave()!=0)
+                exit(1);
+        global_sweepstruct.native=global_diff;
+}
+
+/*
+** And the calibration cache, under the key of this machine
+** and build.  The key hashes the enclave that runs the
+** tests, so it is made once the sweep enclave is in.
+*/
+if(global_calibcache[0]!='\0')
+{       if(make_calib_key()==0)
+                load_calibcache(global_calibcache);
+        else
+        {       printf("CALIBCACHE: key of this machine too long, not cached\n");
+                global_calibcache[0]='\0';
+        }
+}
+
 /*
 ** Output header
 */
@@ -198,6 +377,77 @@ if(argc>1)
 //output_string("Index-split by Andrew D. Balsa (11/97)\n");
 //output_string("Linux/Unix* port by Uwe F. Mayer (12/96,11/97)\n");
 output_string("====================Modified version of nbench for Intel SGX====================");
+if(app_switchless)
+{       sprintf(buffer,"\nEnclave transitions: switchless (%u trusted, %u untrusted workers)",
+                app_switchless_tworkers,app_switchless_uworkers);
+        output_string(buffer);
+}
+else
+        output_string("\nEnclave transitions: ECALL/OCALL");
+#ifdef TIMERSELECT
+sprintf(buffer,"\nTimer: %s, resolution %.0f ns",StopwatchName(),
+        StopwatchResolution()*(double)1e9);
+output_string(buffer);
+#endif
+if(global_threads>1)
+{       sprintf(buffer,"\nThreads: %d per test, each with its own enclave state",
+                global_threads);
+        output_string(buffer);
+}
+if(global_diff)
+        output_string("\nDifferential: each test also runs natively (native.so)");
+if(global_arenakb)
+{       sprintf(buffer,"\nBuffers: from an arena of %lu KB per thread",
+                global_arenakb);
+        output_string(buffer);
+}
+if(global_calibcache[0]!='\0')
+{       sprintf(buffer,"\nCalibration: sizes cached in %s (%d entries)",
+                global_calibcache,calib_count);
+        output_string(buffer);
+}
+if(tests_to_do[TF_IDEASIMD])
+{       sprintf(buffer,"\nIDEA (SIMD): %s, %d blocks at a time",
+                simdnames[global_simd],8<<global_simd);
+        output_string(buffer);
+}
+if(tests_to_do[TF_BITOPWORD])
+{       sprintf(buffer,"\nBitfield (WORD): %s",
+                bitkernelnames[global_bitopwordstruct.kernel]);
+        output_string(buffer);
+}
+if(tests_to_do[TF_LUBLOCK])
+{       sprintf(buffer,"\nLU (BLOCKED): %lux%lu, %s",
+                global_lublockstruct.n,global_lublockstruct.n,
+                lukernelnames[global_lublockstruct.kernel]);
+        output_string(buffer);
+        if(global_lublockstruct.kernel==LUKERNEL_BLOCKED)
+        {       sprintf(buffer,", %s multiply",simdnames[global_simd]);
+                output_string(buffer);
+        }
+}
+if(tests_to_do[TF_FOURSIMD])
+{       sprintf(buffer,"\nFourier (SIMD): %s, %d threads in the enclave",
+                simdnames[global_simd],global_fouriersimdstruct.workers);
+        output_string(buffer);
+}
+if(tests_to_do[TF_FPEMUSORT])
+{       sprintf(buffer,"\nFP Emulation (SORTED): %d threads in the enclave",
+                global_emfloatsortstruct.workers);
+        output_string(buffer);
+}
+if(tests_to_do[TF_NNETMLP])
+{       sprintf(buffer,"\nNeural Net (MLP): %lu-%lu-%lu, batches of %lu, %s multiply",
+                global_mlpstruct.in,global_mlpstruct.hid,global_mlpstruct.out,
+                global_mlpstruct.batch,simdnames[global_simd]);
+        output_string(buffer);
+}
+if(tests_to_do[TF_NUMSORTPAR])
+{       sprintf(buffer,"\nNumeric Sort (PAR): %d threads in the enclave, %s",
+                global_numsortparstruct.workers,
+                sortalgonames[global_numsortparstruct.algo]);
+        output_string(buffer);
+}
 #else
 //DOES NOT EXECUTE
 output_string("BBBBBB   YYY   Y  TTTTTTT  EEEEEEE\n");
@@ -258,12 +508,16 @@ output_string("--------------------:------------------:-------------:-----------
 #endif
 
 //NUMTESTS=10
-for(i=0;i<NUMTESTS;i++)
+for(i=0;i<NUMALLTESTS;i++)
 {
 	//EVALUATES TRUE 10 TIMES
         if(tests_to_do[i])
         {       sprintf(buffer,"%s    :",ftestnames[i]);
                                 output_string(buffer);
+                memset(thread_score,0,sizeof(thread_score));
+                test_results[i].done=1;
+                calibrating=calib_apply(i,&cached);
+                arena_open();
 		//output_string("EXECUTES HERE");
 			//DOES NOT EXECUTE                
 			if (0!=bench_with_confidence(i,
@@ -274,6 +528,27 @@ for(i=0;i<NUMTESTS;i++)
 		  output_string("** WARNING: The variation among the individual results is too large.\n");
 		  output_string("                    :");
 		}
+		test_results[i].enclave=last_scores;
+		arenapeak=arena_close();
+		if(calibrating)
+			calib_store(i);
+		/*
+		** Variants have no baseline, hence no index; nor
+		** do the summed scores of several threads.
+		*/
+		if(i>=NUMTESTS || global_threads>1)
+		{
+#ifdef LINUX
+			sprintf(buffer," %15.5g  :  %9s  :  %9s\n",
+				bmean,"--","--");
+#else
+			sprintf(buffer,"  Iterations/sec.: %13.2f\n",
+				bmean);
+#endif
+			output_string(buffer);
+		}
+		else
+		{
 #ifdef LINUX
                 sprintf(buffer," %15.5g  :  %9.2f  :  %9.2f\n",
                         bmean,bmean/bindex[i],bmean/lx_bindex[i]);
@@ -282,10 +557,13 @@ for(i=0;i<NUMTESTS;i++)
                         bmean,bmean/bindex[i]);
 #endif
                 output_string(buffer);
+		}
 		/*
 		** Gather integer or FP indexes
 		*/
-		if((i==4)||(i==8)||(i==9)){
+		if(i>=NUMTESTS || global_threads>1)
+			;
+		else if((i==4)||(i==8)||(i==9)){
 		  /* FP index */
 		  fpindex=fpindex*(bmean/bindex[i]);
 		  /* Linux FP index */
@@ -302,6 +580,24 @@ for(i=0;i<NUMTESTS;i++)
 		    lx_memindex=lx_memindex*(bmean/lx_bindex[i]);
 		}
 
+                /*
+                ** Mean score of each thread over the runs.
+                */
+                if(global_threads>1)
+                {       double tmin, tmax, t;
+                        int j;
+                        tmin=tmax=thread_score[0]/(double)bnumrun;
+                        for(j=1;j<global_threads;j++)
+                        {       t=thread_score[j]/(double)bnumrun;
+                                if(t<tmin) tmin=t;
+                                if(t>tmax) tmax=t;
+                        }
+                        sprintf(buffer,"  %2d threads        : %.5g per thread (min %.5g, max %.5g)\n",
+                                global_threads,bmean/(double)global_threads,
+                                tmin,tmax);
+                        output_string(buffer);
+                }
+
                 if(global_allstats)
                 {
                         sprintf(buffer,"  Absolute standard deviation: %g\n",bstdev);
@@ -315,12 +611,94 @@ for(i=0;i<NUMTESTS;i++)
                         sprintf(buffer,"  Number of runs: %lu\n",bnumrun);
                         output_string(buffer);
                         show_stats(i);
+                        if(global_arenakb)
+                        {       sprintf(buffer,"  Arena peak: %lu of %lu KB\n",
+                                        (ulong)((arenapeak+1023)/1024),
+                                        global_arenakb);
+                                output_string(buffer);
+                        }
+                        if(cached>=0)
+                        {       calib_size(i,&calibname,&calibsize,0);
+                                sprintf(buffer,"  Calibration: %s=%ld from the cache, %s\n",
+                                        calibname,cached,
+                                        calibsize==(ulong)cached ? "held" : "adjusted again");
+                                output_string(buffer);
+                        }
                         sprintf(buffer,"Done with %s\n\n",ftestnames[i]);
                         output_string(buffer);
                 }
+
+                /*
+                ** Differential run: the same test again, natively,
+                ** with the sizes the enclave run settled on.
+                */
+                if(global_diff)
+                {       diff_results[i].enclave=bmean;
+                        diff_results[i].enclstdev=bstdev;
+                        diff_results[i].enclruns=bnumrun;
+                        memset(thread_score,0,sizeof(thread_score));
+                        app_native=1;
+                        arena_open();
+                        bench_with_confidence(i,&bmean,&bstdev,&bnumrun);
+                        arena_close();
+                        app_native=0;
+                        test_results[i].native=last_scores;
+                        diff_results[i].native=bmean;
+                        diff_results[i].natstdev=bstdev;
+                        diff_results[i].natruns=bnumrun;
+                        diff_ratio(&diff_results[i]);
+                        diff_results[i].done=1;
+                        sprintf(buffer,"  native            : %15.5g  :  slowdown %.3f\n",
+                                bmean,diff_results[i].ratio);
+                        output_string(buffer);
+                }
         }
 }//END FOR LOOP
 
+if(global_diff)
+        show_differential();
+
+/*
+** ECALL/OCALL transition microbenchmarks have their own table.
+*/
+if(global_transstruct.dotrans)
+{       DoTransitions();
+        show_transitions();
+}
+
+/*
+** So does the EPC-pressure sweep.
+*/
+if(global_sweepstruct.test!=SWEEP_NONE)
+{       DoSweep();
+        show_sweep();
+}
+
+/*
+** And the streaming IDEA.
+*/
+if(global_streamstruct.dostream)
+{       global_streamstruct.native=global_diff;
+        DoStream();
+        show_stream();
+}
+
+/*
+** Machine-readable results, all written at the end.
+*/
+if(global_jsonfile[0]!='\0')
+        write_json(global_jsonfile);
+if(global_csvfile[0]!='\0')
+        write_csv(global_csvfile);
+if(global_calibcache[0]!='\0' && calib_changed)
+        write_calibcache(global_calibcache);
+
+/*
+** Compare against the baseline; any regression fails the run.
+*/
+if(global_baseline[0]!='\0')
+        regressions=compare_baseline();
+
 output_string("=================================TEST COMPLETED=================================\n");
 
 /* printf("...done...\n"); */
@@ -357,7 +735,7 @@ if(global_custrun==0)
 output_string("* Trademarks are property of their respective holder.\n");
 }
 */
-exit(0);
+exit(regressions>0 ? 2 : 0);
 }
 //END OF MAIN
 
@@ -394,6 +772,22 @@ switch(*argptr++)
 
         case 'V': global_allstats=1; return(0); /* verbose mode */
 
+        case 'S': return(0);    /* Switchless, handled before enclave creation */
+
+        case 'D':                       /* -diff */
+                if(strcmp(argptr,"IFF")!=0)
+                        return(-1);
+                global_diff=1;
+                break;
+
+        case 'T':                       /* -threads=N */
+                if(strncmp(argptr,"HREADS=",7)!=0)
+                        return(-1);
+                global_threads=atoi(argptr+7);
+                if(global_threads<1 || global_threads>MAXTHREADS)
+                        return(-1);
+                break;
+
         case 'C':                       /* Command file name */
                 /*
                 ** First try to open the file for reading.
@@ -420,9 +814,14 @@ return(0);
 */
 void display_help(char *progname)
 {
-        printf("Usage: %s [-v] [-c<FILE>]\n",progname);
+        printf("Usage: %s [-v] [-c<FILE>] [-s[T[,U]]] [-threads=N] [-diff]\n",progname);
         printf(" -v = verbose\n");
         printf(" -c = input parameters thru command file <FILE>\n");
+        printf(" -s = switchless ECALLs/OCALLs with T trusted and U untrusted\n");
+        printf("      worker threads (default 1,1)\n");
+        printf(" -threads=N = run each test on N threads at once (max %d)\n",
+                MAXTHREADS);
+        printf(" -diff = also run each test natively and report the slowdown\n");
         exit(0);
 }
 
@@ -514,7 +913,7 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
 
                 case PF_CUSTOMRUN:      /* CUSTOMRUN */
                         global_custrun=getflag(eptr);
-                        for(i=0;i<NUMTESTS;i++)			//EXIT LOOP//UPDATE
+                        for(i=0;i<NUMALLTESTS;i++)		//EXIT LOOP//UPDATE
                                 tests_to_do[i]=1-global_custrun;//CHANGES VALUES OF tests_to_do
                         break;
 
@@ -526,16 +925,23 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                         global_numsortstruct.numarrays=
                                 (ushort)atoi(eptr);
                         global_numsortstruct.adjust=1;
+                        global_numsortparstruct.numarrays=
+                                global_numsortstruct.numarrays;
+                        global_numsortparstruct.adjust=1;
                         break;
 
                 case PF_NUMASIZE:       /* NUMARRAYSIZE */
                         global_numsortstruct.arraysize=
                                 (ulong)atol(eptr);
+                        global_numsortparstruct.arraysize=
+                                global_numsortstruct.arraysize;
                         break;
 
                 case PF_NUMMINS:        /* NUMMINSECONDS */
                         global_numsortstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_numsortparstruct.request_secs=
+                                global_numsortstruct.request_secs;
                         break;
 
                 case PF_DOSTR:          /* DOSTRINGSORT */
@@ -545,17 +951,24 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_STRASIZE:       /* STRARRAYSIZE */
                         global_strsortstruct.arraysize=
                                 (ulong)atol(eptr);
+                        global_strsortkeystruct.arraysize=
+                                global_strsortstruct.arraysize;
                         break;
 
                 case PF_NUMSTRA:        /* NUMSTRARRAYS */
                         global_strsortstruct.numarrays=
                                 (ushort)atoi(eptr);
                         global_strsortstruct.adjust=1;
+                        global_strsortkeystruct.numarrays=
+                                global_strsortstruct.numarrays;
+                        global_strsortkeystruct.adjust=1;
                         break;
 
                 case PF_STRMINS:        /* STRMINSECONDS */
                         global_strsortstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_strsortkeystruct.request_secs=
+                                global_strsortstruct.request_secs;
                         break;
 
                 case PF_DOBITF: /* DOBITFIELD */
@@ -566,16 +979,30 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                         global_bitopstruct.bitoparraysize=
                                 (ulong)atol(eptr);
                         global_bitopstruct.adjust=1;
+                        global_bitopecallstruct.bitoparraysize=
+                                global_bitopstruct.bitoparraysize;
+                        global_bitopecallstruct.adjust=1;
+                        global_bitopwordstruct.bitoparraysize=
+                                global_bitopstruct.bitoparraysize;
+                        global_bitopwordstruct.adjust=1;
                         break;
 
                 case PF_BITFSIZE:       /* BITFIELDSIZE */
                         global_bitopstruct.bitfieldarraysize=
                                 (ulong)atol(eptr);
+                        global_bitopecallstruct.bitfieldarraysize=
+                                global_bitopstruct.bitfieldarraysize;
+                        global_bitopwordstruct.bitfieldarraysize=
+                                global_bitopstruct.bitfieldarraysize;
                         break;
 
                 case PF_BITMINS:        /* BITMINSECONDS */
                         global_bitopstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_bitopecallstruct.request_secs=
+                                global_bitopstruct.request_secs;
+                        global_bitopwordstruct.request_secs=
+                                global_bitopstruct.request_secs;
                         break;
 
                 case PF_DOEMF:          /* DOEMF */
@@ -585,16 +1012,28 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_EMFASIZE:       /* EMFARRAYSIZE */
                         global_emfloatstruct.arraysize=
                                 (ulong)atol(eptr);
+                        global_emfloatwidestruct.arraysize=
+                                global_emfloatstruct.arraysize;
+                        global_emfloatsortstruct.arraysize=
+                                global_emfloatstruct.arraysize;
                         break;
 
                 case PF_EMFLOOPS:       /* EMFLOOPS */
                         global_emfloatstruct.loops=
                                 (ulong)atol(eptr);
+                        global_emfloatwidestruct.loops=
+                                global_emfloatstruct.loops;
+                        global_emfloatsortstruct.loops=
+                                global_emfloatstruct.loops;
                         break;
 
                 case PF_EMFMINS:        /* EMFMINSECOND */
                         global_emfloatstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_emfloatwidestruct.request_secs=
+                                global_emfloatstruct.request_secs;
+                        global_emfloatsortstruct.request_secs=
+                                global_emfloatstruct.request_secs;
                         break;
 
                 case PF_DOFOUR: /* DOFOUR */
@@ -605,11 +1044,16 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                         global_fourierstruct.arraysize=
                                 (ulong)atol(eptr);
                         global_fourierstruct.adjust=1;
+                        global_fouriersimdstruct.arraysize=
+                                global_fourierstruct.arraysize;
+                        global_fouriersimdstruct.adjust=1;
                         break;
 
                 case PF_FOURMINS:       /* FOURMINSECONDS */
                         global_fourierstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_fouriersimdstruct.request_secs=
+                                global_fourierstruct.request_secs;
                         break;
 
                 case PF_DOASSIGN:       /* DOASSIGN */
@@ -624,6 +1068,8 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_ASSIGNMINS:     /* ASSIGNMINSECONDS */
                         global_assignstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_assignjvstruct.request_secs=
+                                global_assignstruct.request_secs;
                         break;
 
                 case PF_DOIDEA: /* DOIDEA */
@@ -633,16 +1079,22 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_IDEAASIZE:      /* IDEAARRAYSIZE */
                         global_ideastruct.arraysize=
                                 (ulong)atol(eptr);
+                        global_ideasimdstruct.arraysize=
+                                global_ideastruct.arraysize;
                         break;
 
                 case PF_IDEALOOPS:      /* IDEALOOPS */
                         global_ideastruct.loops=
                                 (ulong)atol(eptr);
+                        global_ideasimdstruct.loops=
+                                global_ideastruct.loops;
                         break;
 
                 case PF_IDEAMINS:       /* IDEAMINSECONDS */
                         global_ideastruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_ideasimdstruct.request_secs=
+                                global_ideastruct.request_secs;
                         break;
 
                 case PF_DOHUFF: /* DOHUFF */
@@ -652,17 +1104,24 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_HUFFASIZE:      /* HUFFARRAYSIZE */
                         global_huffstruct.arraysize=
                                 (ulong)atol(eptr);
+                        global_hufftablestruct.arraysize=
+                                global_huffstruct.arraysize;
                         break;
 
                 case PF_HUFFLOOPS:      /* HUFFLOOPS */
                         global_huffstruct.loops=
                                 (ulong)atol(eptr);
                         global_huffstruct.adjust=1;
+                        global_hufftablestruct.loops=
+                                global_huffstruct.loops;
+                        global_hufftablestruct.adjust=1;
                         break;
 
                 case PF_HUFFMINS:       /* HUFFMINSECONDS */
                         global_huffstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_hufftablestruct.request_secs=
+                                global_huffstruct.request_secs;
                         break;
 
                 case PF_DONNET: /* DONNET */
@@ -678,6 +1137,8 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_NNETMINS:       /* NNETMINSECONDS */
                         global_nnetstruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_mlpstruct.request_secs=
+                                global_nnetstruct.request_secs;
                         break;
 
                 case PF_DOLU:           /* DOLU */
@@ -693,11 +1154,216 @@ while(fgets(inbuf,39,cfile)!=(char *)NULL)
                 case PF_LUMINS: /* LUMINSECONDS */
                         global_lustruct.request_secs=
                                 (ulong)atol(eptr);
+                        global_lublockstruct.request_secs=
+                                global_lustruct.request_secs;
                         break;
 
                                 case PF_ALIGN:          /* ALIGN */
                                                 global_align=atoi(eptr);
                                                 break;
+
+                case PF_DOBITFECALL:    /* DOBITFIELDECALL */
+                        tests_to_do[TF_BITOPECALL]=getflag(eptr);
+                        break;
+
+                case PF_DOTRANS:        /* DOTRANSITION */
+                        global_transstruct.dotrans=getflag(eptr);
+                        break;
+
+                case PF_TRANSSAMPLES:   /* TRANSSAMPLES */
+                        global_transstruct.samples=(ulong)atol(eptr);
+                        break;
+
+                case PF_TRANSTHREADS:   /* TRANSTHREADS */
+                        global_transstruct.threads=atoi(eptr);
+                        break;
+
+                case PF_TIMER:          /* TIMER */
+                        global_timer=gettimer(eptr);
+                        if(global_timer<0)
+                        {       printf("**COMMAND FILE ERROR -- TIMER must be CLOCK, MONO or TSC: %s\n",
+                                        eptr);
+                                ErrorExit();
+                        }
+                        break;
+
+                case PF_SWEEP:          /* SWEEP */
+                        global_sweepstruct.test=getsweep(eptr);
+                        break;
+
+                case PF_SWEEPMIN:       /* SWEEPMINKB */
+                        global_sweepstruct.minkb=(ulong)atol(eptr);
+                        break;
+
+                case PF_SWEEPMAX:       /* SWEEPMAXKB */
+                        global_sweepstruct.maxkb=(ulong)atol(eptr);
+                        break;
+
+                case PF_JSONFILE:       /* JSONFILE */
+                        strcpy(global_jsonfile,eptr);
+                        break;
+
+                case PF_CSVFILE:        /* CSVFILE */
+                        strcpy(global_csvfile,eptr);
+                        break;
+
+                case PF_BASELINE:       /* BASELINE */
+                        strcpy(global_baseline,eptr);
+                        break;
+
+                case PF_REGRESSION:     /* REGRESSION */
+                        global_regression=atof(eptr);
+                        break;
+
+                case PF_DOIDEASIMD:     /* DOIDEASIMD */
+                        tests_to_do[TF_IDEASIMD]=getflag(eptr);
+                        break;
+
+                case PF_DOSTREAM:       /* DOSTREAM */
+                        global_streamstruct.dostream=getflag(eptr);
+                        break;
+
+                case PF_STREAMMB:       /* STREAMMB */
+                        global_streamstruct.mb=(ulong)atol(eptr);
+                        break;
+
+                case PF_STREAMMIN:      /* STREAMMINKB */
+                        global_streamstruct.minkb=(ulong)atol(eptr);
+                        break;
+
+                case PF_STREAMMAX:      /* STREAMMAXKB */
+                        global_streamstruct.maxkb=(ulong)atol(eptr);
+                        break;
+
+                case PF_DOHUFFTABLE:    /* DOHUFFTABLE */
+                        tests_to_do[TF_HUFFTABLE]=getflag(eptr);
+                        break;
+
+                case PF_DONUMSORTPAR:   /* DONUMSORTPAR */
+                        tests_to_do[TF_NUMSORTPAR]=getflag(eptr);
+                        break;
+
+                case PF_SORTWORKERS:    /* SORTWORKERS */
+                        global_numsortparstruct.workers=atoi(eptr);
+                        if(global_numsortparstruct.workers<1)
+                                global_numsortparstruct.workers=1;
+                        if(global_numsortparstruct.workers>SORTMAXWORKERS)
+                                global_numsortparstruct.workers=SORTMAXWORKERS;
+                        break;
+
+                case PF_SORTALGO:       /* SORTALGO */
+                        global_numsortparstruct.algo=getsortalgo(eptr);
+                        break;
+
+                case PF_DOSTRKEY:       /* DOSTRINGSORTKEY */
+                        tests_to_do[TF_SSORTKEY]=getflag(eptr);
+                        break;
+
+                case PF_DOBITFWORD:     /* DOBITFIELDWORD */
+                        tests_to_do[TF_BITOPWORD]=getflag(eptr);
+                        break;
+
+                case PF_BITKERNEL:      /* BITKERNEL */
+                        global_bitopwordstruct.kernel=getbitkernel(eptr);
+                        break;
+
+                case PF_DOLUBLOCK:      /* DOLUBLOCKED */
+                        tests_to_do[TF_LUBLOCK]=getflag(eptr);
+                        break;
+
+                case PF_LUSIZE:         /* LUSIZE */
+                        global_lublockstruct.n=(ulong)atol(eptr);
+                        if(global_lublockstruct.n<1)
+                                global_lublockstruct.n=1;
+                        if(global_lublockstruct.n>LUMAXSIZE)
+                                global_lublockstruct.n=LUMAXSIZE;
+                        break;
+
+                case PF_LUBLOCK:        /* LUBLOCK */
+                        global_lublockstruct.nb=(ulong)atol(eptr);
+                        if(global_lublockstruct.nb<1)
+                                global_lublockstruct.nb=1;
+                        break;
+
+                case PF_LUKERNEL:       /* LUKERNEL */
+                        global_lublockstruct.kernel=getlukernel(eptr);
+                        break;
+
+                case PF_DOFOURSIMD:     /* DOFOURIERSIMD */
+                        tests_to_do[TF_FOURSIMD]=getflag(eptr);
+                        break;
+
+                case PF_FOURWORKERS:    /* FOURIERWORKERS */
+                        global_fouriersimdstruct.workers=atoi(eptr);
+                        if(global_fouriersimdstruct.workers<1)
+                                global_fouriersimdstruct.workers=1;
+                        if(global_fouriersimdstruct.workers>FOURMAXWORKERS)
+                                global_fouriersimdstruct.workers=FOURMAXWORKERS;
+                        break;
+
+                case PF_DONNETMLP:      /* DONNETMLP */
+                        tests_to_do[TF_NNETMLP]=getflag(eptr);
+                        break;
+
+                case PF_MLPIN:          /* MLPIN */
+                        global_mlpstruct.in=getmlpsize(eptr);
+                        break;
+
+                case PF_MLPHIDDEN:      /* MLPHIDDEN */
+                        global_mlpstruct.hid=getmlpsize(eptr);
+                        break;
+
+                case PF_MLPOUT:         /* MLPOUT */
+                        global_mlpstruct.out=getmlpsize(eptr);
+                        break;
+
+                case PF_MLPPATS:        /* MLPPATTERNS */
+                        global_mlpstruct.npats=(ulong)atol(eptr);
+                        if(global_mlpstruct.npats<1)
+                                global_mlpstruct.npats=1;
+                        break;
+
+                case PF_MLPBATCH:       /* MLPBATCH */
+                        global_mlpstruct.batch=(ulong)atol(eptr);
+                        if(global_mlpstruct.batch<1)
+                                global_mlpstruct.batch=1;
+                        break;
+
+                case PF_DOASSIGNJV:     /* DOASSIGNJV */
+                        tests_to_do[TF_ASSIGNJV]=getflag(eptr);
+                        break;
+
+                case PF_ASSIGNSIZE:     /* ASSIGNSIZE */
+                        global_assignjvstruct.n=(ulong)atol(eptr);
+                        if(global_assignjvstruct.n<1)
+                                global_assignjvstruct.n=1;
+                        if(global_assignjvstruct.n>ASSIGNMAXSIZE)
+                                global_assignjvstruct.n=ASSIGNMAXSIZE;
+                        break;
+
+                case PF_DOEMFWIDE:      /* DOEMFWIDE */
+                        tests_to_do[TF_FPEMUWIDE]=getflag(eptr);
+                        break;
+
+                case PF_DOEMFSORTED:    /* DOEMFSORTED */
+                        tests_to_do[TF_FPEMUSORT]=getflag(eptr);
+                        break;
+
+                case PF_ARENAKB:        /* ARENAKB */
+                        global_arenakb=(ulong)atol(eptr);
+                        break;
+
+                case PF_CALIBCACHE:     /* CALIBCACHE */
+                        strcpy(global_calibcache,eptr);
+                        break;
+
+                case PF_EMFWORKERS:     /* EMFWORKERS */
+                        global_emfloatsortstruct.workers=atoi(eptr);
+                        if(global_emfloatsortstruct.workers<1)
+                                global_emfloatsortstruct.workers=1;
+                        if(global_emfloatsortstruct.workers>EMFMAXWORKERS)
+                                global_emfloatsortstruct.workers=EMFMAXWORKERS;
+                        break;
         }
 skipswitch:
         continue;
@@ -717,49 +1383,187 @@ static int getflag(char *cptr)
 return(0);
 }
 
-/***************
-** strtoupper **
-****************
-** Convert's a string to upper case.  The string is presumed
-** to consist only of alphabetic characters, and to be terminated
-** with a null.
+/*************
+** gettimer **
+**************
+** Map CLOCK, MONO or TSC to a TIMER_xxx; -1 for anything
+** else.
 */
-static void strtoupper(char *s)
+static int gettimer(char *cptr)
 {
+        strtoupper(cptr);
+        if(strcmp(cptr,"CLOCK")==0) return(TIMER_CLOCK);
+        if(strcmp(cptr,"MONO")==0) return(TIMER_MONORAW);
+        if(strcmp(cptr,"TSC")==0) return(TIMER_TSC);
+return(-1);
+}
 
-do {
-/*
-** Oddly enough, the following line did not work under THINK C.
-** So, I modified it....hmmmm. --RG
-        *s++=(char)toupper((int)*s);
+/*************
+** getsweep **
+**************
+** Return the test named by cptr for SWEEP=:
+** NUMSORT, EMF, IDEA or HUFFMAN (the first letter will do);
+** anything else turns the sweep off.
 */
-        *s=(char)toupper((int)*s);
-        s++;
-} while(*s!=(char)'\0');
-return;
+static int getsweep(char *cptr)
+{
+        switch(toupper((int)*cptr))
+        {       case 'N': return(SWEEP_NUMSORT);
+                case 'E': return(SWEEP_EMF);
+                case 'I': return(SWEEP_IDEA);
+                case 'H': return(SWEEP_HUFF);
+        }
+return(SWEEP_NONE);
 }
 
-/*********************
-** set_request_secs **
-**********************
-** Set everyone's "request_secs" entry to whatever
-** value is in global_min_secs.  This is done
-** at the beginning, and possibly later if the
-** user redefines global_min_secs in the command file.
+/****************
+** getsortalgo **
+*****************
+** SORT_xxx of a SORTALGO= value: RADIX, else the heapsort.
 */
-static void set_request_secs(void)
+static int getsortalgo(char *cptr)
 {
+if(toupper((int)*cptr)=='R')
+        return(SORT_RADIX);
+return(SORT_HEAP);
+}
 
-global_numsortstruct.request_secs=global_min_seconds;
-global_strsortstruct.request_secs=global_min_seconds;
-global_bitopstruct.request_secs=global_min_seconds;
-global_emfloatstruct.request_secs=global_min_seconds;
-global_fourierstruct.request_secs=global_min_seconds;
-global_assignstruct.request_secs=global_min_seconds;
-global_ideastruct.request_secs=global_min_seconds;
-global_huffstruct.request_secs=global_min_seconds;
-global_nnetstruct.request_secs=global_min_seconds;
-global_lustruct.request_secs=global_min_seconds;
+/*****************
+** getbitkernel **
+******************
+** BITKERNEL_xxx of a BITKERNEL= value: WORD, else AVX2.
+** AVX2 is dropped later if the CPU lacks it.
+*/
+static int getbitkernel(char *cptr)
+{
+if(toupper((int)*cptr)=='W')
+        return(BITKERNEL_WORD);
+return(BITKERNEL_AVX2);
+}
+
+/****************
+** getlukernel **
+*****************
+** LUKERNEL_xxx of a LUKERNEL= value: CLASSIC, else BLOCKED.
+*/
+static int getlukernel(char *cptr)
+{
+if(toupper((int)*cptr)=='C')
+        return(LUKERNEL_CLASSIC);
+return(LUKERNEL_BLOCKED);
+}
+
+/****************
+** getmlpsize **
+*****************
+** A layer size of Neural Net (MLP), within 1..MLPMAXSIZE.
+*/
+static ulong getmlpsize(char *cptr)
+{
+long n;
+
+n=atol(cptr);
+if(n<1)
+        return(1);
+if(n>MLPMAXSIZE)
+        return(MLPMAXSIZE);
+return((ulong)n);
+}
+
+/***************
+** mlp_bytes **
+****************
+** Enclave heap taken by the net of Neural Net (MLP): the
+** patterns, the weights and their last changes, and the
+** layers of a batch, with the transposes.
+*/
+static double mlp_bytes(void)
+{
+double in, hid, out;
+
+in=(double)global_mlpstruct.in;
+hid=(double)global_mlpstruct.hid;
+out=(double)global_mlpstruct.out;
+return((double)sizeof(double)*
+        ((double)global_mlpstruct.npats*(in+out)+
+        (double)2.0*hid*(in+out)+hid*out+in*out+
+        (double)global_mlpstruct.batch*(in+(double)3.0*hid+(double)2.0*out)));
+}
+
+/***************
+** simd_level **
+****************
+** The widest instruction set the vectorized IDEA can use,
+** as a SIMD_xxx constant.  __builtin_cpu_supports() checks
+** CPUID and that the OS saves the wider registers.
+*/
+static int simd_level(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+__builtin_cpu_init();
+if(__builtin_cpu_supports("avx512bw"))
+        return(SIMD_AVX512);
+if(__builtin_cpu_supports("avx2"))
+        return(SIMD_AVX2);
+#endif
+return(SIMD_SSE2);
+}
+
+/***************
+** strtoupper **
+****************
+** Convert's a string to upper case.  The string is presumed
+** to consist only of alphabetic characters, and to be terminated
+** with a null.
+*/
+static void strtoupper(char *s)
+{
+
+do {
+/*
+** Oddly enough, the following line did not work under THINK C.
+** So, I modified it....hmmmm. --RG
+        *s++=(char)toupper((int)*s);
+*/
+        *s=(char)toupper((int)*s);
+        s++;
+} while(*s!=(char)'\0');
+return;
+}
+
+/*********************
+** set_request_secs **
+**********************
+** Set everyone's "request_secs" entry to whatever
+** value is in global_min_secs.  This is done
+** at the beginning, and possibly later if the
+** user redefines global_min_secs in the command file.
+*/
+static void set_request_secs(void)
+{
+
+global_numsortstruct.request_secs=global_min_seconds;
+global_strsortstruct.request_secs=global_min_seconds;
+global_bitopstruct.request_secs=global_min_seconds;
+global_emfloatstruct.request_secs=global_min_seconds;
+global_fourierstruct.request_secs=global_min_seconds;
+global_assignstruct.request_secs=global_min_seconds;
+global_ideastruct.request_secs=global_min_seconds;
+global_huffstruct.request_secs=global_min_seconds;
+global_nnetstruct.request_secs=global_min_seconds;
+global_lustruct.request_secs=global_min_seconds;
+global_bitopecallstruct.request_secs=global_min_seconds;
+global_ideasimdstruct.request_secs=global_min_seconds;
+global_hufftablestruct.request_secs=global_min_seconds;
+global_numsortparstruct.request_secs=global_min_seconds;
+global_strsortkeystruct.request_secs=global_min_seconds;
+global_bitopwordstruct.request_secs=global_min_seconds;
+global_lublockstruct.request_secs=global_min_seconds;
+global_fouriersimdstruct.request_secs=global_min_seconds;
+global_mlpstruct.request_secs=global_min_seconds;
+global_assignjvstruct.request_secs=global_min_seconds;
+global_emfloatwidestruct.request_secs=global_min_seconds;
+global_emfloatsortstruct.request_secs=global_min_seconds;
 
 return;
 }
@@ -797,8 +1601,7 @@ int i;                          /* Index */
 ** Get first 5 scores.  Then begin confidence testing.
 */
 for (i=0;i<5;i++)
-{       (*funcpointer[fid])();
-        myscores[i]=getscore(fid);
+{       myscores[i]=run_test(fid);
 #ifdef DEBUG
 	printf("score # %d = %g\n", i, myscores[i]);
 #endif
@@ -853,18 +1656,44 @@ while(1)
 #endif
 	/* We now simply add a new test run and hope that the runs
            finally stabilize, Uwe F. Mayer */
-	if(*numtries==30) return(-1);
-	(*funcpointer[fid])();
-	myscores[*numtries]=getscore(fid);
+	if(*numtries==30)
+	{       keep_scores(myscores,(int)*numtries,c_half_interval,
+			*mean,*stdev,1);
+		return(-1);
+	}
+	myscores[*numtries]=run_test(fid);
 #ifdef DEBUG
 	printf("score # %ld = %g\n", *numtries, myscores[*numtries]);
 #endif
 	*numtries+=1;
 }
 
+keep_scores(myscores,(int)*numtries,c_half_interval,*mean,*stdev,0);
 return(0);
 }
 
+/****************
+** keep_scores **
+*****************
+** Leave the scores of the last bench_with_confidence()
+** call in last_scores, for the JSON and CSV files.
+*/
+static void keep_scores(double scores[], int num_scores,
+        double c_half_interval, double mean, double stdev,
+        int uncertain)
+{
+int i;
+
+last_scores.numscores=num_scores;
+for(i=0;i<num_scores && i<MAXSCORES;i++)
+        last_scores.scores[i]=scores[i];
+last_scores.mean=mean;
+last_scores.stdev=stdev;
+last_scores.halfint=c_half_interval;
+last_scores.uncertain=uncertain;
+return;
+}
+
 #ifdef OLDCODE
 /* this procecdure is no longer needed, Uwe F. Mayer */
   /********************
@@ -921,6 +1750,16 @@ return(0);
   }
 #endif
 
+/* Here is a list of the student-t distribution up to 29 degrees of
+   freedom. The value at 0 is bogus, as there is no value for zero
+   degrees of freedom. */
+static double student_t[30]={0.0 , 12.706 , 4.303 , 3.182 , 2.776 , 2.571 ,
+                             2.447 , 2.365 , 2.306 , 2.262 , 2.228 ,
+                             2.201 , 2.179 , 2.160 , 2.145 , 2.131 ,
+                             2.120 , 2.110 , 2.101 , 2.093 , 2.086 ,
+                             2.080 , 2.074 , 2.069 , 2.064 , 2.060 ,
+		             2.056 , 2.052 , 2.048 , 2.045 };
+
 /********************
 ** calc_confidence **
 *********************
@@ -937,15 +1776,6 @@ static int calc_confidence(double scores[], /* Array of scores */
                 double *smean,              /* Standard mean */
                 double *sdev)               /* Sample stand dev */
 {
-/* Here is a list of the student-t distribution up to 29 degrees of
-   freedom. The value at 0 is bogus, as there is no value for zero
-   degrees of freedom. */
-double student_t[30]={0.0 , 12.706 , 4.303 , 3.182 , 2.776 , 2.571 ,
-                             2.447 , 2.365 , 2.306 , 2.262 , 2.228 ,
-                             2.201 , 2.179 , 2.160 , 2.145 , 2.131 ,
-                             2.120 , 2.110 , 2.101 , 2.093 , 2.086 ,
-                             2.080 , 2.074 , 2.069 , 2.064 , 2.060 ,
-		             2.056 , 2.052 , 2.048 , 2.045 };
 int i;          /* Index */
 if ((num_scores<2) || (num_scores>30)) {
   output_string("Internal error: calc_confidence called with an illegal number of scores\n");
@@ -1012,10 +1842,302 @@ switch(fid)
                 return(global_nnetstruct.iterspersec);
         case TF_LU:
                 return(global_lustruct.iterspersec);
+        case TF_BITOPECALL:
+                return(global_bitopecallstruct.bitopspersec);
+        case TF_IDEASIMD:
+                return(global_ideasimdstruct.iterspersec);
+        case TF_HUFFTABLE:
+                return(global_hufftablestruct.iterspersec);
+        case TF_NUMSORTPAR:
+                return(global_numsortparstruct.sortspersec);
+        case TF_SSORTKEY:
+                return(global_strsortkeystruct.sortspersec);
+        case TF_BITOPWORD:
+                return(global_bitopwordstruct.bitopspersec);
+        case TF_LUBLOCK:
+                return(global_lublockstruct.iterspersec);
+        case TF_FOURSIMD:
+                return(global_fouriersimdstruct.fflops);
+        case TF_NNETMLP:
+                return(global_mlpstruct.patspersec);
+        case TF_ASSIGNJV:
+                return(global_assignjvstruct.iterspersec);
+        case TF_FPEMUWIDE:
+                return(global_emfloatwidestruct.emflops);
+        case TF_FPEMUSORT:
+                return(global_emfloatsortstruct.emflops);
 }
 return((double)0.0);
 }
 
+/**************
+** getstruct **
+***************
+** Map a benchmark to the calling thread's controlling data
+** structure, and give its size.  NOTE: The cases must match
+** the "TF_xxx" constants.
+*/
+static void *getstruct(int fid, size_t *size)
+{
+switch(fid)
+{
+        case TF_NUMSORT:
+                *size=sizeof(SortStruct);
+                return(&global_numsortstruct);
+        case TF_SSORT:
+                *size=sizeof(SortStruct);
+                return(&global_strsortstruct);
+        case TF_BITOP:
+                *size=sizeof(BitOpStruct);
+                return(&global_bitopstruct);
+        case TF_FPEMU:
+                *size=sizeof(EmFloatStruct);
+                return(&global_emfloatstruct);
+        case TF_FFPU:
+                *size=sizeof(FourierStruct);
+                return(&global_fourierstruct);
+        case TF_ASSIGN:
+                *size=sizeof(AssignStruct);
+                return(&global_assignstruct);
+        case TF_IDEA:
+                *size=sizeof(IDEAStruct);
+                return(&global_ideastruct);
+        case TF_HUFF:
+                *size=sizeof(HuffStruct);
+                return(&global_huffstruct);
+        case TF_NNET:
+                *size=sizeof(NNetStruct);
+                return(&global_nnetstruct);
+        case TF_LU:
+                *size=sizeof(LUStruct);
+                return(&global_lustruct);
+        case TF_BITOPECALL:
+                *size=sizeof(BitOpStruct);
+                return(&global_bitopecallstruct);
+        case TF_IDEASIMD:
+                *size=sizeof(IDEAStruct);
+                return(&global_ideasimdstruct);
+        case TF_HUFFTABLE:
+                *size=sizeof(HuffStruct);
+                return(&global_hufftablestruct);
+        case TF_NUMSORTPAR:
+                *size=sizeof(SortStruct);
+                return(&global_numsortparstruct);
+        case TF_SSORTKEY:
+                *size=sizeof(SortStruct);
+                return(&global_strsortkeystruct);
+        case TF_BITOPWORD:
+                *size=sizeof(BitOpStruct);
+                return(&global_bitopwordstruct);
+        case TF_LUBLOCK:
+                *size=sizeof(LUBlockStruct);
+                return(&global_lublockstruct);
+        case TF_FOURSIMD:
+                *size=sizeof(FourierStruct);
+                return(&global_fouriersimdstruct);
+        case TF_NNETMLP:
+                *size=sizeof(MLPStruct);
+                return(&global_mlpstruct);
+        case TF_ASSIGNJV:
+                *size=sizeof(AssignJVStruct);
+                return(&global_assignjvstruct);
+        case TF_FPEMUWIDE:
+                *size=sizeof(EmFloatStruct);
+                return(&global_emfloatwidestruct);
+        case TF_FPEMUSORT:
+                *size=sizeof(EmFloatStruct);
+                return(&global_emfloatsortstruct);
+}
+*size=0;
+return(NULL);
+}
+
+/**************
+** run_test **
+***************
+** Run a benchmark once and return its score.  With
+** -threads=N it runs on N threads at once: the main thread
+** and N-1 workers, each with its own test structure and
+** enclave state.  The score is then the sum over the
+** threads, and each thread's score is added to
+** thread_score[].
+*/
+static double run_test(int fid)
+{
+TestThread jobs[MAXTHREADS];    /* One per thread */
+pthread_t tids[MAXTHREADS];
+void *src;                      /* Main thread's structure */
+void *config;                   /* Copy given to the workers */
+size_t size;
+double total;                   /* Sum of the scores */
+int i;
+
+arena_test=fid;
+if(global_threads<=1)
+{       arena_enter(0);
+        (*funcpointer[fid])();
+        return(getscore(fid));
+}
+
+/*
+** Workers start from a copy of the main thread's structure,
+** so after the main thread has adjusted the test (first
+** run) they all use the same sizes.
+*/
+src=getstruct(fid,&size);
+config=malloc(size);
+if(config==NULL)
+{       printf("**-threads: out of memory\n");
+        ErrorExit();
+}
+memcpy(config,src,size);
+
+pthread_barrier_init(&thread_barrier,NULL,(unsigned)global_threads);
+for(i=1;i<global_threads;i++)
+{       jobs[i].fid=fid;
+        jobs[i].slot=i;
+        jobs[i].config=config;
+        jobs[i].size=size;
+        if(pthread_create(&tids[i],NULL,test_thread,&jobs[i])!=0)
+        {       printf("**-threads: cannot start thread %d\n",i);
+                ErrorExit();
+        }
+}
+arena_enter(0);
+pthread_barrier_wait(&thread_barrier);
+(*funcpointer[fid])();
+jobs[0].score=getscore(fid);
+for(i=1;i<global_threads;i++)
+        pthread_join(tids[i],NULL);
+pthread_barrier_destroy(&thread_barrier);
+free(config);
+
+total=(double)0.0;
+for(i=0;i<global_threads;i++)
+{       thread_score[i]+=jobs[i].score;
+        total+=jobs[i].score;
+}
+return(total);
+}
+
+/****************
+** test_thread **
+*****************
+** Body of one -threads worker.
+*/
+static void *test_thread(void *arg)
+{
+TestThread *job;
+size_t size;
+
+job=(TestThread *)arg;
+if(app_thread_bind(job->slot)!=0)
+{       printf("**-threads: no enclave TCS for thread %d\n",job->slot);
+        ErrorExit();
+}
+memcpy(getstruct(job->fid,&size),job->config,job->size);
+arena_enter(job->slot);
+
+pthread_barrier_wait(&thread_barrier);
+(*funcpointer[job->fid])();
+job->score=getscore(job->fid);
+return(NULL);
+}
+
+/****************
+** arena_open **
+*****************
+** With ARENAKB, set aside an arena for each thread of the
+** test about to run (in the enclave, or natively with
+** app_native).  They are sized once here, which is outside
+** any timing.
+*/
+static void arena_open(void)
+{
+int i;
+
+for(i=0;i<MAXTHREADS;i++)
+        arena_handle[i]=-1;
+if(global_arenakb==0)
+        return;
+for(i=0;i<global_threads;i++)
+{       arena_handle[i]=app_arena_create((size_t)global_arenakb*1024);
+        if(arena_handle[i]<0)
+        {       printf("**ARENAKB: cannot set up an arena of %lu KB\n",
+                        global_arenakb);
+                ErrorExit();
+        }
+}
+}
+
+/*****************
+** arena_enter **
+******************
+** Before each run, on the thread of slot: take its buffers
+** from its arena, emptied.  A reset is O(1), so whatever a
+** run leaves behind costs the next nothing.
+*/
+static void arena_enter(int slot)
+{
+if(arena_handle[slot]<0)
+        return;
+if(app_arena_use(arena_handle[slot])!=0 ||
+  app_arena_reset(arena_handle[slot])!=0)
+{       printf("**ARENAKB: cannot use the arena of thread %d\n",slot);
+        ErrorExit();
+}
+}
+
+/*****************
+** arena_close **
+******************
+** Give the arenas back; returns the most any of them had in
+** use, to size the enclave heap by.  The main thread goes
+** back to malloc() for its buffers, and the others drop
+** theirs with the arena.
+*/
+static size_t arena_close(void)
+{
+size_t peak, p;
+int i;
+
+peak=0;
+if(arena_handle[0]>=0)
+        app_arena_use(-1);
+for(i=0;i<MAXTHREADS;i++)
+        if(arena_handle[i]>=0)
+        {       p=app_arena_peak(arena_handle[i]);
+                if(p>peak)
+                        peak=p;
+                app_arena_destroy(arena_handle[i]);
+                arena_handle[i]=-1;
+        }
+return(peak);
+}
+
+/*****************
+** alloc_failed **
+******************
+** The App bridges call this when the enclave has no room
+** for a buffer of the test being run: with ARENAKB, the
+** arena is too small for it.
+*/
+void alloc_failed(void)
+{
+char *name;
+int n;
+
+name=ftestnames[arena_test];
+n=(int)strlen(name);
+while(n>0 && name[n-1]==' ')
+        n--;
+if(global_arenakb)
+        printf("\n**ARENAKB too small for %.*s\n",n,name);
+else
+        printf("\n**%.*s: no room in the enclave for its buffers\n",n,name);
+ErrorExit();
+}
+
 /******************
 ** output_string **
 *******************
@@ -1122,6 +2244,137 @@ switch(bid)
                         global_lustruct.numarrays);
                 output_string(buffer);
                 break;
+
+        case TF_BITOPECALL:     /* Bitmap operation, ECALL per run */
+                sprintf(buffer,"  Operations array size: %ld\n",
+                        global_bitopecallstruct.bitoparraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Bitfield array size: %ld\n",
+                        global_bitopecallstruct.bitfieldarraysize);
+                output_string(buffer);
+                break;
+
+        case TF_IDEASIMD:       /* IDEA, vectorized */
+                sprintf(buffer,"  Array size: %lu\n",
+                        global_ideasimdstruct.arraysize);
+                output_string(buffer);
+                sprintf(buffer," Number of loops: %lu\n",
+                        global_ideasimdstruct.loops);
+                output_string(buffer);
+                sprintf(buffer,"  Kernel: %s\n",simdnames[global_simd]);
+                output_string(buffer);
+                break;
+
+        case TF_HUFFTABLE:      /* Huffman, canonical coder */
+                sprintf(buffer,"  Array size: %lu\n",
+                        global_hufftablestruct.arraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Number of loops: %lu\n",
+                        global_hufftablestruct.loops);
+                output_string(buffer);
+                break;
+
+        case TF_NUMSORTPAR:     /* Numeric sort, sort pool */
+                sprintf(buffer,"  Number of arrays: %d\n",
+                        global_numsortparstruct.numarrays);
+                output_string(buffer);
+                sprintf(buffer,"  Array size: %ld\n",
+                        global_numsortparstruct.arraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Threads: %d, %s\n",
+                        global_numsortparstruct.workers,
+                        sortalgonames[global_numsortparstruct.algo]);
+                output_string(buffer);
+                break;
+
+        case TF_SSORTKEY:       /* String sort, prefix keys */
+                sprintf(buffer,"  Number of arrays: %d\n",
+                        global_strsortkeystruct.numarrays);
+                output_string(buffer);
+                sprintf(buffer,"  Array size: %ld\n",
+                        global_strsortkeystruct.arraysize);
+                output_string(buffer);
+                break;
+
+        case TF_BITOPWORD:      /* Bitmap operation, word at a time */
+                sprintf(buffer,"  Operations array size: %ld\n",
+                        global_bitopwordstruct.bitoparraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Bitfield array size: %ld\n",
+                        global_bitopwordstruct.bitfieldarraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Kernel: %s\n",
+                        bitkernelnames[global_bitopwordstruct.kernel]);
+                output_string(buffer);
+                /* Every bit op touches one bit of the map */
+                sprintf(buffer,"  Bitmap bandwidth: %.1f MB/s\n",
+                        global_bitopwordstruct.bitopspersec/(double)8e6);
+                output_string(buffer);
+                break;
+
+        case TF_LUBLOCK:        /* LU, blocked */
+                sprintf(buffer,"  Matrix: %lux%lu, blocks of %lu columns\n",
+                        global_lublockstruct.n,global_lublockstruct.n,
+                        global_lublockstruct.nb);
+                output_string(buffer);
+                sprintf(buffer,"  Kernel: %s\n",
+                        lukernelnames[global_lublockstruct.kernel]);
+                output_string(buffer);
+                sprintf(buffer,"  GFLOP/s: %.3f\n",global_lublockstruct.gflops);
+                output_string(buffer);
+                break;
+
+        case TF_FOURSIMD:       /* Fourier, vector math */
+                sprintf(buffer,"  Number of coefficients: %lu\n",
+                        global_fouriersimdstruct.arraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Kernel: %s, %d threads\n",
+                        simdnames[global_simd],
+                        global_fouriersimdstruct.workers);
+                output_string(buffer);
+                break;
+
+        case TF_NNETMLP:        /* Neural net, batched */
+                sprintf(buffer,"  Net: %lu-%lu-%lu, %lu patterns in batches of %lu\n",
+                        global_mlpstruct.in,global_mlpstruct.hid,
+                        global_mlpstruct.out,global_mlpstruct.npats,
+                        global_mlpstruct.batch);
+                output_string(buffer);
+                sprintf(buffer,"  Epochs per iteration: %lu\n",
+                        global_mlpstruct.loops);
+                output_string(buffer);
+                sprintf(buffer,"  GFLOP/s: %.3f\n",global_mlpstruct.gflops);
+                output_string(buffer);
+                break;
+
+        case TF_ASSIGNJV:       /* Assignment, JV */
+                sprintf(buffer,"  Matrix: %lux%lu\n",
+                        global_assignjvstruct.n,global_assignjvstruct.n);
+                output_string(buffer);
+                sprintf(buffer,"  Cost: %ld\n",global_assignjvstruct.cost);
+                output_string(buffer);
+                break;
+
+        case TF_FPEMUWIDE:      /* Floating-point emulation, 64-bit */
+                sprintf(buffer,"  Number of loops: %lu\n",
+                        global_emfloatwidestruct.loops);
+                output_string(buffer);
+                sprintf(buffer,"  Array size: %lu\n",
+                        global_emfloatwidestruct.arraysize);
+                output_string(buffer);
+                break;
+
+        case TF_FPEMUSORT:      /* Floating-point emulation, sorted */
+                sprintf(buffer,"  Number of loops: %lu\n",
+                        global_emfloatsortstruct.loops);
+                output_string(buffer);
+                sprintf(buffer,"  Array size: %lu\n",
+                        global_emfloatsortstruct.arraysize);
+                output_string(buffer);
+                sprintf(buffer,"  Threads: %d\n",
+                        global_emfloatsortstruct.workers);
+                output_string(buffer);
+                break;
 }
 return;
 }
@@ -1202,3 +2455,1199 @@ while(*ptr)
 return(ptr);
 }
 #endif
+
+/*********************
+** show_transitions **
+**********************
+** Print the ECALL/OCALL transition table left behind by
+** DoTransitions().
+*/
+static void show_transitions(void)
+{
+TransResult *result;
+char title[32];
+int i;
+
+sprintf(title,"TRANSITION (%d thread%s)",
+        global_transstruct.threads,
+        global_transstruct.threads==1 ? "" : "s");
+sprintf(buffer,"\n%-28s:  Samples :    p50 ns :    p99 ns :  p99.9 ns : Calls/s/thread : Calls/s total\n",
+        title);
+output_string(buffer);
+output_string("----------------------------:----------:-----------:-----------:-----------:----------------:--------------\n");
+for(i=0;i<global_transstruct.numresults;i++)
+{       result=&global_transstruct.results[i];
+        if(result->failed)
+                sprintf(buffer,"%-28s:  ECALL failed (no free TCS, or buffer too large for the heap?)\n",
+                        result->name);
+        else
+                sprintf(buffer,"%-28s: %8lu : %9.0f : %9.0f : %9.0f : %14.5g : %12.5g\n",
+                        result->name,result->samples,
+                        result->p50,result->p99,result->p999,
+                        result->perthread,result->total);
+        output_string(buffer);
+}
+sprintf(buffer,"Each sample includes ~%.0f ns of clock overhead; OCALLs are timed on one thread.\n",
+        global_transstruct.timeroverhead);
+output_string(buffer);
+return;
+}
+
+/***************
+** diff_ratio **
+****************
+** Slowdown of the enclave against native code for one test,
+** with a 95% confidence interval.  The ratio of two means has
+** (to first order) a relative error that is the root sum of
+** squares of the relative standard errors of the means; the
+** interval uses the t value for the smaller of the two runs.
+*/
+static void diff_ratio(DiffResult *result)
+{
+double relerr;          /* Relative standard error of ratio */
+double re, rn;          /* ...of each mean */
+ulong df;               /* Degrees of freedom */
+
+result->ratio=result->lo=result->hi=(double)0.0;
+if(result->enclave<=(double)0.0 || result->native<=(double)0.0)
+        return;
+result->ratio=result->native/result->enclave;
+re=result->enclstdev/sqrt((double)result->enclruns)/result->enclave;
+rn=result->natstdev/sqrt((double)result->natruns)/result->native;
+relerr=sqrt(re*re+rn*rn);
+df=result->enclruns<result->natruns ? result->enclruns : result->natruns;
+df=df<2 ? 1 : df-1;
+if(df>29) df=29;
+result->lo=result->ratio*((double)1.0-student_t[df]*relerr);
+result->hi=result->ratio*((double)1.0+student_t[df]*relerr);
+if(result->lo<(double)0.0) result->lo=(double)0.0;
+return;
+}
+
+/**********************
+** show_differential **
+***********************
+** Print the native-vs-enclave table.  Slowdown is native
+** iterations/sec over enclave iterations/sec, so 1.0 means
+** the enclave costs nothing.
+*/
+static void show_differential(void)
+{
+DiffResult *result;
+int i;
+
+output_string("\nNATIVE VS ENCLAVE   :  Native it/s : Enclave it/s : Slowdown : 95% CI\n");
+output_string("--------------------:--------------:--------------:----------:------------------\n");
+for(i=0;i<NUMALLTESTS;i++)
+{       result=&diff_results[i];
+        if(!result->done)
+                continue;
+        sprintf(buffer,"%-20s: %12.5g : %12.5g : %8.3f : %.3f - %.3f\n",
+                ftestnames[i],result->native,result->enclave,
+                result->ratio,result->lo,result->hi);
+        output_string(buffer);
+}
+return;
+}
+
+/***************
+** show_sweep **
+****************
+** Print the EPC-pressure sweep left behind by DoSweep(),
+** with a bar of ns/byte for each size so the cliff stands
+** out, and the first size where ns/byte doubled.
+*/
+static void show_sweep(void)
+{
+static char *sweepnames[]={"NUMSORT","EMF","IDEA","HUFFMAN"};
+SweepResult *result;
+char size[24];          /* Working set, printable */
+char bar[SWEEPBAR+1];   /* ns/byte as a bar */
+double maxns;           /* Largest ns/byte, for scaling */
+double minns;           /* Smallest ns/byte so far */
+ulong cliff;            /* Where ns/byte doubled */
+int i, n;
+
+maxns=(double)0.0;
+for(i=0;i<global_sweepstruct.numresults;i++)
+        if(global_sweepstruct.results[i].nsperbyte>maxns)
+                maxns=global_sweepstruct.results[i].nsperbyte;
+
+sprintf(buffer,"\nEPC SWEEP (%-7s) :  Iterations/sec :   ns/byte",
+        sweepnames[global_sweepstruct.test]);
+output_string(buffer);
+if(global_sweepstruct.native)
+        output_string(" :  Native it/s :  Slowdown");
+output_string("\n--------------------:-----------------:----------");
+if(global_sweepstruct.native)
+        output_string(":--------------:----------");
+output_string("\n");
+
+minns=(double)0.0;
+cliff=0L;
+for(i=0;i<global_sweepstruct.numresults;i++)
+{       result=&global_sweepstruct.results[i];
+        if(result->bytes<1024L*1024L)
+                snprintf(size,sizeof(size),"%lu KB",result->bytes/1024L);
+        else
+                snprintf(size,sizeof(size),"%lu MB",
+                        result->bytes/(1024L*1024L));
+        if(result->failed)
+        {       sprintf(buffer,"%-20s:  does not fit in the enclave heap\n",size);
+                output_string(buffer);
+                break;
+        }
+        if(minns==(double)0.0 || result->nsperbyte<minns)
+                minns=result->nsperbyte;
+        else if(cliff==0L && result->nsperbyte>(double)2.0*minns)
+                cliff=result->bytes;
+        n=maxns>(double)0.0 ? (int)(SWEEPBAR*result->nsperbyte/maxns+0.5) : 0;
+        memset(bar,'#',n);
+        bar[n]='\0';
+        sprintf(buffer,"%-20s: %15.5g : %9.4g",
+                size,result->iterspersec,result->nsperbyte);
+        output_string(buffer);
+        if(global_sweepstruct.native)
+        {       sprintf(buffer," : %12.5g : %8.3f",
+                        result->native,result->native/result->iterspersec);
+                output_string(buffer);
+        }
+        sprintf(buffer," %s\n",bar);
+        output_string(buffer);
+}
+if(cliff!=0L)
+{       sprintf(buffer,"ns/byte doubled at %lu KB (EPC paging?)\n",cliff/1024L);
+        output_string(buffer);
+}
+return;
+}
+
+/****************
+** show_stream **
+*****************
+** Print the streaming IDEA results left behind by
+** DoStream(): MB/s of the serial and the pipelined run for
+** each chunk size, and how much the overlap gained.
+*/
+static void show_stream(void)
+{
+StreamResult *result;
+char size[24];          /* Chunk size, printable */
+int i;
+
+sprintf(buffer,"\nSTREAMING IDEA (%s, %lu MB)\n",
+        simdnames[global_simd],global_streamstruct.mb);
+output_string(buffer);
+output_string("CHUNK               :  Serial MB/s : Pipelined MB/s :  Overlap");
+if(global_streamstruct.native)
+        output_string(" :  Native MB/s :  Slowdown");
+output_string("\n--------------------:--------------:----------------:---------");
+if(global_streamstruct.native)
+        output_string(":--------------:----------");
+output_string("\n");
+
+for(i=0;i<global_streamstruct.numresults;i++)
+{       result=&global_streamstruct.results[i];
+        if(result->chunk<1024L*1024L)
+                snprintf(size,sizeof(size),"%lu KB",result->chunk/1024L);
+        else
+                snprintf(size,sizeof(size),"%lu MB",
+                        result->chunk/(1024L*1024L));
+        if(result->failed)
+        {       sprintf(buffer,"%-20s:  rings do not fit in the enclave heap\n",size);
+                output_string(buffer);
+                break;
+        }
+        if(result->nothreads)
+        {       sprintf(buffer,"%-20s:  cannot start the stage threads\n",size);
+                output_string(buffer);
+                break;
+        }
+        sprintf(buffer,"%-20s: %12.1f : %14.1f : %7.2fx",
+                size,result->serial,result->pipelined,
+                result->pipelined/result->serial);
+        output_string(buffer);
+        if(global_streamstruct.native)
+        {       sprintf(buffer," : %12.1f : %8.3f",
+                        result->native,result->native/result->pipelined);
+                output_string(buffer);
+        }
+        if(result->mismatch)
+                output_string("  ** output differs");
+        output_string("\n");
+}
+return;
+}
+
+/**************
+** get_sizes **
+***************
+** The array sizes and loop counts a test ran with, as
+** self-adjustment left them in its global structure.
+** Returns the # of entries put in names[] and sizes[].
+*/
+static int get_sizes(int fid, char *names[], ulong sizes[])
+{
+switch(fid)
+{       case TF_NUMSORT:
+                names[0]="arraysize"; sizes[0]=global_numsortstruct.arraysize;
+                names[1]="numarrays"; sizes[1]=global_numsortstruct.numarrays;
+                return(2);
+        case TF_SSORT:
+                names[0]="arraysize"; sizes[0]=global_strsortstruct.arraysize;
+                names[1]="numarrays"; sizes[1]=global_strsortstruct.numarrays;
+                return(2);
+        case TF_BITOP:
+                names[0]="bitfieldarraysize"; sizes[0]=global_bitopstruct.bitfieldarraysize;
+                names[1]="bitoparraysize"; sizes[1]=global_bitopstruct.bitoparraysize;
+                return(2);
+        case TF_BITOPECALL:
+                names[0]="bitfieldarraysize"; sizes[0]=global_bitopecallstruct.bitfieldarraysize;
+                names[1]="bitoparraysize"; sizes[1]=global_bitopecallstruct.bitoparraysize;
+                return(2);
+        case TF_FPEMU:
+                names[0]="arraysize"; sizes[0]=global_emfloatstruct.arraysize;
+                names[1]="loops"; sizes[1]=global_emfloatstruct.loops;
+                return(2);
+        case TF_FFPU:
+                names[0]="arraysize"; sizes[0]=global_fourierstruct.arraysize;
+                return(1);
+        case TF_ASSIGN:
+                names[0]="numarrays"; sizes[0]=global_assignstruct.numarrays;
+                return(1);
+        case TF_IDEA:
+                names[0]="arraysize"; sizes[0]=global_ideastruct.arraysize;
+                names[1]="loops"; sizes[1]=global_ideastruct.loops;
+                return(2);
+        case TF_IDEASIMD:
+                names[0]="arraysize"; sizes[0]=global_ideasimdstruct.arraysize;
+                names[1]="loops"; sizes[1]=global_ideasimdstruct.loops;
+                names[2]="simdblocks"; sizes[2]=8<<global_simd;
+                return(3);
+        case TF_HUFF:
+                names[0]="arraysize"; sizes[0]=global_huffstruct.arraysize;
+                names[1]="loops"; sizes[1]=global_huffstruct.loops;
+                return(2);
+        case TF_HUFFTABLE:
+                names[0]="arraysize"; sizes[0]=global_hufftablestruct.arraysize;
+                names[1]="loops"; sizes[1]=global_hufftablestruct.loops;
+                return(2);
+        case TF_NUMSORTPAR:
+                names[0]="arraysize"; sizes[0]=global_numsortparstruct.arraysize;
+                names[1]="numarrays"; sizes[1]=global_numsortparstruct.numarrays;
+                names[2]="workers"; sizes[2]=global_numsortparstruct.workers;
+                names[3]="algo"; sizes[3]=global_numsortparstruct.algo;
+                return(4);
+        case TF_SSORTKEY:
+                names[0]="arraysize"; sizes[0]=global_strsortkeystruct.arraysize;
+                names[1]="numarrays"; sizes[1]=global_strsortkeystruct.numarrays;
+                return(2);
+        case TF_BITOPWORD:
+                names[0]="bitfieldarraysize"; sizes[0]=global_bitopwordstruct.bitfieldarraysize;
+                names[1]="bitoparraysize"; sizes[1]=global_bitopwordstruct.bitoparraysize;
+                names[2]="kernel"; sizes[2]=global_bitopwordstruct.kernel;
+                return(3);
+        case TF_LUBLOCK:
+                names[0]="n"; sizes[0]=global_lublockstruct.n;
+                names[1]="nb"; sizes[1]=global_lublockstruct.nb;
+                names[2]="kernel"; sizes[2]=global_lublockstruct.kernel;
+                return(3);
+        case TF_FOURSIMD:
+                names[0]="arraysize"; sizes[0]=global_fouriersimdstruct.arraysize;
+                names[1]="workers"; sizes[1]=global_fouriersimdstruct.workers;
+                return(2);
+        case TF_NNETMLP:
+                names[0]="in"; sizes[0]=global_mlpstruct.in;
+                names[1]="hidden"; sizes[1]=global_mlpstruct.hid;
+                names[2]="out"; sizes[2]=global_mlpstruct.out;
+                names[3]="patterns"; sizes[3]=global_mlpstruct.npats;
+                names[4]="batch"; sizes[4]=global_mlpstruct.batch;
+                names[5]="loops"; sizes[5]=global_mlpstruct.loops;
+                return(6);
+        case TF_ASSIGNJV:
+                names[0]="n"; sizes[0]=global_assignjvstruct.n;
+                return(1);
+        case TF_FPEMUWIDE:
+                names[0]="arraysize"; sizes[0]=global_emfloatwidestruct.arraysize;
+                names[1]="loops"; sizes[1]=global_emfloatwidestruct.loops;
+                return(2);
+        case TF_FPEMUSORT:
+                names[0]="arraysize"; sizes[0]=global_emfloatsortstruct.arraysize;
+                names[1]="loops"; sizes[1]=global_emfloatsortstruct.loops;
+                names[2]="workers"; sizes[2]=global_emfloatsortstruct.workers;
+                return(3);
+        case TF_NNET:
+                names[0]="loops"; sizes[0]=global_nnetstruct.loops;
+                return(1);
+        case TF_LU:
+                names[0]="numarrays"; sizes[0]=global_lustruct.numarrays;
+                return(1);
+}
+return(0);
+}
+
+/****************
+** json_string **
+*****************
+** Write s as a JSON string, without trailing blanks (the
+** test names are padded for the table).
+*/
+static void json_string(FILE *fp, char *s)
+{
+int n;
+
+n=(int)strlen(s);
+while(n>0 && s[n-1]==' ')
+        n--;
+fputc('"',fp);
+for(;n>0;n--,s++)
+{       if(*s=='"' || *s=='\\')
+                fprintf(fp,"\\%c",*s);
+        else if((unsigned char)*s<0x20)
+                fprintf(fp,"\\u%04x",(unsigned int)(unsigned char)*s);
+        else
+                fputc(*s,fp);
+}
+fputc('"',fp);
+return;
+}
+
+/*******************
+** json_scoreset **
+********************
+** Write the members of one ScoreSet.
+*/
+static void json_scoreset(FILE *fp, ScoreSet *set)
+{
+int i;
+
+fprintf(fp,"\"mean\": %.10g, \"stdev\": %.10g, \"runs\": %d, ",
+        set->mean,set->stdev,set->numscores);
+fprintf(fp,"\"half_interval\": %.10g, \"certain\": %s,\n",
+        set->halfint,set->uncertain ? "false" : "true");
+fprintf(fp,"      \"scores\": [");
+for(i=0;i<set->numscores;i++)
+        fprintf(fp,"%s%.10g",i ? ", " : "",set->scores[i]);
+fprintf(fp,"]");
+return;
+}
+
+/***************
+** write_json **
+****************
+** Write every test's results, with the scores of every run
+** and what the run was made on, to filename as JSON.
+*/
+static void write_json(char *filename)
+{
+FILE *fp;
+char model[BUF_SIZ];    /* From hardware_info() */
+char cache[BUF_SIZ];
+char os[BUF_SIZ];
+time_t now;
+char date[32];
+char *names[6];         /* From get_sizes() */
+ulong sizes[6];
+int nsizes;
+int first;
+int i, j;
+
+fp=fopen(filename,"w");
+if(fp==(FILE *)NULL)
+{       printf("**Error opening JSON file: %s\n",filename);
+        return;
+}
+hardware_info(model,cache,os);
+time(&now);
+strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%S",localtime(&now));
+
+fprintf(fp,"{\n  \"date\": \"%s\",\n",date);
+fprintf(fp,"  \"sgx_mode\": ");
+json_string(fp,(char *)app_sgx_mode);
+if(app_switchless)
+        fprintf(fp,",\n  \"transitions\": \"switchless\", \"trusted_workers\": %u, \"untrusted_workers\": %u",
+                app_switchless_tworkers,app_switchless_uworkers);
+else
+        fprintf(fp,",\n  \"transitions\": \"ecall\"");
+fprintf(fp,",\n  \"threads\": %d,\n",global_threads);
+#ifdef TIMERSELECT
+fprintf(fp,"  \"timer\": ");
+json_string(fp,StopwatchName());
+fprintf(fp,", \"timer_resolution_ns\": %.3g,\n",
+        StopwatchResolution()*(double)1e9);
+#else
+fprintf(fp,"  \"timer\": \"clock()\", \"timer_resolution_ns\": %.3g,\n",
+        (double)1e9/(double)CLOCKS_PER_SEC);
+#endif
+fprintf(fp,"  \"min_seconds\": %lu, \"min_ticks\": %lu,\n",
+        global_min_seconds,global_min_ticks);
+fprintf(fp,"  \"cpu\": ");
+json_string(fp,model);
+fprintf(fp,", \"l2_cache\": ");
+json_string(fp,cache);
+fprintf(fp,", \"os\": ");
+json_string(fp,os);
+fprintf(fp,",\n  \"tests\": [");
+
+first=1;
+for(i=0;i<NUMALLTESTS;i++)
+{       if(!test_results[i].done)
+                continue;
+        fprintf(fp,"%s\n    {\"name\": ",first ? "" : ",");
+        first=0;
+        json_string(fp,ftestnames[i]);
+        fprintf(fp,", ");
+        json_scoreset(fp,&test_results[i].enclave);
+        if(i<NUMTESTS && global_threads==1)
+                fprintf(fp,",\n      \"index_old\": %.10g, \"index_new\": %.10g",
+                        test_results[i].enclave.mean/bindex[i],
+                        test_results[i].enclave.mean/lx_bindex[i]);
+        fprintf(fp,",\n      \"sizes\": {");
+        nsizes=get_sizes(i,names,sizes);
+        for(j=0;j<nsizes;j++)
+                fprintf(fp,"%s\"%s\": %lu",j ? ", " : "",names[j],sizes[j]);
+        fprintf(fp,"}");
+        if(global_diff)
+        {       fprintf(fp,",\n      \"native\": {");
+                json_scoreset(fp,&test_results[i].native);
+                fprintf(fp,"}");
+        }
+        fprintf(fp,"}");
+}
+fprintf(fp,"\n  ]\n}\n");
+fclose(fp);
+return;
+}
+
+/**************
+** write_csv **
+***************
+** Write the same results to filename as CSV: one row per
+** test (and per native run), the scores of every run in one
+** space-separated column, and the run's settings repeated
+** on each row so rows can be loaded on their own.
+*/
+static void write_csv(char *filename)
+{
+FILE *fp;
+char model[BUF_SIZ];    /* From hardware_info() */
+char cache[BUF_SIZ];
+char os[BUF_SIZ];
+char name[32];          /* Test name without padding */
+char *timer;
+char *names[6];         /* From get_sizes() */
+ulong sizes[6];
+ScoreSet *set;
+int nsizes;
+int i, j, k, n;
+
+fp=fopen(filename,"w");
+if(fp==(FILE *)NULL)
+{       printf("**Error opening CSV file: %s\n",filename);
+        return;
+}
+hardware_info(model,cache,os);
+for(j=0;model[j]!='\0';j++)
+        if(model[j]=='"')
+                model[j]='\'';
+#ifdef TIMERSELECT
+timer=StopwatchName();
+#else
+timer="clock()";
+#endif
+
+fprintf(fp,"test,where,mean,stdev,runs,half_interval,certain,sizes,scores,sgx_mode,transitions,threads,timer,cpu\n");
+for(i=0;i<NUMALLTESTS;i++)
+{       if(!test_results[i].done)
+                continue;
+        strcpy(name,ftestnames[i]);
+        n=(int)strlen(name);
+        while(n>0 && name[n-1]==' ')
+                name[--n]='\0';
+        for(k=0;k<(global_diff ? 2 : 1);k++)
+        {       set=k ? &test_results[i].native : &test_results[i].enclave;
+                fprintf(fp,"%s,%s,%.10g,%.10g,%d,%.10g,%d,\"",
+                        name,k ? "native" : "enclave",
+                        set->mean,set->stdev,set->numscores,set->halfint,
+                        set->uncertain ? 0 : 1);
+                nsizes=get_sizes(i,names,sizes);
+                for(j=0;j<nsizes;j++)
+                        fprintf(fp,"%s%s=%lu",j ? " " : "",names[j],sizes[j]);
+                fprintf(fp,"\",\"");
+                for(j=0;j<set->numscores;j++)
+                        fprintf(fp,"%s%.10g",j ? " " : "",set->scores[j]);
+                fprintf(fp,"\",%s,%s,%d,%s,\"%s\"\n",
+                        app_sgx_mode,app_switchless ? "switchless" : "ecall",
+                        global_threads,timer,model);
+        }
+}
+fclose(fp);
+return;
+}
+
+/******************
+** load_baseline **
+*******************
+** Read the enclave scores of each test from a CSVFILE of an
+** earlier run into baseline_scores[].  Rows of tests this
+** build does not know, and native rows, are skipped.
+*/
+static void load_baseline(char *filename)
+{
+FILE *fp;
+static char line[8192];
+char name[32];          /* Test name without padding */
+char *p, *field;
+char *test, *where, *scores;
+ScoreSet *set;
+double sum;
+int i, j, n;
+
+fp=fopen(filename,"r");
+if(fp==(FILE *)NULL)
+{       printf("**Error opening baseline file: %s\n",filename);
+        ErrorExit();
+}
+memset(baseline_scores,0,sizeof(baseline_scores));
+
+/*
+** Skip the header, then pick test, where and scores out of
+** each row (columns 1, 2 and 9).
+*/
+fgets(line,sizeof(line),fp);
+while(fgets(line,sizeof(line),fp)!=NULL)
+{       p=line;
+        test=where=scores=NULL;
+        for(j=0;j<9 && p!=NULL;j++)
+        {       field=csv_field(&p);
+                if(j==0) test=field;
+                else if(j==1) where=field;
+                else if(j==8) scores=field;
+        }
+        if(scores==NULL || strcmp(where,"enclave")!=0)
+                continue;
+        for(i=0;i<NUMALLTESTS;i++)
+        {       strcpy(name,ftestnames[i]);
+                n=(int)strlen(name);
+                while(n>0 && name[n-1]==' ')
+                        name[--n]='\0';
+                if(strcmp(name,test)==0)
+                        break;
+        }
+        if(i==NUMALLTESTS)
+                continue;
+
+        set=&baseline_scores[i];
+        set->numscores=0;
+        p=scores;
+        while(set->numscores<MAXSCORES)
+        {       set->scores[set->numscores]=strtod(p,&field);
+                if(field==p)
+                        break;
+                set->numscores++;
+                p=field;
+        }
+        sum=(double)0.0;
+        for(j=0;j<set->numscores;j++)
+                sum+=set->scores[j];
+        set->mean=set->numscores ? sum/(double)set->numscores : (double)0.0;
+        sum=(double)0.0;
+        for(j=0;j<set->numscores;j++)
+                sum+=(set->scores[j]-set->mean)*(set->scores[j]-set->mean);
+        set->stdev=set->numscores>1 ?
+                sqrt(sum/(double)(set->numscores-1)) : (double)0.0;
+}
+fclose(fp);
+return;
+}
+
+/**************
+** csv_field **
+***************
+** Cut the next comma-separated field off *line and return
+** it, without the quotes if it had any.  *line is left after
+** the comma, or NULL at the end of the row.
+*/
+static char *csv_field(char **line)
+{
+char *p, *field;
+
+p=*line;
+if(*p=='"')
+{       field=++p;
+        while(*p!='\0' && *p!='"')
+                p++;
+        if(*p=='"')
+                *p++='\0';
+}
+else
+        field=p;
+while(*p!='\0' && *p!=',' && *p!='\n' && *p!='\r')
+        p++;
+if(*p==',')
+{       *p='\0';
+        *line=p+1;
+}
+else
+{       *p='\0';
+        *line=NULL;
+}
+return(field);
+}
+
+/*********************
+** compare_baseline **
+**********************
+** Print how each test moved against the baseline and
+** return the # of regressions: tests slower by more than
+** global_regression percent where Welch's t-test says the
+** difference is real (p below SIGNIFICANCE).
+*/
+static int compare_baseline(void)
+{
+ScoreSet *now, *then;
+double change;          /* % change of the mean */
+double p;               /* Two-sided p-value */
+char *verdict;
+int regressions;
+int i;
+
+regressions=0;
+sprintf(buffer,"\nBASELINE (%5.1f%%)   :   Baseline it/s :    Current it/s :   Change : p-value\n",
+        global_regression);
+output_string(buffer);
+output_string("--------------------:-----------------:-----------------:----------:---------\n");
+for(i=0;i<NUMALLTESTS;i++)
+{       if(!test_results[i].done)
+                continue;
+        now=&test_results[i].enclave;
+        then=&baseline_scores[i];
+        if(then->numscores<2)
+        {       sprintf(buffer,"%-20s:  not in baseline\n",ftestnames[i]);
+                output_string(buffer);
+                continue;
+        }
+        change=(double)100.0*(now->mean-then->mean)/then->mean;
+        p=welch_test(now,then);
+        if(p>=SIGNIFICANCE)
+                verdict="same";
+        else if(change< -global_regression)
+        {       verdict="REGRESSION";
+                regressions++;
+        }
+        else if(change<(double)0.0)
+                verdict="slower";
+        else
+                verdict="faster";
+        sprintf(buffer,"%-20s: %15.5g : %15.5g : %+7.2f%% : %7.4f  %s\n",
+                ftestnames[i],then->mean,now->mean,change,p,verdict);
+        output_string(buffer);
+}
+if(regressions>0)
+{       sprintf(buffer,"%d test%s regressed\n",regressions,
+                regressions==1 ? "" : "s");
+        output_string(buffer);
+}
+return(regressions);
+}
+
+/***************
+** welch_test **
+****************
+** Welch's t-test of two sets of scores that need not have
+** the same variance.  Returns the two-sided p-value.
+*/
+static double welch_test(ScoreSet *a, ScoreSet *b)
+{
+double va, vb;          /* Variance of each mean */
+double t;               /* t statistic */
+double df;              /* Welch-Satterthwaite degrees of freedom */
+
+va=a->stdev*a->stdev/(double)a->numscores;
+vb=b->stdev*b->stdev/(double)b->numscores;
+if(va+vb<=(double)0.0)
+        return(a->mean==b->mean ? (double)1.0 : (double)0.0);
+t=(a->mean-b->mean)/sqrt(va+vb);
+df=(va+vb)*(va+vb)/
+        (va*va/(double)(a->numscores-1)+vb*vb/(double)(b->numscores-1));
+
+/*
+** P(|T|>t) for Student's t with df degrees of freedom.
+*/
+return(incbeta(df/(double)2.0,(double)0.5,df/(df+t*t)));
+}
+
+/************
+** incbeta **
+*************
+** Regularized incomplete beta function I_x(a,b), from its
+** continued fraction (Numerical Recipes, betai).
+*/
+static double incbeta(double a, double b, double x)
+{
+double bt;
+
+if(x<=(double)0.0)
+        return((double)0.0);
+if(x>=(double)1.0)
+        return((double)1.0);
+bt=exp(lgamma(a+b)-lgamma(a)-lgamma(b)+a*log(x)+b*log((double)1.0-x));
+if(x<(a+(double)1.0)/(a+b+(double)2.0))
+        return(bt*betacf(a,b,x)/a);
+return((double)1.0-bt*betacf(b,a,(double)1.0-x)/b);
+}
+
+/***********
+** betacf **
+************
+** Continued fraction for incbeta(), by the modified Lentz
+** method.
+*/
+static double betacf(double a, double b, double x)
+{
+double c, d, h, aa, del;
+double tiny;
+int m, m2;
+
+tiny=(double)1e-300;
+c=(double)1.0;
+d=(double)1.0-(a+b)*x/(a+(double)1.0);
+if(fabs(d)<tiny) d=tiny;
+d=(double)1.0/d;
+h=d;
+for(m=1;m<=200;m++)
+{       m2=2*m;
+        aa=(double)m*(b-(double)m)*x/((a+(double)m2-(double)1.0)*(a+(double)m2));
+        d=(double)1.0+aa*d;
+        if(fabs(d)<tiny) d=tiny;
+        c=(double)1.0+aa/c;
+        if(fabs(c)<tiny) c=tiny;
+        d=(double)1.0/d;
+        h*=d*c;
+        aa=-(a+(double)m)*(a+b+(double)m)*x/((a+(double)m2)*(a+(double)m2+(double)1.0));
+        d=(double)1.0+aa*d;
+        if(fabs(d)<tiny) d=tiny;
+        c=(double)1.0+aa/c;
+        if(fabs(c)<tiny) c=tiny;
+        d=(double)1.0/d;
+        del=d*c;
+        h*=del;
+        if(fabs(del-(double)1.0)<(double)1e-12)
+                break;
+}
+return(h);
+}
+
+/*******************
+** make_calib_key **
+********************
+** Fill in calib_key for this machine and build.  What the
+** self-adjustment settles on depends on the CPU (model and
+** microcode), on how the enclave is entered (SGX mode and
+** transitions), on the minimum timed span, on the threads
+** per test and the arena that share the enclave heap, and on
+** the code, for which the App and the enclave are hashed.
+** Returns 0, or -1 if the key does not fit in calib_key.
+*/
+static int make_calib_key(void)
+{
+char model[BUF_SIZ];
+char microcode[BUF_SIZ];
+char *timer;
+unsigned long long hash;
+int j, n;
+
+cpu_identity(model,microcode);
+for(j=0;model[j]!='\0';j++)
+        if(model[j]=='"')
+                model[j]='\'';
+model[BUF_SIZ/2]='\0';
+microcode[64]='\0';
+#ifdef TIMERSELECT
+timer=StopwatchName();
+#else
+timer="clock()";
+#endif
+
+hash=14695981039346656037ULL;   /* FNV-1a offset basis */
+#ifdef LINUX
+hash_file("/proc/self/exe",&hash);
+#endif
+hash_file(app_enclave_file(),&hash);
+
+n=snprintf(calib_key,sizeof(calib_key),"%s; microcode %s; %s; %s; "
+        "%s, %lu ticks; %d threads; arena %lu KB; build %016llx",
+        model[0]!='\0' ? model : "unknown CPU",
+        microcode[0]!='\0' ? microcode : "unknown",
+        app_sgx_mode,app_switchless ? "switchless" : "ecall",
+        timer,global_min_ticks,global_threads,global_arenakb,hash);
+return(n<0 || n>=(int)sizeof(calib_key) ? -1 : 0);
+}
+
+/**************
+** hash_file **
+***************
+** Run the bytes of file name through the 64-bit FNV-1a hash
+** in *hash.  A file that cannot be read adds nothing.
+*/
+static void hash_file(const char *name, unsigned long long *hash)
+{
+FILE *fp;
+unsigned char block[4096];
+size_t n, i;
+
+fp=fopen(name,"rb");
+if(fp==(FILE *)NULL)
+        return;
+while((n=fread(block,1,sizeof(block),fp))>0)
+        for(i=0;i<n;i++)
+        {       *hash^=(unsigned long long)block[i];
+                *hash*=1099511628211ULL;        /* FNV prime */
+        }
+fclose(fp);
+return;
+}
+
+/***************
+** calib_size **
+****************
+** The size the self-adjustment of test fid settles: its
+** name, as in get_sizes(), in *name and its value in *value.
+** With set, it is first set to *value.  Returns a pointer to
+** the adjust flag of the test, or NULL if it does not
+** self-adjust.
+*/
+static int *calib_size(int fid, char **name, ulong *value, int set)
+{
+switch(fid)
+{       case TF_NUMSORT:
+                if(set) global_numsortstruct.numarrays=(ushort)*value;
+                *name="numarrays"; *value=global_numsortstruct.numarrays;
+                return(&global_numsortstruct.adjust);
+        case TF_NUMSORTPAR:
+                if(set) global_numsortparstruct.numarrays=(ushort)*value;
+                *name="numarrays"; *value=global_numsortparstruct.numarrays;
+                return(&global_numsortparstruct.adjust);
+        case TF_SSORT:
+                if(set) global_strsortstruct.numarrays=(ushort)*value;
+                *name="numarrays"; *value=global_strsortstruct.numarrays;
+                return(&global_strsortstruct.adjust);
+        case TF_SSORTKEY:
+                if(set) global_strsortkeystruct.numarrays=(ushort)*value;
+                *name="numarrays"; *value=global_strsortkeystruct.numarrays;
+                return(&global_strsortkeystruct.adjust);
+        case TF_BITOP:
+                if(set) global_bitopstruct.bitoparraysize=*value;
+                *name="bitoparraysize"; *value=global_bitopstruct.bitoparraysize;
+                return(&global_bitopstruct.adjust);
+        case TF_BITOPECALL:
+                if(set) global_bitopecallstruct.bitoparraysize=*value;
+                *name="bitoparraysize"; *value=global_bitopecallstruct.bitoparraysize;
+                return(&global_bitopecallstruct.adjust);
+        case TF_BITOPWORD:
+                if(set) global_bitopwordstruct.bitoparraysize=*value;
+                *name="bitoparraysize"; *value=global_bitopwordstruct.bitoparraysize;
+                return(&global_bitopwordstruct.adjust);
+        case TF_FPEMU:
+                if(set) global_emfloatstruct.loops=*value;
+                *name="loops"; *value=global_emfloatstruct.loops;
+                return(&global_emfloatstruct.adjust);
+        case TF_FPEMUWIDE:
+                if(set) global_emfloatwidestruct.loops=*value;
+                *name="loops"; *value=global_emfloatwidestruct.loops;
+                return(&global_emfloatwidestruct.adjust);
+        case TF_FPEMUSORT:
+                if(set) global_emfloatsortstruct.loops=*value;
+                *name="loops"; *value=global_emfloatsortstruct.loops;
+                return(&global_emfloatsortstruct.adjust);
+        case TF_FFPU:
+                if(set) global_fourierstruct.arraysize=*value;
+                *name="arraysize"; *value=global_fourierstruct.arraysize;
+                return(&global_fourierstruct.adjust);
+        case TF_FOURSIMD:
+                if(set) global_fouriersimdstruct.arraysize=*value;
+                *name="arraysize"; *value=global_fouriersimdstruct.arraysize;
+                return(&global_fouriersimdstruct.adjust);
+        case TF_ASSIGN:
+                if(set) global_assignstruct.numarrays=*value;
+                *name="numarrays"; *value=global_assignstruct.numarrays;
+                return(&global_assignstruct.adjust);
+        case TF_IDEA:
+                if(set) global_ideastruct.loops=*value;
+                *name="loops"; *value=global_ideastruct.loops;
+                return(&global_ideastruct.adjust);
+        case TF_IDEASIMD:
+                if(set) global_ideasimdstruct.loops=*value;
+                *name="loops"; *value=global_ideasimdstruct.loops;
+                return(&global_ideasimdstruct.adjust);
+        case TF_HUFF:
+                if(set) global_huffstruct.loops=*value;
+                *name="loops"; *value=global_huffstruct.loops;
+                return(&global_huffstruct.adjust);
+        case TF_HUFFTABLE:
+                if(set) global_hufftablestruct.loops=*value;
+                *name="loops"; *value=global_hufftablestruct.loops;
+                return(&global_hufftablestruct.adjust);
+        case TF_NNET:
+                if(set) global_nnetstruct.loops=*value;
+                *name="loops"; *value=global_nnetstruct.loops;
+                return(&global_nnetstruct.adjust);
+        case TF_NNETMLP:
+                if(set) global_mlpstruct.loops=*value;
+                *name="loops"; *value=global_mlpstruct.loops;
+                return(&global_mlpstruct.adjust);
+        case TF_LU:
+                if(set) global_lustruct.numarrays=*value;
+                *name="numarrays"; *value=global_lustruct.numarrays;
+                return(&global_lustruct.adjust);
+}
+return(NULL);
+}
+
+/***************
+** calib_find **
+****************
+** Put the sizes of test fid other than the one its
+** self-adjustment settles in sizes[] (256 characters), and
+** return the cache entry of the test with those sizes under
+** calib_key, or -1 if there is none.
+*/
+static int calib_find(int fid, char *sizes)
+{
+char test[32];          /* Test name without padding */
+char *names[6];         /* From get_sizes() */
+ulong values[6];
+char *name;
+ulong value;
+int nsizes, i, n;
+
+strcpy(test,ftestnames[fid]);
+n=(int)strlen(test);
+while(n>0 && test[n-1]==' ')
+        test[--n]='\0';
+calib_size(fid,&name,&value,0);
+sizes[0]='\0';
+nsizes=get_sizes(fid,names,values);
+for(i=0;i<nsizes;i++)
+        if(strcmp(names[i],name)!=0)
+                sprintf(sizes+strlen(sizes),"%s%s=%lu",
+                        sizes[0]!='\0' ? " " : "",names[i],values[i]);
+
+for(i=0;i<calib_count;i++)
+        if(strcmp(calib_entries[i].test,test)==0 &&
+          strcmp(calib_entries[i].key,calib_key)==0 &&
+          strcmp(calib_entries[i].sizes,sizes)==0)
+                return(i);
+return(-1);
+}
+
+/****************
+** calib_below **
+*****************
+** The size one step of the self-adjustment of test fid below
+** value, or 0 if value is where the self-adjustment starts.
+*/
+static ulong calib_below(int fid, ulong value)
+{
+ulong first, step;
+
+switch(fid)
+{       case TF_BITOP:
+        case TF_BITOPECALL:
+        case TF_BITOPWORD:
+                first=30L; step=100L;
+                break;
+        case TF_FPEMU:
+        case TF_FPEMUWIDE:
+        case TF_FPEMUSORT:
+                return(value/2L);       /* Doubles from 1 */
+        case TF_FFPU:
+        case TF_FOURSIMD:
+                first=100L; step=50L;
+                break;
+        case TF_IDEA:
+        case TF_IDEASIMD:
+        case TF_HUFF:
+        case TF_HUFFTABLE:
+                first=100L; step=10L;
+                break;
+        default:                        /* Sorts, Assignment, NNet, LU */
+                first=1L; step=1L;
+                break;
+}
+return(value>=first+step ? value-step : 0L);
+}
+
+/****************
+** calib_apply **
+*****************
+** Before test fid runs: if it is to self-adjust and the
+** cache has its size for this machine and build, set the
+** size one step below it and mark it ADJUST_CACHED, for
+** calib_stale() to check.  *cached is the cached size, or
+** -1.  Returns 1 if the test self-adjusts this run, from the
+** cache or not, and 0 if its sizes are fixed.
+*/
+static int calib_apply(int fid, long *cached)
+{
+char sizes[256];
+char *name;
+ulong value;
+int *adjust;
+int i;
+
+*cached=-1L;
+if(global_calibcache[0]=='\0')
+        return(0);
+adjust=calib_size(fid,&name,&value,0);
+if(adjust==NULL || *adjust!=0)
+        return(0);
+i=calib_find(fid,sizes);
+if(i<0 || calib_entries[i].value==0 ||
+  strcmp(calib_entries[i].name,name)!=0)
+        return(1);
+
+*cached=(long)calib_entries[i].value;
+calib_hits++;
+value=calib_below(fid,calib_entries[i].value);
+if(value==0L)                   /* Cached the first size */
+        return(1);
+calib_size(fid,&name,&value,1);
+*adjust=ADJUST_CACHED;
+return(1);
+}
+
+/****************
+** calib_stale **
+*****************
+** The self-adjustment of a test calls this with the ticks of
+** each iteration.  From a cached size, the first iteration
+** is one step below it, and must take no more than
+** global_min_ticks: if it does, the machine got slower or the
+** cache is off, and this returns 1 so the test starts over
+** from its first size.  Otherwise, and for any later
+** iteration, it returns 0.  Clears ADJUST_CACHED in *adjust.
+*/
+int calib_stale(int *adjust, ulong ticks)
+{
+if(*adjust!=ADJUST_CACHED)
+        return(0);
+*adjust=0;
+return(ticks>global_min_ticks);
+}
+
+/****************
+** calib_store **
+*****************
+** After test fid has self-adjusted, keep the size it settled
+** on in the cache, under calib_key.
+*/
+static void calib_store(int fid)
+{
+char sizes[256];
+char *name;
+ulong value;
+CalibEntry *e;
+int i, n;
+
+if(calib_size(fid,&name,&value,0)==NULL)
+        return;
+i=calib_find(fid,sizes);
+if(i>=0)
+{       e=&calib_entries[i];
+        if(e->value==value && strcmp(e->name,name)==0)
+                return;
+}
+else
+{       if(calib_count==CALIBMAXENTRIES)
+                return;
+        e=&calib_entries[calib_count++];
+        strcpy(e->test,ftestnames[fid]);
+        n=(int)strlen(e->test);
+        while(n>0 && e->test[n-1]==' ')
+                e->test[--n]='\0';
+        strcpy(e->key,calib_key);
+        strcpy(e->sizes,sizes);
+}
+strcpy(e->name,name);
+e->value=value;
+calib_changed=1;
+return;
+}
+
+/********************
+** load_calibcache **
+*********************
+** Read every entry of a CALIBCACHE file, for whatever
+** machine and build, so that writing it back keeps them.
+** A file that is not there yet is fine: the tests calibrate
+** as usual and the file is written at the end.
+*/
+static void load_calibcache(char *filename)
+{
+FILE *fp;
+static char line[2*CALIBKEYSIZ];
+char *p, *field[4];
+char *eq;
+CalibEntry *e;
+int j;
+
+calib_count=0;
+fp=fopen(filename,"r");
+if(fp==(FILE *)NULL)
+        return;
+
+/*
+** Skip the header; each row is test, key, the other sizes
+** and name=value of the size that was settled.
+*/
+fgets(line,sizeof(line),fp);
+while(calib_count<CALIBMAXENTRIES && fgets(line,sizeof(line),fp)!=NULL)
+{       p=line;
+        for(j=0;j<4 && p!=NULL;j++)
+                field[j]=csv_field(&p);
+        if(j<4 || (eq=strchr(field[3],'='))==NULL)
+                continue;
+        *eq++='\0';
+        if(strlen(field[0])>=sizeof(e->test) ||
+          strlen(field[1])>=sizeof(e->key) ||
+          strlen(field[2])>=sizeof(e->sizes) ||
+          strlen(field[3])>=sizeof(e->name))
+                continue;
+        e=&calib_entries[calib_count++];
+        strcpy(e->test,field[0]);
+        strcpy(e->key,field[1]);
+        strcpy(e->sizes,field[2]);
+        strcpy(e->name,field[3]);
+        e->value=(ulong)strtoul(eq,NULL,10);
+}
+fclose(fp);
+return;
+}
+
+/*********************
+** write_calibcache **
+**********************
+** Write the calibration cache back, with what this run
+** added or changed.
+*/
+static void write_calibcache(char *filename)
+{
+FILE *fp;
+CalibEntry *e;
+int i;
+
+fp=fopen(filename,"w");
+if(fp==(FILE *)NULL)
+{       printf("**Error opening calibration cache: %s\n",filename);
+        return;
+}
+fprintf(fp,"test,key,sizes,size\n");
+for(i=0;i<calib_count;i++)
+{       e=&calib_entries[i];
+        fprintf(fp,"\"%s\",\"%s\",\"%s\",%s=%lu\n",
+                e->test,e->key,e->sizes,e->name,e->value);
+}
+fclose(fp);
+return;
+}
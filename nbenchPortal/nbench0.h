@@ -76,8 +76,51 @@ char *compilerversion="Have a nice day";
 #define PF_LUNARRAYS 39         /* LUNUMARRAYS */
 #define PF_LUMINS 40            /* LUMINSECONDS */
 #define PF_ALIGN 41		        /* ALIGN */
+#define PF_DOBITFECALL 42       /* DOBITFIELDECALL */
+#define PF_DOTRANS 43           /* DOTRANSITION */
+#define PF_TRANSSAMPLES 44      /* TRANSSAMPLES */
+#define PF_TRANSTHREADS 45      /* TRANSTHREADS */
+#define PF_TIMER 46             /* TIMER */
+#define PF_SWEEP 47             /* SWEEP */
+#define PF_SWEEPMIN 48          /* SWEEPMINKB */
+#define PF_SWEEPMAX 49          /* SWEEPMAXKB */
+#define PF_JSONFILE 50          /* JSONFILE */
+#define PF_CSVFILE 51           /* CSVFILE */
+#define PF_BASELINE 52          /* BASELINE */
+#define PF_REGRESSION 53        /* REGRESSION */
+#define PF_DOIDEASIMD 54        /* DOIDEASIMD */
+#define PF_DOSTREAM 55          /* DOSTREAM */
+#define PF_STREAMMB 56          /* STREAMMB */
+#define PF_STREAMMIN 57         /* STREAMMINKB */
+#define PF_STREAMMAX 58         /* STREAMMAXKB */
+#define PF_DOHUFFTABLE 59       /* DOHUFFTABLE */
+#define PF_DONUMSORTPAR 60      /* DONUMSORTPAR */
+#define PF_SORTWORKERS 61       /* SORTWORKERS */
+#define PF_SORTALGO 62          /* SORTALGO */
+#define PF_DOSTRKEY 63          /* DOSTRINGSORTKEY */
+#define PF_DOBITFWORD 64        /* DOBITFIELDWORD */
+#define PF_BITKERNEL 65         /* BITKERNEL */
+#define PF_DOLUBLOCK 66         /* DOLUBLOCKED */
+#define PF_LUSIZE 67            /* LUSIZE */
+#define PF_LUBLOCK 68           /* LUBLOCK */
+#define PF_LUKERNEL 69          /* LUKERNEL */
+#define PF_DOFOURSIMD 70        /* DOFOURIERSIMD */
+#define PF_FOURWORKERS 71       /* FOURIERWORKERS */
+#define PF_DONNETMLP 72         /* DONNETMLP */
+#define PF_MLPIN 73             /* MLPIN */
+#define PF_MLPHIDDEN 74         /* MLPHIDDEN */
+#define PF_MLPOUT 75            /* MLPOUT */
+#define PF_MLPPATS 76           /* MLPPATTERNS */
+#define PF_MLPBATCH 77          /* MLPBATCH */
+#define PF_DOASSIGNJV 78        /* DOASSIGNJV */
+#define PF_ASSIGNSIZE 79        /* ASSIGNSIZE */
+#define PF_DOEMFWIDE 80         /* DOEMFWIDE */
+#define PF_DOEMFSORTED 81       /* DOEMFSORTED */
+#define PF_EMFWORKERS 82        /* EMFWORKERS */
+#define PF_ARENAKB 83           /* ARENAKB */
+#define PF_CALIBCACHE 84        /* CALIBCACHE */
 
-#define MAXPARAM 41
+#define MAXPARAM 84
 
 /* Tests-to-do flags...must coincide with test. */
 #define TF_NUMSORT 0
@@ -90,8 +133,26 @@ char *compilerversion="Have a nice day";
 #define TF_HUFF 7
 #define TF_NNET 8
 #define TF_LU 9
+#define TF_BITOPECALL 10
+#define TF_IDEASIMD 11
+#define TF_HUFFTABLE 12
+#define TF_NUMSORTPAR 13
+#define TF_SSORTKEY 14
+#define TF_BITOPWORD 15
+#define TF_LUBLOCK 16
+#define TF_FOURSIMD 17
+#define TF_NNETMLP 18
+#define TF_ASSIGNJV 19
+#define TF_FPEMUWIDE 20
+#define TF_FPEMUSORT 21
 
+/*
+** NUMTESTS is the number of tests that make up the indexes.
+** Tests from NUMTESTS up to NUMALLTESTS are variants of one
+** of those and are reported on their own line, without an index.
+*/
 #define NUMTESTS 10
+#define NUMALLTESTS 22
 
 /*
 ** GLOBALS
@@ -112,7 +173,48 @@ char *ftestnames[] = {
         "IDEA            ",
         "HUFFMAN         ",
         "NEURAL NET      ",
-        "LU DECOMPOSITION" };
+        "LU DECOMPOSITION",
+        "BITFIELD (ECALL)",
+        "IDEA (SIMD)     ",
+        "HUFFMAN (TABLE) ",
+        "NUMSORT (PAR)   ",
+        "STRSORT (KEY)   ",
+        "BITFIELD (WORD) ",
+        "LU (BLOCKED)    ",
+        "FOURIER (SIMD)  ",
+        "NEURAL NET (MLP)",
+        "ASSIGNMENT (JV) ",
+        "FP EMU (WIDE)   ",
+        "FP EMU (SORTED) " };
+
+/*
+** Names of the SIMD_xxx kernels of IDEA (SIMD)
+*/
+char *simdnames[] = {
+        "SSE2",
+        "AVX2",
+        "AVX-512BW" };
+
+/*
+** Names of the SORT_xxx algorithms of Numeric Sort (PAR)
+*/
+char *sortalgonames[] = {
+        "heapsort",
+        "LSD radix" };
+
+/*
+** Names of the BITKERNEL_xxx kernels of Bitfield (WORD)
+*/
+char *bitkernelnames[] = {
+        "64-bit words",
+        "AVX2" };
+
+/*
+** Names of the LUKERNEL_xxx kernels of LU (BLOCKED)
+*/
+char *lukernelnames[] = {
+        "classic (Crout)",
+        "blocked" };
 
 /*
 ** Indexes -- Baseline is DELL Pentium XP90
@@ -190,13 +292,56 @@ char *paramnames[]= {
         "DOLU",
         "LUNUMARRAYS",
         "LUMINSECONDS",
-	"ALIGN" };
+	"ALIGN",
+        "DOBITFIELDECALL",
+        "DOTRANSITION",
+        "TRANSSAMPLES",
+        "TRANSTHREADS",
+        "TIMER",
+        "SWEEP",
+        "SWEEPMINKB",
+        "SWEEPMAXKB",
+        "JSONFILE",
+        "CSVFILE",
+        "BASELINE",
+        "REGRESSION",
+        "DOIDEASIMD",
+        "DOSTREAM",
+        "STREAMMB",
+        "STREAMMINKB",
+        "STREAMMAXKB",
+        "DOHUFFTABLE",
+        "DONUMSORTPAR",
+        "SORTWORKERS",
+        "SORTALGO",
+        "DOSTRINGSORTKEY",
+        "DOBITFIELDWORD",
+        "BITKERNEL",
+        "DOLUBLOCKED",
+        "LUSIZE",
+        "LUBLOCK",
+        "LUKERNEL",
+        "DOFOURIERSIMD",
+        "FOURIERWORKERS",
+        "DONNETMLP",
+        "MLPIN",
+        "MLPHIDDEN",
+        "MLPOUT",
+        "MLPPATTERNS",
+        "MLPBATCH",
+        "DOASSIGNJV",
+        "ASSIGNSIZE",
+        "DOEMFWIDE",
+        "DOEMFSORTED",
+        "EMFWORKERS",
+        "ARENAKB",
+        "CALIBCACHE" };
 
 /*
 ** Following array is a collection of flags indicating which
 ** tests to perform.
 */
-int tests_to_do[NUMTESTS];
+int tests_to_do[NUMALLTESTS];
 
 /*
 ** Buffer for holding output text.
@@ -214,6 +359,117 @@ FILE *global_ofile;             /* Output file */
 int global_custrun;             /* Custom run flag */
 int write_to_file;              /* Write output to file */
 int global_align;		/* Memory alignment */
+int global_timer;               /* Stopwatch (TIMER_xxx) */
+int global_threads;             /* # of threads per test (-threads=N) */
+int global_diff;                /* Also run natively (-diff) */
+ulong global_arenakb;           /* KB of each thread's arena, 0 for none */
+int global_simd;                /* SIMD_xxx of IDEA (SIMD) */
+char global_jsonfile[BUF_SIZ];  /* JSON results file, or "" */
+char global_csvfile[BUF_SIZ];   /* CSV results file, or "" */
+
+/*
+** Every score of one bench_with_confidence() call, which
+** collects at most MAXSCORES.
+*/
+#define MAXSCORES 30
+
+typedef struct {
+        int numscores;          /* # of scores */
+        double scores[MAXSCORES];       /* In the order they were run */
+        double mean;
+        double stdev;
+        double halfint;         /* 95% confidence half-interval */
+        int uncertain;          /* Gave up before halfint was small */
+} ScoreSet;
+
+ScoreSet last_scores;           /* Left by bench_with_confidence() */
+
+/*
+** What each test came up with, for the JSON and CSV files.
+*/
+typedef struct {
+        int done;               /* Test was run */
+        ScoreSet enclave;       /* Scores in the enclave */
+        ScoreSet native;        /* Scores natively (-diff) */
+} TestResult;
+
+TestResult test_results[NUMALLTESTS];
+
+/*
+** With ARENAKB, the handle of each thread's arena for the
+** test being run, -1 for none.
+*/
+int arena_handle[MAXTHREADS];
+int arena_test;                 /* Test being run, for alloc_failed() */
+
+/*
+** Baseline comparison: a CSVFILE from an earlier run, and
+** how much slower (%) a test may get before the run fails.
+*/
+#define REGRESSIONPCT 5.0
+#define SIGNIFICANCE 0.05       /* p-value below this is real */
+
+char global_baseline[BUF_SIZ];  /* Baseline CSV file, or "" */
+double global_regression;       /* Allowed slowdown, % */
+ScoreSet baseline_scores[NUMALLTESTS];  /* numscores 0 if absent */
+
+/*
+** Differential run: each test's enclave and native scores.
+*/
+typedef struct {
+        int done;               /* Test was run both ways */
+        double enclave;         /* Mean score in the enclave */
+        double enclstdev;       /* ...its standard deviation */
+        ulong enclruns;         /* ...and # of runs */
+        double native;          /* Same, run natively */
+        double natstdev;
+        ulong natruns;
+        double ratio;           /* Slowdown, native/enclave */
+        double lo, hi;          /* 95% confidence interval of ratio */
+} DiffResult;
+
+DiffResult diff_results[NUMALLTESTS];
+
+/*
+** Calibration cache (CALIBCACHE=): the size each test's
+** self-adjustment settled on, for each machine and build
+** the file has seen.  The key names the CPU, its microcode,
+** the SGX mode, transitions and timer, and a hash of the
+** App and the enclave; sizes holds the test's other sizes,
+** which must match too.
+*/
+#define CALIBMAXENTRIES 256
+#define CALIBKEYSIZ (BUF_SIZ+256)
+
+typedef struct {
+        char test[32];          /* Test name without padding */
+        char key[CALIBKEYSIZ];
+        char sizes[256];        /* The other sizes, as in CSVFILE */
+        char name[32];          /* Size self-adjustment sets */
+        ulong value;            /* ...and what it set it to */
+} CalibEntry;
+
+char global_calibcache[BUF_SIZ];        /* Calibration cache, or "" */
+char calib_key[CALIBKEYSIZ];    /* Of this machine and build */
+CalibEntry calib_entries[CALIBMAXENTRIES];
+int calib_count;                /* Entries in calib_entries[] */
+int calib_changed;              /* Write the file at the end */
+int calib_hits;                 /* Tests started from the cache */
+
+/*
+** With -threads=N, the sum of each thread's scores over the
+** runs of the current test, and what each thread is given.
+*/
+double thread_score[MAXTHREADS];
+pthread_barrier_t thread_barrier;       /* Starts the threads together */
+
+typedef struct {
+        int fid;                /* Test to run */
+        int slot;               /* Enclave state slot */
+        void *config;           /* Test structure to start from */
+        size_t size;            /* Its size */
+        double score;           /* Score of this thread */
+} TestThread;
 
 /*
 ** Following global is the memory array.  This is used to store
@@ -224,36 +480,34 @@ int mem_array_ents;		/* # of active entries */
 
 /*
 ** Following are global structures, one built for
-** each of the tests.
-*/
-SortStruct global_numsortstruct;        /* For numeric sort */
-SortStruct global_strsortstruct;        /* For string sort */
-BitOpStruct global_bitopstruct;         /* For bitfield operations */
-EmFloatStruct global_emfloatstruct;     /* For emul. float. point */
-FourierStruct global_fourierstruct;     /* For fourier test */
-AssignStruct global_assignstruct;       /* For assignment algorithm */
-IDEAStruct global_ideastruct;           /* For IDEA encryption */
-HuffStruct global_huffstruct;           /* For Huffman compression */
-NNetStruct global_nnetstruct;           /* For Neural Net */
-LUStruct global_lustruct;               /* For LU decomposition */
-
-/*
-** The following array of function struct pointers lets
-** us very rapidly map a function to its controlling
-** data structure. NOTE: These must match the "TF_xxx"
-** constants above.
+** each of the tests.  With -threads=N every thread
+** has its own copy.
 */
-void *global_fstruct[] =
-{       (void *)&global_numsortstruct,
-        (void *)&global_strsortstruct,
-        (void *)&global_bitopstruct,
-        (void *)&global_emfloatstruct,
-        (void *)&global_fourierstruct,
-        (void *)&global_assignstruct,
-        (void *)&global_ideastruct,
-        (void *)&global_huffstruct,
-        (void *)&global_nnetstruct,
-        (void *)&global_lustruct };
+THREADLOCAL SortStruct global_numsortstruct;        /* For numeric sort */
+THREADLOCAL SortStruct global_strsortstruct;        /* For string sort */
+THREADLOCAL BitOpStruct global_bitopstruct;         /* For bitfield operations */
+THREADLOCAL BitOpStruct global_bitopecallstruct;    /* For bitfield, ECALL per run */
+THREADLOCAL BitOpStruct global_bitopwordstruct;     /* For bitfield, word at a time */
+THREADLOCAL LUBlockStruct global_lublockstruct;     /* For LU, blocked */
+THREADLOCAL FourierStruct global_fouriersimdstruct; /* For Fourier, vector math */
+TransStruct global_transstruct;         /* For ECALL/OCALL transitions */
+SweepStruct global_sweepstruct;         /* For the EPC-pressure sweep */
+StreamStruct global_streamstruct;       /* For streaming IDEA */
+THREADLOCAL EmFloatStruct global_emfloatstruct;     /* For emul. float. point */
+THREADLOCAL EmFloatStruct global_emfloatwidestruct; /* For emul. f. p., 64-bit */
+THREADLOCAL EmFloatStruct global_emfloatsortstruct; /* For emul. f. p., sorted */
+THREADLOCAL FourierStruct global_fourierstruct;     /* For fourier test */
+THREADLOCAL AssignStruct global_assignstruct;       /* For assignment algorithm */
+THREADLOCAL AssignJVStruct global_assignjvstruct;   /* For assignment, JV */
+THREADLOCAL IDEAStruct global_ideastruct;           /* For IDEA encryption */
+THREADLOCAL IDEAStruct global_ideasimdstruct;       /* For IDEA, vectorized */
+THREADLOCAL HuffStruct global_huffstruct;           /* For Huffman compression */
+THREADLOCAL HuffStruct global_hufftablestruct;      /* For Huffman, canonical coder */
+THREADLOCAL SortStruct global_numsortparstruct;     /* For numeric sort, sort pool */
+THREADLOCAL SortStruct global_strsortkeystruct;     /* For string sort, prefix keys */
+THREADLOCAL NNetStruct global_nnetstruct;           /* For Neural Net */
+THREADLOCAL MLPStruct global_mlpstruct;             /* For Neural Net, batched */
+THREADLOCAL LUStruct global_lustruct;               /* For LU decomposition */
 
 /*
 ** Following globals added to support command line emulation on
@@ -299,8 +553,16 @@ static int parse_arg(char *argptr);
 static void display_help(char *progname);
 static void read_comfile(FILE *cfile);
 static int getflag(char *cptr);
+static int gettimer(char *cptr);
+static int getsweep(char *cptr);
+static int getsortalgo(char *cptr);
+static int getbitkernel(char *cptr);
+static int getlukernel(char *cptr);
+static ulong getmlpsize(char *cptr);
+static double mlp_bytes(void);
 static void strtoupper(char *s);
 static void set_request_secs(void);
+static int simd_level(void);
 static int bench_with_confidence(int fid,
         double *mean, double *stdev, ulong *numtries);
 /*
@@ -313,8 +575,44 @@ static int calc_confidence(double scores[],
         double *c_half_interval,double *smean,
         double *sdev);
 static double getscore(int fid);
+static void *getstruct(int fid, size_t *size);
+static double run_test(int fid);
+static void *test_thread(void *arg);
+static void arena_open(void);
+static void arena_enter(int slot);
+static size_t arena_close(void);
+void alloc_failed(void);
 static void output_string(char *buffer);
 static void show_stats(int bid);
+static void show_transitions(void);
+static void diff_ratio(DiffResult *result);
+static void show_differential(void);
+static void show_sweep(void);
+static void show_stream(void);
+static void keep_scores(double scores[], int num_scores,
+        double c_half_interval, double mean, double stdev,
+        int uncertain);
+static int get_sizes(int fid, char *names[], ulong sizes[]);
+static void write_json(char *filename);
+static void write_csv(char *filename);
+static void json_string(FILE *fp, char *s);
+static void json_scoreset(FILE *fp, ScoreSet *set);
+static void load_baseline(char *filename);
+static char *csv_field(char **line);
+static int compare_baseline(void);
+static int make_calib_key(void);
+static void hash_file(const char *name, unsigned long long *hash);
+static int *calib_size(int fid, char **name, ulong *value, int set);
+static int calib_find(int fid, char *sizes);
+static ulong calib_below(int fid, ulong value);
+static int calib_apply(int fid, long *cached);
+int calib_stale(int *adjust, ulong ticks);
+static void calib_store(int fid);
+static void load_calibcache(char *filename);
+static void write_calibcache(char *filename);
+static double welch_test(ScoreSet *a, ScoreSet *b);
+static double incbeta(double a, double b, double x);
+static double betacf(double a, double b, double x);
 
 #ifdef MAC
 void UCommandLine(void);
@@ -335,8 +633,44 @@ extern void DoIDEA(void);
 extern void DoHuffman(void);
 extern void DoNNET(void);
 extern void DoLU(void);
+extern void DoBitopsECALL(void);
+extern void DoIDEASIMD(void);
+extern void DoHuffmanTable(void);
+extern void DoNumSortPar(void);
+extern void DoStringSortKey(void);
+extern void DoBitopsWord(void);
+extern void DoLUBlocked(void);
+extern void DoFourierSIMD(void);
+extern void DoNNetMLP(void);
+extern void DoAssignJV(void);
+extern void DoEmFloatWide(void);
+extern void DoEmFloatSorted(void);
+extern void DoTransitions(void);        /* From TRANSBENCH */
+extern void DoSweep(void);              /* From SWEEPBENCH */
+extern void DoStream(void);             /* From STREAMBENCH */
 
 extern void ErrorExit(void);    /* From SYSSPEC */
+#ifdef TIMERSELECT
+extern int SelectStopwatch(int timer);
+extern char *StopwatchName(void);
+extern double StopwatchResolution(void);
+extern unsigned long SecsToTicks(double secs);
+#endif
+
+extern int app_thread_bind(int slot);   /* From App */
+extern int app_native;
+extern int app_native_load(void);
+extern int app_sweep_enclave(void);
+extern const char *app_sgx_mode;
+extern int app_switchless;
+extern unsigned int app_switchless_tworkers;
+extern unsigned int app_switchless_uworkers;
+extern int app_arena_create(size_t size);
+extern int app_arena_use(int h);
+extern int app_arena_reset(int h);
+extern size_t app_arena_peak(int h);
+extern void app_arena_destroy(int h);
+extern const char *app_enclave_file(void);
 
 /*
 ** Array of pointers to the benchmark functions.
@@ -351,6 +685,18 @@ void (*funcpointer[])(void) =
         DoIDEA,
         DoHuffman,
         DoNNET,
-        DoLU };
+        DoLU,
+        DoBitopsECALL,
+        DoIDEASIMD,
+        DoHuffmanTable,
+        DoNumSortPar,
+        DoStringSortKey,
+        DoBitopsWord,
+        DoLUBlocked,
+        DoFourierSIMD,
+        DoNNetMLP,
+        DoAssignJV,
+        DoEmFloatWide,
+        DoEmFloatSorted };
 
 
@@ -60,6 +60,7 @@
 #include <string.h>
 #include <strings.h>
 #include <math.h>
+#include <pthread.h>
 #include "nmglobal.h"
 #include "nbench1.h"
 #include "wordcat.h"
@@ -84,50 +85,88 @@ extern void app_FreeMemory2();
 extern void app_FreeMemory3();
 extern void app_FreeMemory4();
 extern void app_FreeMemory5();
+extern int app_buf_create(size_t size, size_t align);
+extern int app_buf_bind(int k, int h);
+extern void app_buf_destroy(int h);
+extern int app_buf_alloc(size_t size, size_t align);
 
 //Numsort test
 extern void app_LoadNumArrayWithRand(unsigned long arraysize, unsigned int numarrays);
 extern void app_NumHeapSort(unsigned long base_offset,unsigned long bottom, unsigned long top);
+extern int app_sortpool_start(unsigned long arraysize, int nparts, int algo);
+extern int app_sortpool_worker(int id, int part);
+extern int app_sortpool_run(unsigned long numarrays);
+extern void app_sortpool_stop(void);
+extern int app_NumSortCheck(unsigned long arraysize, unsigned long numarrays);
 
 //StringSort test
 extern unsigned long app_LoadStringArray(unsigned int numarrays, unsigned long arraysize);
 extern void app_StrHeapSort(unsigned long oparrayOffset, unsigned long strarrayOffset, unsigned long numstrings, unsigned long bottom, unsigned long top);
 extern void app_call_StrHeapSort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+extern int app_call_StrKeySort(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
+extern int app_StrSortCheck(unsigned long nstrings, unsigned int numarrays, unsigned long arraysize);
 
 //Floating Point test
 extern void app_SetupCPUEmFloatArrays(ulong arraysize);
+extern int app_SetupWideEmFloatArrays(ulong arraysize, int a, int b);
+extern int app_checkWideEmFloat(ulong arraysize, ulong loops);
+extern int app_SetupSortedEmFloatArrays(ulong arraysize, int a, int b, int c, int order);
+extern int app_emfloat_start(void);
+extern int app_emfloat_worker(int id);
+extern int app_emfloat_run(ulong arraysize, ulong loops, int a, int b, int c, int order);
+extern void app_emfloat_stop(void);
+extern int app_checkSortedEmFloat(ulong arraysize, ulong loops, int a, int b, int c);
 
 //BitSort
 extern unsigned long app_bitSetup(long bitfieldarraysize, long bitoparraysize);
 extern void app_ToggleBitRun(unsigned long bit_addr, unsigned long nbits, unsigned int val);
 extern void app_FlipBitRun(long bit_addr,long nbits);   
+extern void app_DoBitfieldIteration(long bitoparraysize);
+extern void app_DoBitfieldIterationWord(long bitoparraysize, int kernel);
+extern int app_checkBitfieldWord(long bitfieldarraysize, long bitoparraysize, int kernel);
 
 //Fourier
+extern int app_fourier_start(int level);
+extern int app_fourier_worker(int id);
+extern int app_fourier_run(unsigned long arraysize, int a, int b);
+extern void app_fourier_stop(void);
+extern int app_fourier_check(unsigned long arraysize, int a, int b);
 extern void app_DoFPUTransIteration(unsigned long arraysize);
 
 //Assignment
 extern void app_LoadAssignArrayWithRand(unsigned long numarrays);
 extern void app_call_AssignmentTest(unsigned int numarrays);
+extern int app_assign_build(long n, int costs);
+extern long app_assign_solve(long n, int costs, int duals, int perm, int scratch);
+extern int app_assign_check(long n, long cost, int costs, int duals, int perm);
 
 /*IDEAsort*/
 extern void app_loadIDEA(unsigned long arraysize);
 extern void app_callIDEA(unsigned long arraysize, unsigned short* Z, unsigned short* DK, unsigned long nloops);
+extern void app_callIDEAsimd(unsigned long arraysize, unsigned short* Z, unsigned short* DK, unsigned long nloops, int level);
+extern int app_checkIDEAsimd(unsigned long arraysize, unsigned short* Z, unsigned short* DK, int level);
 
 /*Neural Net*/
-extern void app_set_numpats(int npats);
-extern double app_get_in_pats(int patt, int element);
-extern void app_set_in_pats(int patt, int element, double val);
-extern void app_set_out_pats(int patt, int element, double val);
+extern int app_load_pats(int npats, const double *pats, size_t count);
 extern void app_DoNNetIteration(unsigned long nloops);
+extern int app_mlp_setup(long in, long hid, long out, long npats, long batch);
+extern void app_mlp_train(unsigned long nepochs, int level);
+extern int app_mlp_check(int level);
+extern void app_mlp_free(void);
 
 /*LU Decomposition*/
 extern void app_build_problem();
 extern void app_moveSeedArrays(unsigned long numarrays);
 extern void app_call_lusolve(unsigned long numarrays);
+extern int app_lu_build(long n, int seed, int rhs);
+extern int app_lu_reset(long n, int seed, int work);
+extern int app_lu_factor(long n, long nb, int kernel, int level, int work, int indx, int scratch);
+extern int app_lu_check(long n, int seed, int rhs, int work, int indx, int scratch);
 
 /*Huffman Compression*/
 extern void app_buildHuffman(unsigned long arraysize);
 extern void app_callHuffman(unsigned long nloops, unsigned long arraysize);
+extern int app_callHuffmanTable(unsigned long nloops, unsigned long arraysize);
 
 /********************************************/
 /*********************
@@ -148,29 +187,87 @@ extern void app_callHuffman(unsigned long nloops, unsigned long arraysize);
 
 void DoNumSort(void)
 {
-SortStruct *numsortstruct;      /* Local pointer to global struct */
+DoNumSortMode(&global_numsortstruct,0);
+return;
+}
+
+/*****************
+** DoNumSortPar **
+******************
+** Numeric sort with all the arrays sorted in one ECALL by
+** numsortstruct->workers threads in the enclave, with the
+** algorithm of numsortstruct->algo.  Reported on its own
+** line next to DoNumSort().
+*/
+void DoNumSortPar(void)
+{
+DoNumSortMode(&global_numsortparstruct,1);
+return;
+}
+
+/******************
+** DoNumSortMode **
+*******************
+** Body of the numeric sort test.  par selects the sort pool:
+** its helpers enter the enclave before the self-adjustment
+** and leave it after the timed runs, and the arrays are
+** checked once the test is done.
+*/
+static void DoNumSortMode(SortStruct *numsortstruct, int par)
+{
 farlong *arraybase;     /* Base pointers of array */
 long accumtime;         /* Accumulated time */
 double iterations;      /* Iteration counter */
 char *errorcontext;     /* Error context string pointer */
 int systemerror;        /* For holding error codes */
+ulong ticks;            /* Ticks of an adjustment iteration */
+pthread_t helpers[SORTMAXWORKERS];      /* Sort pool helpers */
+SortHelperJob jobs[SORTMAXWORKERS];
+int started[SORTMAXWORKERS];
+int nstarted;           /* Helpers that were created */
+int pool;               /* Sort pool id */
+int i;
 //memory errors handle inside of the enclave
 systemerror=0;
 
 /*
-** Link to global structure
+** Set the error context string.
 */
-numsortstruct=&global_numsortstruct;
+errorcontext=par ? "CPU:Numeric Sort (PAR)" : "CPU:Numeric Sort";
 
 /*
-** Set the error context string.
+** Start the sort pool.  A helper that cannot be created, or
+** finds no free TCS, gives up, and the others steal its
+** share.  With no helper at all, the pool is set up again
+** for the caller alone, which then sorts every array.
 */
-errorcontext="CPU:Numeric Sort";
+if(par)
+{       pool=app_sortpool_start(numsortstruct->arraysize,
+		numsortstruct->workers,numsortstruct->algo);
+	if(pool<0)
+	{       printf("%s -- cannot set up the sort pool\n",errorcontext);
+		ErrorExit();
+	}
+	nstarted=0;
+	for(i=1;i<numsortstruct->workers;i++)
+	{       jobs[i].pool=pool;
+		jobs[i].part=i;
+		started[i]=pthread_create(&helpers[i],NULL,SortHelper,
+			&jobs[i])==0;
+		nstarted+=started[i];
+	}
+	if(nstarted==0 && numsortstruct->workers>1 &&
+	  app_sortpool_start(numsortstruct->arraysize,1,
+	  numsortstruct->algo)<0)
+	{       printf("%s -- cannot set up the sort pool\n",errorcontext);
+		ErrorExit();
+	}
+}
 
 /*
 ** See if we need to do self adjustment code.
 */
-if(numsortstruct->adjust==0)
+if(numsortstruct->adjust!=1)
 {
 	/*
 	** Self-adjustment code.  The system begins by sorting 1
@@ -178,7 +275,8 @@ if(numsortstruct->adjust==0)
 	** are built and sorted.  This process continues until
 	** enough arrays are built to handle the tolerance.
 	*/
-	numsortstruct->numarrays=1;
+	if(numsortstruct->adjust==0)
+		numsortstruct->numarrays=1;
 	while(1)
 	{
 		/*
@@ -191,11 +289,18 @@ if(numsortstruct->adjust==0)
 		** Do an iteration of the numeric sort.  If the
 		** elapsed time is less than or equal to the permitted
 		** minimum, then allocate for more arrays and
-		** try again.
+		** try again.  A stale cached size starts over.
 		*/
-		if(DoNumSortIteration(arraybase,
+		ticks=DoNumSortIteration(arraybase,
 			numsortstruct->arraysize,
-			numsortstruct->numarrays)>global_min_ticks)
+			numsortstruct->numarrays,
+			par);
+		if(calib_stale(&numsortstruct->adjust,ticks))
+		{       app_FreeMemory();
+			numsortstruct->numarrays=1;
+			continue;
+		}
+		if(ticks>global_min_ticks)
 			break;          /* We're ok...exit */
 
 		app_FreeMemory(/*(farvoid *)arraybase,&systemerror*/);
@@ -221,7 +326,8 @@ iterations=(double)0.0;
 do {
 	accumtime+=DoNumSortIteration(arraybase,
 		numsortstruct->arraysize,
-		numsortstruct->numarrays);
+		numsortstruct->numarrays,
+		par);
 	iterations+=(double)1.0;
 } while(TicksToSecs(accumtime)<numsortstruct->request_secs);
 
@@ -229,12 +335,23 @@ do {
 ** Clean up, calculate results, and go home.  Be sure to
 ** show that we don't have to rerun adjustment code.
 */
+if(par)
+{       app_sortpool_stop();
+	for(i=1;i<numsortstruct->workers;i++)
+		if(started[i])
+			pthread_join(helpers[i],NULL);
+	if(app_NumSortCheck(numsortstruct->arraysize,
+		numsortstruct->numarrays)!=0)
+	{       printf("%s -- arrays are not in order\n",errorcontext);
+		ErrorExit();
+	}
+}
 app_FreeMemory();
 
 numsortstruct->sortspersec=iterations *
 	(double)numsortstruct->numarrays / TicksToFracSecs(accumtime);
 
-if(numsortstruct->adjust==0)
+if(numsortstruct->adjust!=1)
 	numsortstruct->adjust=1;
 return;
 }
@@ -244,11 +361,13 @@ return;
 ************************
 ** This routine executes one iteration of the numeric
 ** sort benchmark.  It returns the number of ticks
-** elapsed for the iteration.
+** elapsed for the iteration.  par sorts all the arrays
+** with the sort pool, in one ECALL.
 */
 static ulong DoNumSortIteration(farlong *arraybase,
 		ulong arraysize,
-		uint numarrays)
+		uint numarrays,
+		int par)
 {
 ulong elapsed;          /* Elapsed ticks */
 ulong i;
@@ -267,8 +386,15 @@ elapsed=StartStopwatch();
 */
 
 //This is where the function call would happen to the enclave
-for(i=0;i<numarrays;i++)
-	app_NumHeapSort(i*arraysize,0L,arraysize-1L);
+if(par)
+{       if(app_sortpool_run(numarrays)!=0)
+	{       printf("CPU:Numeric Sort (PAR) -- sort pool failed\n");
+		ErrorExit();
+	}
+}
+else
+	for(i=0;i<numarrays;i++)
+		app_NumHeapSort(i*arraysize,0L,arraysize-1L);
 
 /*
 ** Get elapsed time
@@ -277,6 +403,21 @@ elapsed=StopStopwatch(elapsed);
 return(elapsed);
 }
 
+/***************
+** SortHelper **
+****************
+** Thread body of a sort pool helper: one ECALL that lasts
+** until app_sortpool_stop().
+*/
+static void *SortHelper(void *arg)
+{
+SortHelperJob *job;
+
+job=(SortHelperJob *)arg;
+app_sortpool_worker(job->pool,job->part);
+return(NULL);
+}
+
 /********************
 ** STRING HEAPSORT **
 ********************/
@@ -291,34 +432,56 @@ return(elapsed);
 */
 void DoStringSort(void)
 {
+DoStringSortMode(&global_strsortstruct,0);
+return;
+}
+
+/********************
+** DoStringSortKey **
+*********************
+** String sort on 16-byte elements of key prefix and offset,
+** sorted contiguously, with the strings laid out once at the
+** end (encl_call_StrKeySort).  Same arrays and order as
+** DoStringSort(), reported on its own line next to it.
+*/
+void DoStringSortKey(void)
+{
+DoStringSortMode(&global_strsortkeystruct,1);
+return;
+}
 
-SortStruct *strsortstruct;      /* Local for sort structure */
+/*********************
+** DoStringSortMode **
+**********************
+** Body of the string sort test.  key selects the prefix-key
+** sort, whose arrays are checked after every iteration.
+*/
+static void DoStringSortMode(SortStruct *strsortstruct, int key)
+{
 faruchar *arraybase;            /* Base pointer of char array */
 long accumtime;                 /* Accumulated time */
 double iterations;              /* # of iterations */
 char *errorcontext;             /* Error context string pointer */
 int systemerror;                /* For holding error code */
+ulong ticks;                    /* Ticks of an adjustment iteration */
 //memory errors handle inside of the enclave
 systemerror=0;
-/*
-** Link to global structure
-*/
-strsortstruct=&global_strsortstruct;
 
 /*
 ** Set the error context
 */
-errorcontext="CPU:String Sort";
+errorcontext=key ? "CPU:String Sort (KEY)" : "CPU:String Sort";
 
 /*
 ** See if we have to perform self-adjustment code
 */
-if(strsortstruct->adjust==0)
+if(strsortstruct->adjust!=1)
 {
 	/*
 	** Initialize the number of arrays.
 	*/
-	strsortstruct->numarrays=1;
+	if(strsortstruct->adjust==0)
+		strsortstruct->numarrays=1;
 	while(1)
 	{
 		/*
@@ -334,12 +497,20 @@ if(strsortstruct->adjust==0)
 		** Do an iteration of the string sort.  If the
 		** elapsed time is less than or equal to the permitted
 		** minimum, then de-allocate the array, reallocate a
-		** an additional array, and try again.
+		** an additional array, and try again.  A stale cached
+		** size starts over.
 		*/
 
-		if(DoStringSortIteration(arraybase,
+		ticks=DoStringSortIteration(arraybase,
 			strsortstruct->numarrays,
-			strsortstruct->arraysize)>global_min_ticks)
+			strsortstruct->arraysize,
+			key);
+		if(calib_stale(&strsortstruct->adjust,ticks))
+		{       app_FreeMemory();
+			strsortstruct->numarrays=1;
+			continue;
+		}
+		if(ticks>global_min_ticks)
 			break;          /* We're ok...exit */
 
 				
@@ -369,7 +540,8 @@ iterations=(double)0.0;
 do {
 	accumtime+=DoStringSortIteration(arraybase,
 				strsortstruct->numarrays,
-				strsortstruct->arraysize);
+				strsortstruct->arraysize,
+				key);
 	iterations+=(double)strsortstruct->numarrays;
 } while(TicksToSecs(accumtime)<strsortstruct->request_secs);
 
@@ -379,7 +551,7 @@ do {
 */
 app_FreeMemory();
 strsortstruct->sortspersec=iterations / (double)TicksToFracSecs(accumtime);
-if(strsortstruct->adjust==0)
+if(strsortstruct->adjust!=1)
 	strsortstruct->adjust=1;
 return;
 }
@@ -390,10 +562,10 @@ return;
 ** This routine executes one iteration of the string
 ** sort benchmark.  It returns the number of ticks
 ** Note that this routine also builds the offset pointer
-** array.
+** array.  key selects the prefix-key sort.
 */
 static ulong DoStringSortIteration(faruchar *arraybase,
-		uint numarrays,ulong arraysize)
+		uint numarrays,ulong arraysize,int key)
 {
 farulong *optrarray;            /* Offset pointer array */
 unsigned long elapsed;          /* Elapsed ticks */ 
@@ -408,6 +580,8 @@ unsigned long tempsbase;            /* Temporary string base pointer */
 */
 
 nstrings = app_LoadStringArray(numarrays, arraysize);
+if(nstrings==0)
+	alloc_failed();
 
 /*
 ** Set temp base pointers...they will be modified as the
@@ -421,11 +595,23 @@ nstrings = app_LoadStringArray(numarrays, arraysize);
 elapsed=StartStopwatch();
 
 /*Execute heapsorts*/
-app_call_StrHeapSort(nstrings, numarrays, arraysize);
+if(key)
+{       if(app_call_StrKeySort(nstrings, numarrays, arraysize)!=0)
+	{       printf("CPU:String Sort (KEY) -- out of enclave memory\n");
+		ErrorExit();
+	}
+}
+else
+	app_call_StrHeapSort(nstrings, numarrays, arraysize);
 
 /*Record elapsed time*/
 elapsed=StopStopwatch(elapsed);
 
+if(key && app_StrSortCheck(nstrings, numarrays, arraysize)!=0)
+{       printf("CPU:String Sort (KEY) -- strings are not in order\n");
+	ErrorExit();
+}
+
 
 /*
 ** Release the offset pointer array built by
@@ -447,10 +633,52 @@ return(elapsed);
 **************
 ** Perform the bit operations test portion of the CPU
 ** benchmark.  Returns the iterations per second.
+** The whole operations array is executed by a single
+** ECALL per iteration.
 */
 void DoBitops(void)
 {
-BitOpStruct *locbitopstruct;    /* Local bitop structure */
+DoBitopsMode(&global_bitopstruct,BITOPS_BATCHED);
+return;
+}
+
+/******************
+** DoBitopsECALL **
+*******************
+** Transition-bound flavor of the bitfield test: one ECALL
+** per bit run, as in the original port.  Reported on its
+** own line so it can be compared with DoBitops().
+*/
+void DoBitopsECALL(void)
+{
+DoBitopsMode(&global_bitopecallstruct,BITOPS_ECALL);
+return;
+}
+
+/*****************
+** DoBitopsWord **
+******************
+** Bitfield with each run done a word at a time: masks for
+** the partial words at its ends, whole-word (or AVX2) stores
+** in between.  The rate is bounded by memory bandwidth
+** rather than by the per-bit loop of DoBitops(); the bitmap
+** is checked against DoBitops() once the test is done.
+*/
+void DoBitopsWord(void)
+{
+DoBitopsMode(&global_bitopwordstruct,BITOPS_WORD);
+return;
+}
+
+/*****************
+** DoBitopsMode **
+******************
+** Body of the bitfield test.  mode (BITOPS_xxx) selects
+** whether the operations array is walked inside the enclave,
+** a bit or a word at a time, or with one ECALL per run.
+*/
+static void DoBitopsMode(BitOpStruct *locbitopstruct, int mode)
+{
 farulong *bitarraybase;         /* Base of bitmap array */
 farulong *bitoparraybase;       /* Base of bitmap operations array */
 ulong nbitops;                  /* # of bitfield operations */
@@ -460,12 +688,7 @@ char *errorcontext;             /* Error context string */
 int systemerror;                /* For holding error codes */
 //memory errors handle inside of the enclave
 systemerror=0;
-int ticks;
-/*
-** Link to global structure.
-*/
-
-locbitopstruct=&global_bitopstruct;
+ulong ticks;                    /* Ticks of one iteration */
 /*
 ** Set the error context.
 */
@@ -474,7 +697,7 @@ errorcontext="CPU:Bitfields";
 /*
 ** See if we need to run adjustment code.
 */
-if(locbitopstruct->adjust==0)
+if(locbitopstruct->adjust!=1)
 {
 
 	//Memory allocation inside of the enclave
@@ -484,7 +707,8 @@ if(locbitopstruct->adjust==0)
 	/*
 	** Initialize bitfield operations array to [2,30] elements
 	*/
-	locbitopstruct->bitoparraysize=30L;
+	if(locbitopstruct->adjust==0)
+		locbitopstruct->bitoparraysize=30L;
 	while(1)
 	{
 		/*
@@ -500,12 +724,16 @@ if(locbitopstruct->adjust==0)
 		** Do an iteration of the bitmap test.  If the
 		** elapsed time is less than or equal to the permitted
 		** minimum, then de-allocate the array, reallocate a
-		** larger version, and try again.
+		** larger version, and try again.  A stale cached size
+		** starts over.
 		*/
 		ticks=DoBitfieldIteration(bitarraybase,
 					   bitoparraybase,
+					   locbitopstruct->bitfieldarraysize,
 					   locbitopstruct->bitoparraysize,
-					   &nbitops);
+					   &nbitops,
+					   mode,
+					   locbitopstruct->kernel);
 #ifdef DEBUG
 #ifdef LINUX
 	        if (locbitopstruct->bitoparraysize==30L){
@@ -532,6 +760,11 @@ if(locbitopstruct->adjust==0)
 #endif
 #endif
 
+		if(calib_stale(&locbitopstruct->adjust,ticks))
+		{       app_FreeMemory2();
+			locbitopstruct->bitoparraysize=30L;
+			continue;
+		}
 		if (ticks>global_min_ticks) break;      /* We're ok...exit */
 
 		app_FreeMemory2();		
@@ -561,7 +794,10 @@ iterations=(double)0.0;
 do {
 	accumtime+=DoBitfieldIteration(bitarraybase,
 			bitoparraybase,
-			locbitopstruct->bitoparraysize,&nbitops);
+			locbitopstruct->bitfieldarraysize,
+			locbitopstruct->bitoparraysize,&nbitops,
+			mode,
+			locbitopstruct->kernel);
 	iterations+=(double)nbitops;
 } while(TicksToSecs(accumtime)<locbitopstruct->request_secs);
 
@@ -570,11 +806,20 @@ do {
 ** Also, set adjustment flag to show that we don't have
 ** to do self adjusting in the future.
 */
+if(mode==BITOPS_WORD)
+{       app_bitSetup(locbitopstruct->bitfieldarraysize,
+		locbitopstruct->bitoparraysize);
+	if(app_checkBitfieldWord(locbitopstruct->bitfieldarraysize,
+		locbitopstruct->bitoparraysize,locbitopstruct->kernel)!=0)
+	{       printf("CPU:Bitfield (WORD) -- bitmap does not match the bit-by-bit runs\n");
+		ErrorExit();
+	}
+}
 app_FreeMemory();		
 app_FreeMemory2();
 		
 locbitopstruct->bitopspersec=iterations /TicksToFracSecs(accumtime);
-if(locbitopstruct->adjust==0)
+if(locbitopstruct->adjust!=1)
 	locbitopstruct->adjust=1;
 
 return;
@@ -585,11 +830,16 @@ return;
 *************************
 ** Perform a single iteration of the bitfield benchmark.
 ** Return the # of ticks accumulated by the operation.
+** mode is a BITOPS_xxx; kernel the BITKERNEL_xxx of
+** BITOPS_WORD.
 */
 static ulong DoBitfieldIteration(farulong *bitarraybase,
 		farulong *bitoparraybase,
+		ulong bitfieldarraysize,
 		long bitoparraysize,
-		ulong *nbitops)
+		ulong *nbitops,
+		int mode,
+		int kernel)
 {
 long i;                         /* Index */
 ulong bitoffset;                /* Offset into bitmap */
@@ -616,10 +866,25 @@ ulong elapsed;                  /* Time to execute */
 
 //set up function
 
-*nbitops = app_bitSetup(global_bitopstruct.bitfieldarraysize,bitoparraysize);
+*nbitops = app_bitSetup(bitfieldarraysize,bitoparraysize);
 
 elapsed=StartStopwatch();
 
+/*
+** Batched and word modes hand the whole operations array
+** to the enclave in one call.
+*/
+if(mode==BITOPS_BATCHED)
+{
+	app_DoBitfieldIteration(bitoparraysize);
+	return(StopStopwatch(elapsed));
+}
+if(mode==BITOPS_WORD)
+{
+	app_DoBitfieldIterationWord(bitoparraysize,kernel);
+	return(StopStopwatch(elapsed));
+}
+
 /*
 ** Loop through array off offset/run length pairs.
 ** Execute operation based on modulus of index.
@@ -668,7 +933,48 @@ return(StopStopwatch(elapsed));
 */
 void DoEmFloat(void)
 {
-EmFloatStruct *locemfloatstruct;        /* Local structure */
+DoEmFloatMode(&global_emfloatstruct,EMFLOAT_CLASSIC);
+}
+
+/******************
+** DoEmFloatWide **
+*******************
+** FP Emulation (WIDE): the same operations on the same
+** numbers, with the 64-bit mantissa in one limb instead of
+** four 16-bit words.  The results are checked against those
+** of FP Emulation once the test is done.
+*/
+void DoEmFloatWide(void)
+{
+DoEmFloatMode(&global_emfloatwidestruct,EMFLOAT_WIDE);
+}
+
+/********************
+** DoEmFloatSorted **
+*********************
+** FP Emulation (SORTED): the same operations on the same
+** numbers, with the indices sorted by operation when the
+** arrays are set up, so that each pass is four tight loops
+** (all adds, all subtracts, ...) instead of a switch per
+** element; EMFWORKERS threads each take a share of every
+** loop.  The arrays are checked against FP Emulation once
+** the test is done.
+*/
+void DoEmFloatSorted(void)
+{
+DoEmFloatMode(&global_emfloatsortstruct,EMFLOAT_SORTED);
+}
+
+/******************
+** DoEmFloatMode **
+*******************
+** Body of the FP Emulation test; mode (EMFLOAT_xxx) selects
+** the emulator.  The helpers of FP Emulation (SORTED) enter
+** the enclave before the self-adjustment and leave it after
+** the check.
+*/
+static void DoEmFloatMode(EmFloatStruct *locemfloatstruct, int mode)
+{
 InternalFPF *abase;             /* Base of A array */
 InternalFPF *bbase;             /* Base of B array */
 InternalFPF *cbase;             /* Base of C array */
@@ -677,56 +983,107 @@ double iterations;              /* # of iterations */
 ulong tickcount;                /* # of ticks */
 char *errorcontext;             /* Error context string pointer */
 int systemerror;                /* For holding error code */
+size_t elemsize;                /* Bytes per number */
+int buf[4];                     /* Handles of A, B, C and the order */
+int id;                         /* Slot of the FP Emulation (SORTED) arrays */
+pthread_t helpers[EMFMAXWORKERS];       /* FP Emulation (SORTED) helpers */
+int started[EMFMAXWORKERS];
+int i;
 //memory errors handle inside of the enclave
 systemerror=0;
 ulong loops;                    /* # of loops */
 
-/*
-** Link to global structure
-*/
-locemfloatstruct=&global_emfloatstruct;
-
 /*
 ** Set the error context
 */
-errorcontext="CPU:Floating Emulation";
+errorcontext=mode==EMFLOAT_WIDE ? "CPU:Floating Emulation (WIDE)" :
+	mode==EMFLOAT_SORTED ? "CPU:Floating Emulation (SORTED)" :
+	"CPU:Floating Emulation";
 
 
 /*
-** Test the emulation routines.
+** Test the emulation routines.  FP Emulation (WIDE) and
+** (SORTED) hand the handles of their arrays to the enclave;
+** FP Emulation finds them as its numbered buffers.
 */
 
-
-app_AllocateMemory(locemfloatstruct->arraysize*sizeof(InternalFPF));
-app_AllocateMemory2(locemfloatstruct->arraysize*sizeof(InternalFPF));
-app_AllocateMemory3(locemfloatstruct->arraysize*sizeof(InternalFPF));
+elemsize=mode==EMFLOAT_WIDE ? sizeof(WideFPF) : sizeof(InternalFPF);
+for(i=0;i<3;i++)
+	buf[i]=app_buf_alloc(locemfloatstruct->arraysize*elemsize,
+		BUFALIGN_LINE);
+buf[3]=-1;
+if(mode==EMFLOAT_SORTED)
+	buf[3]=app_buf_alloc(locemfloatstruct->arraysize*sizeof(ulong),
+		BUFALIGN_LINE);
+if(mode==EMFLOAT_CLASSIC)
+	for(i=0;i<3;i++)
+		app_buf_bind(i,buf[i]);
 
 /*
 ** Set up the arrays
 */
 
-app_SetupCPUEmFloatArrays(locemfloatstruct->arraysize);
+id=0;
+if(mode==EMFLOAT_WIDE)
+{       if(app_SetupWideEmFloatArrays(locemfloatstruct->arraysize,
+	  buf[0],buf[1])!=0)
+	{       printf("%s -- cannot set up the arrays\n",errorcontext);
+		ErrorExit();
+	}
+}
+else if(mode==EMFLOAT_SORTED)
+{       if(app_SetupSortedEmFloatArrays(locemfloatstruct->arraysize,
+	  buf[0],buf[1],buf[2],buf[3])<0 ||
+	  (id=app_emfloat_start())<0)
+	{       printf("%s -- cannot set up the arrays\n",errorcontext);
+		ErrorExit();
+	}
+	/*
+	** One helper that cannot be created, or finds no free
+	** TCS, leaves its share to the others.
+	*/
+	for(i=1;i<locemfloatstruct->workers;i++)
+		started[i]=pthread_create(&helpers[i],NULL,EmFloatHelper,
+			&id)==0;
+}
+else
+	app_SetupCPUEmFloatArrays(locemfloatstruct->arraysize);
 
 /*
 ** See if we need to do self-adjusting code.
 */
-if(locemfloatstruct->adjust==0)
+if(locemfloatstruct->adjust!=1)
 {
+	loops=1;
+	if(locemfloatstruct->adjust==ADJUST_CACHED)
+		loops=locemfloatstruct->loops;
 	locemfloatstruct->loops=0;
 
 	/*
 	** Do an iteration of the tests.  If the elapsed time is
 	** less than minimum, increase the loop count and try
-	** again.
+	** again.  A stale cached count starts over.
 	*/
-	for(loops=1;loops<CPUEMFLOATLOOPMAX;loops+=loops)
-	{       tickcount=DoEmFloatIteration(abase,bbase,cbase,
-			locemfloatstruct->arraysize,
-			loops);
+	while(loops<CPUEMFLOATLOOPMAX)
+	{       if(mode==EMFLOAT_WIDE)
+			tickcount=DoWideEmFloatIteration(buf[0],buf[1],buf[2],
+				locemfloatstruct->arraysize,loops);
+		else if(mode==EMFLOAT_SORTED)
+			tickcount=DoSortedEmFloatIteration(buf,
+				locemfloatstruct->arraysize,loops);
+		else
+			tickcount=DoEmFloatIteration(abase,bbase,cbase,
+				locemfloatstruct->arraysize,
+				loops);
+		if(calib_stale(&locemfloatstruct->adjust,tickcount))
+		{       loops=1;
+			continue;
+		}
 		if(tickcount>global_min_ticks)
 		{       locemfloatstruct->loops=loops;
 			break;
 		}
+		loops+=loops;
 	}
 }
 
@@ -734,10 +1091,9 @@ if(locemfloatstruct->adjust==0)
 ** Verify that selft adjustment code worked.
 */
 if(locemfloatstruct->loops==0)
-{       printf("CPU:EMFPU -- CMPUEMFLOATLOOPMAX limit hit\n");
-	app_FreeMemory();
-	app_FreeMemory2();
-	app_FreeMemory3();
+{       printf("%s -- CMPUEMFLOATLOOPMAX limit hit\n",errorcontext);
+	for(i=0;i<4;i++)
+		app_buf_destroy(buf[i]);
 	ErrorExit();
 }
 
@@ -750,7 +1106,16 @@ if(locemfloatstruct->loops==0)
 accumtime=0L;
 iterations=(double)0.0;
 do {
-	accumtime+=DoEmFloatIteration(abase,bbase,cbase,
+	if(mode==EMFLOAT_WIDE)
+		accumtime+=DoWideEmFloatIteration(buf[0],buf[1],buf[2],
+			locemfloatstruct->arraysize,
+			locemfloatstruct->loops);
+	else if(mode==EMFLOAT_SORTED)
+		accumtime+=DoSortedEmFloatIteration(buf,
+			locemfloatstruct->arraysize,
+			locemfloatstruct->loops);
+	else
+		accumtime+=DoEmFloatIteration(abase,bbase,cbase,
 			locemfloatstruct->arraysize,
 			locemfloatstruct->loops);
 	iterations+=(double)1.0;
@@ -762,17 +1127,77 @@ do {
 ** Also, indicate that adjustment is done.
 */
 
-app_FreeMemory();
-app_FreeMemory2();
-app_FreeMemory3();
+/*
+** FP Emulation (SORTED) runs two passes from the start
+** again, with all its threads, for the check.
+*/
+if(mode==EMFLOAT_SORTED)
+{       app_SetupSortedEmFloatArrays(locemfloatstruct->arraysize,
+		buf[0],buf[1],buf[2],buf[3]);
+	DoSortedEmFloatIteration(buf,locemfloatstruct->arraysize,2L);
+	app_emfloat_stop();
+	for(i=1;i<locemfloatstruct->workers;i++)
+		if(started[i])
+			pthread_join(helpers[i],NULL);
+	if(app_checkSortedEmFloat(locemfloatstruct->arraysize,2L,
+	  buf[0],buf[1],buf[2])!=0)
+	{       printf("%s -- results do not match FP Emulation\n",
+			errorcontext);
+		ErrorExit();
+	}
+}
+
+for(i=0;i<4;i++)
+	app_buf_destroy(buf[i]);
+
+if(mode==EMFLOAT_WIDE &&
+  app_checkWideEmFloat(locemfloatstruct->arraysize,2L)!=0)
+{       printf("%s -- results do not match FP Emulation\n",errorcontext);
+	ErrorExit();
+}
 
 locemfloatstruct->emflops=(iterations*(double)locemfloatstruct->loops)/
 		(double)TicksToFracSecs(accumtime);
-if(locemfloatstruct->adjust==0)
+if(locemfloatstruct->adjust!=1)
 	locemfloatstruct->adjust=1;
 return;
 }
 
+/*****************************
+** DoSortedEmFloatIteration **
+******************************
+** One iteration of FP Emulation (SORTED): loops passes over
+** the arrays of handles buf[0..3] (A, B, C and the order),
+** shared with the parked helpers, in one ECALL.
+*/
+static ulong DoSortedEmFloatIteration(const int *buf, ulong arraysize,
+	ulong loops)
+{
+ulong elapsed;                  /* For the stopwatch */
+
+elapsed=StartStopwatch();
+
+if(app_emfloat_run(arraysize,loops,buf[0],buf[1],buf[2],buf[3])!=0)
+{       printf("CPU:Floating Emulation (SORTED) -- pool failed\n");
+	ErrorExit();
+}
+
+return(StopStopwatch(elapsed));
+}
+
+/******************
+** EmFloatHelper **
+*******************
+** Thread body of an FP Emulation (SORTED) helper: one ECALL
+** that lasts until app_emfloat_stop(); arg points to the
+** slot.
+*/
+static void *EmFloatHelper(void *arg)
+{
+app_emfloat_worker(*(int *)arg);
+return(NULL);
+}
+
 /*************************
 ** FOURIER COEFFICIENTS **
 *************************/
@@ -787,51 +1212,101 @@ return;
 */
 void DoFourier(void)
 {
-FourierStruct *locfourierstruct;        /* Local fourier struct */
-fardouble *abase;               /* Base of A[] coefficients array */
-fardouble *bbase;               /* Base of B[] coefficients array */
+DoFourierMode(&global_fourierstruct,0);
+}
+
+/******************
+** DoFourierSIMD **
+*******************
+** Fourier (SIMD): the same coefficients, a block at a time
+** with the vector sin/cos of the enclave at the SIMD_xxx
+** level the App picked (global_simd), shared among
+** FOURIERWORKERS threads.  The coefficients are checked
+** against those of Fourier once the test is done.
+*/
+void DoFourierSIMD(void)
+{
+DoFourierMode(&global_fouriersimdstruct,1);
+}
+
+/******************
+** DoFourierMode **
+*******************
+** Body of the Fourier test; simd selects Fourier (SIMD).
+** Its helpers enter the enclave before the self-adjustment
+** and leave it after the timed runs.
+*/
+static void DoFourierMode(FourierStruct *locfourierstruct, int simd)
+{
+int abuf;                       /* Handle of A[] coefficients array */
+int bbuf;                       /* Handle of B[] coefficients array */
 unsigned long accumtime;        /* Accumulated time in ticks */
 double iterations;              /* # of iterations */
 char *errorcontext;             /* Error context string pointer */
 int systemerror;                /* For error code */
+ulong ticks;                    /* Ticks of an adjustment iteration */
+int id;                         /* Slot of the Fourier (SIMD) table */
+pthread_t helpers[FOURMAXWORKERS];      /* Fourier (SIMD) helpers */
+int started[FOURMAXWORKERS];
+int i;
 //memory errors handle inside of the enclave
 systemerror=0;
+
 /*
-** Link to global structure
+** Set error context string
 */
-locfourierstruct=&global_fourierstruct;
+errorcontext=simd ? "FPU:Transcendental (SIMD)" : "FPU:Transcendental";
 
 /*
-** Set error context string
+** The table of the integrand does not depend on the
+** # of coefficients; build it once.  Then start the
+** helpers.  One that cannot be created, or finds no free
+** TCS, leaves its share to the others.
 */
-errorcontext="FPU:Transcendental";
+id=0;
+if(simd)
+{       id=app_fourier_start(global_simd);
+	if(id<0)
+	{       printf("%s -- cannot set up the table\n",errorcontext);
+		ErrorExit();
+	}
+	for(i=1;i<locfourierstruct->workers;i++)
+		started[i]=pthread_create(&helpers[i],NULL,FourierHelper,
+			&id)==0;
+}
 
 /*
 ** See if we need to do self-adjustment code.
 */
-if(locfourierstruct->adjust==0)
+if(locfourierstruct->adjust!=1)
 {
-	locfourierstruct->arraysize=100L;       /* Start at 100 elements */
+	if(locfourierstruct->adjust==0)
+		locfourierstruct->arraysize=100L;       /* Start at 100 elements */
 	while(1)
 	{
-
-		app_AllocateMemory(locfourierstruct->arraysize*sizeof(double));
-
-		app_AllocateMemory2(locfourierstruct->arraysize*sizeof(double));
+		FourierAlloc(&abuf,&bbuf,locfourierstruct->arraysize,simd);
 		/*
 		** Do an iteration of the tests.  If the elapsed time is
 		** less than or equal to the permitted minimum, re-allocate
-		** larger arrays and try again.
+		** larger arrays and try again.  A stale cached size
+		** starts over.
 		*/
-		if(DoFPUTransIteration(abase,bbase,
-			locfourierstruct->arraysize)>global_min_ticks)
+		ticks=DoFPUTransIteration(abuf,bbuf,
+			locfourierstruct->arraysize,simd);
+		if(calib_stale(&locfourierstruct->adjust,ticks))
+		{       app_buf_destroy(abuf);
+			app_buf_destroy(bbuf);
+			locfourierstruct->arraysize=100L;
+			continue;
+		}
+		if(ticks>global_min_ticks)
 			break;          /* We're ok...exit */
 
 		/*
 		** Make bigger arrays and try again.
 		*/
-		app_FreeMemory();
-		app_FreeMemory2();
+		app_buf_destroy(abuf);
+		app_buf_destroy(bbuf);
 		locfourierstruct->arraysize+=50L;
 	}
 }
@@ -840,9 +1315,7 @@ else
 	** Don't need self-adjustment.  Just allocate the
 	** arrays, and go.
 	*/
-	app_AllocateMemory(locfourierstruct->arraysize*sizeof(double));
-
-	app_AllocateMemory2(locfourierstruct->arraysize*sizeof(double));
+	FourierAlloc(&abuf,&bbuf,locfourierstruct->arraysize,simd);
 }
 /*
 ** All's well if we get here.  Repeatedly perform integration
@@ -852,21 +1325,33 @@ else
 accumtime=0L;
 iterations=(double)0.0;
 do {
-	accumtime+=DoFPUTransIteration(abase,bbase,locfourierstruct->arraysize);
+	accumtime+=DoFPUTransIteration(abuf,bbuf,locfourierstruct->arraysize,
+		simd);
 	iterations+=(double)locfourierstruct->arraysize*(double)2.0-(double)1.0;
 } while(TicksToSecs(accumtime)<locfourierstruct->request_secs);
 
+if(simd)
+{       app_fourier_stop();
+	for(i=1;i<locfourierstruct->workers;i++)
+		if(started[i])
+			pthread_join(helpers[i],NULL);
+	if(app_fourier_check(locfourierstruct->arraysize,abuf,bbuf)!=0)
+	{       printf("%s -- coefficients do not match Fourier\n",
+			errorcontext);
+		ErrorExit();
+	}
+}
 
 /*
 ** Clean up, calculate results, and go home.
 ** Also set adjustment flag to indicate no adjust code needed.
 */
-app_FreeMemory();
-app_FreeMemory2();
+app_buf_destroy(abuf);
+app_buf_destroy(bbuf);
 
 locfourierstruct->fflops=iterations/(double)TicksToFracSecs(accumtime);
 
-if(locfourierstruct->adjust==0)
+if(locfourierstruct->adjust!=1)
 	locfourierstruct->adjust=1;
 
 return;
@@ -881,13 +1366,15 @@ return;
 ** the interval 0,2.  n is given by arraysize.
 ** NOTE: The # of integration steps is fixed at
 ** 200.
+** simd has the calling thread and the parked helpers share
+** the coefficients, in one ECALL; the others find the arrays
+** as their numbered buffers.
 */
-static ulong DoFPUTransIteration(fardouble *abase,      /* A coeffs. */
-			fardouble *bbase,               /* B coeffs. */
-			ulong arraysize)                /* # of coeffs */
+static ulong DoFPUTransIteration(int abuf,              /* A coeffs. */
+			int bbuf,                       /* B coeffs. */
+			ulong arraysize,                /* # of coeffs */
+			int simd)
 {
-double omega;           /* Fundamental frequency */
-unsigned long i;        /* Index */
 unsigned long elapsed;  /* Elapsed time */
 
 /*
@@ -895,13 +1382,49 @@ unsigned long elapsed;  /* Elapsed time */
 */
 elapsed=StartStopwatch();
 
-app_DoFPUTransIteration(arraysize);
+if(simd)
+{       if(app_fourier_run(arraysize,abuf,bbuf)!=0)
+	{       printf("FPU:Transcendental (SIMD) -- pool failed\n");
+		ErrorExit();
+	}
+}
+else
+	app_DoFPUTransIteration(arraysize);
 
 /*
 ** All done, stop the stopwatch
 */
 return(StopStopwatch(elapsed));
 }
+
+/*****************
+** FourierAlloc **
+******************
+** The A[] and B[] arrays of arraysize coefficients, into
+** *abuf and *bbuf.  Fourier (SIMD) hands the handles to the
+** enclave; Fourier binds them as its numbered buffers.
+*/
+static void FourierAlloc(int *abuf, int *bbuf, ulong arraysize, int simd)
+{
+*abuf=app_buf_alloc(arraysize*sizeof(double),BUFALIGN_LINE);
+*bbuf=app_buf_alloc(arraysize*sizeof(double),BUFALIGN_LINE);
+if(!simd)
+{       app_buf_bind(0,*abuf);
+	app_buf_bind(1,*bbuf);
+}
+}
+
+/******************
+** FourierHelper **
+*******************
+** Thread body of a Fourier (SIMD) helper: one ECALL that
+** lasts until app_fourier_stop(); arg points to the slot.
+*/
+static void *FourierHelper(void *arg)
+{
+app_fourier_worker(*(int *)arg);
+return(NULL);
+}
 /*************************
 ** ASSIGNMENT ALGORITHM **
 *************************/
@@ -934,6 +1457,7 @@ int systemerror;
 systemerror=0;
 ulong accumtime;
 double iterations;
+ulong ticks;            /* Ticks of an adjustment iteration */
 
 /*
 ** Link to global structure
@@ -948,7 +1472,7 @@ errorcontext="CPU:Assignment";
 /*
 ** See if we need to do self adjustment code.
 */
-if(locassignstruct->adjust==0)
+if(locassignstruct->adjust!=1)
 {
 	/*
 	** Self-adjustment code.  The system begins by working on 1
@@ -956,7 +1480,8 @@ if(locassignstruct->adjust==0)
 	** are built.  This process continues until
 	** enough arrays are built to handle the tolerance.
 	*/
-	locassignstruct->numarrays=1;
+	if(locassignstruct->adjust==0)
+		locassignstruct->numarrays=1;
 	while(1)
 	{
 		/*
@@ -969,10 +1494,16 @@ if(locassignstruct->adjust==0)
 		** Do an iteration of the assignment alg.  If the
 		** elapsed time is less than or equal to the permitted
 		** minimum, then allocate for more arrays and
-		** try again.
+		** try again.  A stale cached size starts over.
 		*/
-		if(DoAssignIteration(arraybase,
-			locassignstruct->numarrays)>global_min_ticks)
+		ticks=DoAssignIteration(arraybase,
+			locassignstruct->numarrays);
+		if(calib_stale(&locassignstruct->adjust,ticks))
+		{       app_FreeMemory();
+			locassignstruct->numarrays=1;
+			continue;
+		}
+		if(ticks>global_min_ticks)
 			break;          /* We're ok...exit */
 				printf("after\n");
 		app_FreeMemory();
@@ -1010,7 +1541,7 @@ app_FreeMemory();
 locassignstruct->iterspersec=iterations *
 	(double)locassignstruct->numarrays / TicksToFracSecs(accumtime);
 
-if(locassignstruct->adjust==0)
+if(locassignstruct->adjust!=1)
 	locassignstruct->adjust=1;
 
 return;
@@ -1059,6 +1590,71 @@ app_call_AssignmentTest(numarrays);
 */
 return(StopStopwatch(elapsed));
 }
+
+/***************
+** DoAssignJV **
+****************
+** ASSIGNMENT (JV): one n x n assignment (ASSIGNSIZE) per
+** iteration, solved from scratch by the shortest augmenting
+** paths of Jonker and Volgenant on a row-major cost matrix.
+** The costs are made once, outside the timing, since the
+** solver does not change them.  The duals of the last
+** solution must prove it optimal.
+*/
+void DoAssignJV(void)
+{
+AssignJVStruct *locassignstruct;        /* Local pointer to global data */
+char *errorcontext;
+long n;
+ulong accumtime;
+ulong elapsed;
+double iterations;
+int costs, duals, perm, scratch;        /* Handles of the buffers */
+
+locassignstruct=&global_assignjvstruct;
+errorcontext="CPU:Assignment (JV)";
+n=(long)locassignstruct->n;
+
+/*
+** Costs, the duals, the assignment both ways, and the
+** scratch of the solver.
+*/
+costs=app_buf_alloc(sizeof(long)*n*n,BUFALIGN_LINE);
+duals=app_buf_alloc(sizeof(long)*2*n,BUFALIGN_LINE);
+perm=app_buf_alloc(sizeof(long)*2*n,BUFALIGN_LINE);
+scratch=app_buf_alloc(sizeof(long)*3*n+n,BUFALIGN_LINE);
+
+if(app_assign_build(n,costs)!=0)
+{       printf("%s -- no room for a %ldx%ld matrix\n",errorcontext,n,n);
+        ErrorExit();
+}
+
+accumtime=0L;
+iterations=(double)0.0;
+do {
+        elapsed=StartStopwatch();
+        locassignstruct->cost=app_assign_solve(n,costs,duals,perm,scratch);
+        accumtime+=StopStopwatch(elapsed);
+        if(locassignstruct->cost<0)
+        {       printf("%s -- no buffers\n",errorcontext);
+                ErrorExit();
+        }
+        iterations+=(double)1.0;
+} while(TicksToSecs(accumtime)<locassignstruct->request_secs);
+
+if(app_assign_check(n,locassignstruct->cost,costs,duals,perm)!=0)
+{       printf("%s -- assignment not optimal\n",errorcontext);
+        ErrorExit();
+}
+
+locassignstruct->iterspersec=iterations / TicksToFracSecs(accumtime);
+
+app_buf_destroy(costs);
+app_buf_destroy(duals);
+app_buf_destroy(perm);
+app_buf_destroy(scratch);
+return;
+}
 /********************
 ** IDEA Encryption **
 *********************
@@ -1076,12 +1672,37 @@ return(StopStopwatch(elapsed));
 */
 void DoIDEA(void)
 {
-IDEAStruct *locideastruct;      /* Loc pointer to global structure */
+DoIDEAMode(&global_ideastruct,0);
+return;
+}
+
+/***************
+** DoIDEASIMD **
+****************
+** IDEA with the multi-block kernel picked for this CPU
+** (global_simd).  Same work as DoIDEA(), reported on its
+** own line next to it.
+*/
+void DoIDEASIMD(void)
+{
+DoIDEAMode(&global_ideasimdstruct,1);
+return;
+}
+
+/***************
+** DoIDEAMode **
+****************
+** Body of the IDEA test.  simd selects the vectorized
+** kernel, which is first checked against cipher_idea().
+*/
+static void DoIDEAMode(IDEAStruct *locideastruct, int simd)
+{
 int i;
 IDEAkey Z,DK;
 u16 userkey[8];
 ulong accumtime;
 double iterations;
+ulong ticks;                    /* Ticks of an adjustment iteration */
 char *errorcontext;
 int systemerror;
 //memory errors handle inside of the enclave
@@ -1090,15 +1711,10 @@ faruchar *plain1;               /* First plaintext buffer */
 faruchar *crypt1;               /* Encryption buffer */
 faruchar *plain2;               /* Second plaintext buffer */
 
-/*
-** Link to global data
-*/
-locideastruct=&global_ideastruct;
-
 /*
 ** Set error context
 */
-errorcontext="CPU:IDEA";
+errorcontext=simd ? "CPU:IDEA (SIMD)" : "CPU:IDEA";
 
 /*
 ** Re-init random-number generator.
@@ -1141,24 +1757,44 @@ app_AllocateMemory3(locideastruct->arraysize);
 
 app_loadIDEA(locideastruct->arraysize);
 
+/*
+** The vectorized kernel must give the very same ciphertext.
+*/
+if(simd && app_checkIDEAsimd(locideastruct->arraysize,Z,DK,
+  global_simd)!=0)
+{	printf("CPU:IDEA (SIMD) -- kernel does not match cipher_idea\n");
+	app_FreeMemory();
+	app_FreeMemory2();
+	app_FreeMemory3();
+	ErrorExit();
+}
+
 
 /*
 ** See if we need to perform self adjustment loop.
 */
-if(locideastruct->adjust==0)
+if(locideastruct->adjust!=1)
 {
 	/*
 	** Do self-adjustment.  This involves initializing the
 	** # of loops and increasing the loop count until we
-	** get a number of loops that we can use.
+	** get a number of loops that we can use.  A stale
+	** cached count starts over.
 	*/
-	for(locideastruct->loops=100L;
-	  locideastruct->loops<MAXIDEALOOPS;
-	  locideastruct->loops+=10L)
-		if(DoIDEAIteration(plain1,crypt1,plain2,
+	if(locideastruct->adjust==0)
+		locideastruct->loops=100L;
+	while(locideastruct->loops<MAXIDEALOOPS)
+	{       ticks=DoIDEAIteration(plain1,crypt1,plain2,
 		  locideastruct->arraysize,
 		  locideastruct->loops,
-		  Z,DK)>global_min_ticks) break;
+		  Z,DK,simd);
+		if(calib_stale(&locideastruct->adjust,ticks))
+			locideastruct->loops=100L;
+		else if(ticks>global_min_ticks)
+			break;
+		else
+			locideastruct->loops+=10L;
+	}
 }
 
 /*
@@ -1170,7 +1806,7 @@ iterations=(double)0.0;
 do {
 	accumtime+=DoIDEAIteration(plain1,crypt1,plain2,
 		locideastruct->arraysize,
-		locideastruct->loops,Z,DK);
+		locideastruct->loops,Z,DK,simd);
 	iterations+=(double)locideastruct->loops;
 } while(TicksToSecs(accumtime)<locideastruct->request_secs);
 
@@ -1184,7 +1820,7 @@ app_FreeMemory2();
 app_FreeMemory3();
 locideastruct->iterspersec=iterations / TicksToFracSecs(accumtime);
 
-if(locideastruct->adjust==0)
+if(locideastruct->adjust!=1)
 	locideastruct->adjust=1;
 
 return;
@@ -1204,7 +1840,8 @@ static ulong DoIDEAIteration(faruchar *plain1,
 			ulong arraysize,
 			ulong nloops,
 			IDEAkey Z,
-			IDEAkey DK)
+			IDEAkey DK,
+			int simd)
 {
 register ulong i;
 register ulong j;
@@ -1220,7 +1857,10 @@ elapsed=StartStopwatch();
 ** Do everything for nloops.
 */
 
-app_callIDEA(arraysize, Z, DK, nloops);
+if(simd)
+	app_callIDEAsimd(arraysize, Z, DK, nloops, global_simd);
+else
+	app_callIDEA(arraysize, Z, DK, nloops);
 
 return(StopStopwatch(elapsed));
 }
@@ -1430,26 +2070,47 @@ return;
 */
 void DoHuffman(void)
 {
-HuffStruct *lochuffstruct;      /* Loc pointer to global data */
+DoHuffmanMode(&global_huffstruct,0);
+return;
+}
+
+/*******************
+** DoHuffmanTable **
+********************
+** Huffman with the table-driven canonical coder of
+** encl_huffman.c.  Same plaintext and the same round trip
+** as DoHuffman(), reported on its own line next to it.
+*/
+void DoHuffmanTable(void)
+{
+DoHuffmanMode(&global_hufftablestruct,1);
+return;
+}
+
+/******************
+** DoHuffmanMode **
+*******************
+** Body of the Huffman test.  table selects the canonical
+** coder, which checks every round trip against the
+** plaintext.
+*/
+static void DoHuffmanMode(HuffStruct *lochuffstruct, int table)
+{
 char *errorcontext;
 int systemerror;
 //memory errors handle inside of the enclave
 systemerror=0;
 ulong accumtime;
 double iterations;
+ulong ticks;                    /* Ticks of an adjustment iteration */
 farchar *comparray;
 farchar *decomparray;
 farchar *plaintext;
 
-/*
-** Link to global data
-*/
-lochuffstruct=&global_huffstruct;
-
 /*
 ** Set error context.
 */
-errorcontext="CPU:Huffman";
+errorcontext=table ? "CPU:Huffman (table)" : "CPU:Huffman";
 
 /*
 ** Allocate memory for the plaintext and the compressed text.
@@ -1464,7 +2125,10 @@ errorcontext="CPU:Huffman";
 */
 
 app_AllocateMemory(lochuffstruct->arraysize);
-app_AllocateMemory2(lochuffstruct->arraysize);
+if(table)
+	app_AllocateMemory2(HUFFTABLECOMP(lochuffstruct->arraysize));
+else
+	app_AllocateMemory2(lochuffstruct->arraysize);
 app_AllocateMemory3(lochuffstruct->arraysize);
 app_AllocateMemory4(sizeof(huff_node) * 512);
 
@@ -1485,7 +2149,7 @@ app_buildHuffman(lochuffstruct->arraysize);
 */
 
 
-if(lochuffstruct->adjust==0)
+if(lochuffstruct->adjust!=1)
 {
 	/*
 	** Do self-adjustment.  This involves initializing the
@@ -1495,15 +2159,23 @@ if(lochuffstruct->adjust==0)
 	
 	
 	//app_selfAdjustment(lochuffstruct->loops, lochuffstruct->arraysize);
-for(lochuffstruct->loops=100L;
-	  lochuffstruct->loops<MAXHUFFLOOPS;
-	  lochuffstruct->loops+=10L)
-		if(DoHuffIteration(plaintext,
+	if(lochuffstruct->adjust==0)
+		lochuffstruct->loops=100L;
+	while(lochuffstruct->loops<MAXHUFFLOOPS)
+	{       ticks=DoHuffIteration(plaintext,
 			comparray,
 			decomparray,
 		  lochuffstruct->arraysize,
 		  lochuffstruct->loops,
-		  hufftree)>global_min_ticks) break;
+		  hufftree,
+		  table);
+		if(calib_stale(&lochuffstruct->adjust,ticks))
+			lochuffstruct->loops=100L;      /* Stale cached count */
+		else if(ticks>global_min_ticks)
+			break;
+		else
+			lochuffstruct->loops+=10L;
+	}
 }
 
 /*
@@ -1518,7 +2190,8 @@ do {
 		decomparray,
 		lochuffstruct->arraysize,
 		lochuffstruct->loops,
-		hufftree);
+		hufftree,
+		table);
 	iterations+=(double)lochuffstruct->loops;
 } while(TicksToSecs(accumtime)<lochuffstruct->request_secs);
 
@@ -1533,7 +2206,7 @@ app_FreeMemory4();
 
 lochuffstruct->iterspersec=iterations / TicksToFracSecs(accumtime);
 
-if(lochuffstruct->adjust==0)
+if(lochuffstruct->adjust!=1)
 	lochuffstruct->adjust=1;
 
 }
@@ -1544,13 +2217,15 @@ if(lochuffstruct->adjust==0)
 **  (a) Builds the huffman tree
 **  (b) Compresses the text
 **  (c) Decompresses the text and verifies correct decompression
+** table selects the canonical coder.
 */
 static ulong DoHuffIteration(farchar *plaintext,
 	farchar *comparray,
 	farchar *decomparray,
 	ulong arraysize,
 	ulong nloops,
-	huff_node *hufftree)
+	huff_node *hufftree,
+	int table)
 {
 int i;                          /* Index */
 long j;                         /* Bigger index */
@@ -1564,6 +2239,7 @@ long bitstringlen;              /* Length of bitstring */
 int c;                          /* Character from plaintext */
 char bitstring[30];             /* Holds bitstring */
 ulong elapsed;                  /* For stopwatch */
+int tablestatus;                /* Of the canonical coder */
 #ifdef DEBUG
 int status=0;
 #endif
@@ -1575,7 +2251,19 @@ int status=0;
 elapsed=StartStopwatch();
 
 
-app_callHuffman(nloops, arraysize);
+if(table)
+{       tablestatus=app_callHuffmanTable(nloops, arraysize);
+	if(tablestatus==HUFFOVERFLOW)
+	{       printf("CPU:Huffman (table) -- compressed text overflows its buffer\n");
+		ErrorExit();
+	}
+	if(tablestatus<0)
+	{       printf("CPU:Huffman (table) -- round trip does not match the plaintext\n");
+		ErrorExit();
+	}
+}
+else
+	app_callHuffman(nloops, arraysize);
 /*
 ** Do everything for nloops
 */
@@ -1623,6 +2311,7 @@ NNetStruct *locnnetstruct;      /* Local ptr to global data */
 char *errorcontext;
 ulong accumtime;
 double iterations;
+ulong ticks;                    /* Ticks of an adjustment iteration */
 
 /*
 ** Link to global data
@@ -1657,20 +2346,26 @@ if(read_data_file()!=0)
 /*
 ** See if we need to perform self adjustment loop.
 */
-if(locnnetstruct->adjust==0)
+if(locnnetstruct->adjust!=1)
 {
 	/*
 	** Do self-adjustment.  This involves initializing the
 	** # of loops and increasing the loop count until we
-	** get a number of loops that we can use.
+	** get a number of loops that we can use.  A stale
+	** cached count starts over.
 	*/
-	for(locnnetstruct->loops=1L;
-	  locnnetstruct->loops<MAXNNETLOOPS;
-	  locnnetstruct->loops++)
+	if(locnnetstruct->adjust==0)
+		locnnetstruct->loops=1L;
+	while(locnnetstruct->loops<MAXNNETLOOPS)
 	  {     /*randnum(3L); */
 		randnum((int32)3);
-		if(DoNNetIteration(locnnetstruct->loops)
-			>global_min_ticks) break;
+		ticks=DoNNetIteration(locnnetstruct->loops);
+		if(calib_stale(&locnnetstruct->adjust,ticks))
+			locnnetstruct->loops=1L;
+		else if(ticks>global_min_ticks)
+			break;
+		else
+			locnnetstruct->loops++;
 	  }
 }
 
@@ -1693,7 +2388,7 @@ do {
 */
 locnnetstruct->iterspersec=iterations / TicksToFracSecs(accumtime);
 
-if(locnnetstruct->adjust==0)
+if(locnnetstruct->adjust!=1)
 	locnnetstruct->adjust=1;
 
 
@@ -2219,6 +2914,7 @@ int xinsize,yinsize,youtsize;
 int patt, element, i, row;
 int vals_read;
 int val1,val2,val3,val4,val5,val6,val7,val8;
+double pats[MAXPATS*(IN_SIZE+OUT_SIZE)];        /* For the enclave */
 
 /* printf("\n Opening and retrieving data from file."); */
 
@@ -2245,8 +2941,6 @@ if (vals_read !=1)
 if (numpats > MAXPATS)
 	numpats = MAXPATS;
 
-app_set_numpats(numpats);
-
 for (patt=0; patt<numpats; patt++)
 {
 	element = 0;
@@ -2261,36 +2955,48 @@ for (patt=0; patt<numpats; patt++)
 		}
 		element=row*xinsize;
 
-		app_set_in_pats(patt,element,(double)val1); element++;
-		app_set_in_pats(patt,element,(double)val2); element++;
-		app_set_in_pats(patt,element,(double)val3); element++;
-		app_set_in_pats(patt,element,(double)val4); element++;
-		app_set_in_pats(patt,element,(double)val5); element++;
+		in_pats[patt][element] = (double) val1; element++;
+		in_pats[patt][element] = (double) val2; element++;
+		in_pats[patt][element] = (double) val3; element++;
+		in_pats[patt][element] = (double) val4; element++;
+		in_pats[patt][element] = (double) val5; element++;
 	}
 	for (i=0;i<IN_SIZE; i++)
 	{
-		if (app_get_in_pats(patt,i) >= 0.9)
-			app_set_in_pats(patt,i,0.9);
-		if (app_get_in_pats(patt,i) <= 0.1)
-			app_set_in_pats(patt,i,0.1);
+		if (in_pats[patt][i] >= 0.9)
+			in_pats[patt][i] = 0.9;
+		if (in_pats[patt][i] <= 0.1)
+			in_pats[patt][i] = 0.1;
 	}
 	element = 0;
 	vals_read = fscanf(infile,"%d  %d  %d  %d  %d  %d  %d  %d",
 		&val1, &val2, &val3, &val4, &val5, &val6, &val7, &val8);
 
-	app_set_out_pats(patt,element,(double)val1); element++;
-	app_set_out_pats(patt,element,(double)val2); element++;
-	app_set_out_pats(patt,element,(double)val3); element++;
-	app_set_out_pats(patt,element,(double)val4); element++;
-	app_set_out_pats(patt,element,(double)val5); element++;
-	app_set_out_pats(patt,element,(double)val6); element++;
-	app_set_out_pats(patt,element,(double)val7); element++;
-	app_set_out_pats(patt,element,(double)val8); element++;
+	out_pats[patt][element] = (double) val1; element++;
+	out_pats[patt][element] = (double) val2; element++;
+	out_pats[patt][element] = (double) val3; element++;
+	out_pats[patt][element] = (double) val4; element++;
+	out_pats[patt][element] = (double) val5; element++;
+	out_pats[patt][element] = (double) val6; element++;
+	out_pats[patt][element] = (double) val7; element++;
+	out_pats[patt][element] = (double) val8; element++;
 }
 
 /* printf("\n Closing the input file now. "); */
 
 fclose(infile);
+
+/*
+** Hand every pattern to the enclave in one ECALL: the
+** inputs, then the outputs, back to back.
+*/
+memcpy(pats,in_pats,numpats*IN_SIZE*sizeof(double));
+memcpy(pats+numpats*IN_SIZE,out_pats,numpats*OUT_SIZE*sizeof(double));
+if(app_load_pats(numpats,pats,(size_t)numpats*(IN_SIZE+OUT_SIZE))!=0)
+{
+	printf("\n CPU:NNET -- enclave rejected the patterns");
+	return -1;
+}
 return(0);
 }
 
@@ -2366,6 +3072,97 @@ int             neurode, weight;
 }
 */
 
+/**************
+** DoNNetMLP **
+***************
+** NEURAL NET (MLP): the back propagation of Neural Net on a
+** net whose sizes are set in the command file, trained on
+** made-up patterns a batch (MLPBATCH) at a time, so that
+** each pass is a handful of matrix multiplies.  An iteration
+** trains the net from the same initial weights for a number
+** of epochs found by self-adjustment, as in Neural Net.  The
+** score is patterns per second; GFLOP/s counts the three
+** multiplies of each layer (forward, error, weight change).
+*/
+void DoNNetMLP(void)
+{
+MLPStruct *locmlpstruct;        /* Local pointer to global data */
+char *errorcontext;
+ulong accumtime;
+double iterations;
+ulong ticks;                    /* Ticks of an adjustment iteration */
+double flops;
+
+locmlpstruct=&global_mlpstruct;
+errorcontext="FPU:NNET (MLP)";
+
+if(app_mlp_setup((long)locmlpstruct->in,(long)locmlpstruct->hid,
+  (long)locmlpstruct->out,(long)locmlpstruct->npats,
+  (long)locmlpstruct->batch)!=0)
+{       printf("%s -- no room for the net\n",errorcontext);
+        ErrorExit();
+}
+
+/*
+** The batched forward pass, and an epoch of training, must
+** match the plain ones.
+*/
+if(app_mlp_check(global_simd)!=0)
+{       printf("%s -- training differs from the reference\n",errorcontext);
+        app_mlp_free();
+        ErrorExit();
+}
+
+if(locmlpstruct->adjust!=1)
+{
+        if(locmlpstruct->adjust==0)
+                locmlpstruct->loops=1L;
+        while(locmlpstruct->loops<MAXMLPLOOPS)
+        {       ticks=DoMLPIteration(locmlpstruct->loops);
+                if(calib_stale(&locmlpstruct->adjust,ticks))
+                        locmlpstruct->loops=1L; /* Stale cached count */
+                else if(ticks>global_min_ticks)
+                        break;
+                else
+                        locmlpstruct->loops++;
+        }
+}
+
+accumtime=0L;
+iterations=(double)0.0;
+do {
+        accumtime+=DoMLPIteration(locmlpstruct->loops);
+        iterations+=(double)locmlpstruct->loops;
+} while(TicksToSecs(accumtime)<locmlpstruct->request_secs);
+
+app_mlp_free();
+
+flops=(double)2.0*((double)2.0*(double)locmlpstruct->in*
+        (double)locmlpstruct->hid+
+        (double)3.0*(double)locmlpstruct->hid*(double)locmlpstruct->out);
+locmlpstruct->patspersec=iterations*(double)locmlpstruct->npats/
+        TicksToFracSecs(accumtime);
+locmlpstruct->gflops=locmlpstruct->patspersec*flops/(double)1e9;
+
+if(locmlpstruct->adjust!=1)
+        locmlpstruct->adjust=1;
+return;
+}
+
+/*******************
+** DoMLPIteration **
+********************
+** Train the net for nepochs passes over the patterns.
+*/
+static ulong DoMLPIteration(ulong nepochs)
+{
+ulong elapsed;
+
+elapsed=StartStopwatch();
+app_mlp_train(nepochs,global_simd);
+return(StopStopwatch(elapsed));
+}
+
 /***********************
 **  LU DECOMPOSITION  **
 ** (Linear Equations) **
@@ -2398,6 +3195,7 @@ int n;
 int i;
 ulong accumtime;
 double iterations;
+ulong ticks;            /* Ticks of an adjustment iteration */
 
 /*
 ** Link to global data
@@ -2447,10 +3245,13 @@ app_build_problem();
 ** auto-adjust.  If so, repeatedly call the DoLUIteration routine,
 ** increasing the number of solutions per iteration as you go.
 */
-if(loclustruct->adjust==0)
+if(loclustruct->adjust!=1)
 {
+	i=1;
+	if(loclustruct->adjust==ADJUST_CACHED)
+		i=(int)loclustruct->numarrays;
 	loclustruct->numarrays=0;
-	for(i=1;i<=MAXLUARRAYS;i++)
+	for(;i<=MAXLUARRAYS;i++)
 	{
 
 		app_AllocateMemory4(sizeof(double) * LUARRAYCOLS*LUARRAYROWS*(i+1));
@@ -2460,7 +3261,17 @@ if(loclustruct->adjust==0)
 
 
 		
-		if(DoLUIteration(a,b,abase,bbase,i)>global_min_ticks)
+		ticks=DoLUIteration(a,b,abase,bbase,i);
+		if(calib_stale(&loclustruct->adjust,ticks))
+		{       /*
+			** A stale cached size: start over from 1
+			*/
+			app_FreeMemory4();
+			app_FreeMemory5();
+			i=0;
+			continue;
+		}
+		if(ticks>global_min_ticks)
 		{       loclustruct->numarrays=i;
 			break;
 		}
@@ -2511,7 +3322,7 @@ do {
 */
 loclustruct->iterspersec=iterations / TicksToFracSecs(accumtime);
 
-if(loclustruct->adjust==0)
+if(loclustruct->adjust!=1)
 	loclustruct->adjust=1;
 
 
@@ -2558,3 +3369,85 @@ app_call_lusolve(numarrays);
 
 return(StopStopwatch(elapsed));
 }
+
+/****************
+** DoLUBlocked **
+*****************
+** LU (BLOCKED): factor one n x n matrix (LUSIZE) per
+** iteration, with the blocked kernel or, for comparison,
+** the Crout loops of LU (LUKERNEL).  The matrix is refreshed
+** from the seed before each factorization, outside the
+** timing.  The score is factorizations per second; GFLOP/s
+** counts the 2/3 n**3 flops of each.
+*/
+void DoLUBlocked(void)
+{
+LUBlockStruct *loclustruct;     /* Local pointer to global data */
+char *errorcontext;
+long n;
+ulong accumtime;
+ulong elapsed;
+double iterations;
+int seed, rhs, work, indx, scratch;     /* Handles of the buffers */
+int status;
+
+loclustruct=&global_lublockstruct;
+errorcontext="FPU:LU (BLOCKED)";
+n=(long)loclustruct->n;
+
+/*
+** Seed matrix and right-hand side, the matrix being
+** factored, its row interchanges and the scratch of the
+** Crout kernel and the check.  The matrices start on a
+** page, so that the rows of a block do too when n is a
+** multiple of 512.
+*/
+seed=app_buf_alloc(sizeof(double)*n*n,BUFALIGN_PAGE);
+rhs=app_buf_alloc(sizeof(double)*n,BUFALIGN_LINE);
+work=app_buf_alloc(sizeof(double)*n*n,BUFALIGN_PAGE);
+indx=app_buf_alloc(sizeof(int)*n,BUFALIGN_LINE);
+scratch=app_buf_alloc(sizeof(double)*2*n,BUFALIGN_LINE);
+
+if(app_lu_build(n,seed,rhs)!=0)
+{       printf("%s -- no room for a %ldx%ld matrix\n",errorcontext,n,n);
+        ErrorExit();
+}
+
+accumtime=0L;
+iterations=(double)0.0;
+do {
+        if(app_lu_reset(n,seed,work)!=0)
+        {       printf("%s -- no buffers\n",errorcontext);
+                ErrorExit();
+        }
+        elapsed=StartStopwatch();
+        status=app_lu_factor(n,(long)loclustruct->nb,loclustruct->kernel,
+          global_simd,work,indx,scratch);
+        accumtime+=StopStopwatch(elapsed);
+        if(status!=0)
+        {       printf("%s -- %s\n",errorcontext,
+                  status==-1 ? "singular matrix" : "no buffers");
+                ErrorExit();
+        }
+        iterations+=(double)1.0;
+} while(TicksToSecs(accumtime)<loclustruct->request_secs);
+
+/*
+** The last factorization must solve the seed problem.
+*/
+if(app_lu_check(n,seed,rhs,work,indx,scratch)!=0)
+{       printf("%s -- residual of the solution too large\n",errorcontext);
+        ErrorExit();
+}
+
+loclustruct->iterspersec=iterations / TicksToFracSecs(accumtime);
+loclustruct->gflops=loclustruct->iterspersec*
+        ((double)2.0/(double)3.0)*(double)n*(double)n*(double)n/(double)1e9;
+
+app_buf_destroy(seed);
+app_buf_destroy(rhs);
+app_buf_destroy(work);
+app_buf_destroy(indx);
+app_buf_destroy(scratch);
+return;
+}
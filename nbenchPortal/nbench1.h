@@ -32,17 +32,30 @@
 ** EXTERNALS
 */
 extern ulong global_min_ticks;
-
-extern SortStruct global_numsortstruct;
-extern SortStruct global_strsortstruct;
-extern BitOpStruct global_bitopstruct;
-extern EmFloatStruct global_emfloatstruct;
-extern FourierStruct global_fourierstruct;
-extern AssignStruct global_assignstruct;
-extern IDEAStruct global_ideastruct;
-extern HuffStruct global_huffstruct;
-extern NNetStruct global_nnetstruct;
-extern LUStruct global_lustruct;
+extern int global_simd;                 /* SIMD_xxx of DoIDEASIMD */
+
+extern THREADLOCAL SortStruct global_numsortstruct;
+extern THREADLOCAL SortStruct global_numsortparstruct;
+extern THREADLOCAL SortStruct global_strsortstruct;
+extern THREADLOCAL SortStruct global_strsortkeystruct;
+extern THREADLOCAL BitOpStruct global_bitopstruct;
+extern THREADLOCAL BitOpStruct global_bitopecallstruct;
+extern THREADLOCAL BitOpStruct global_bitopwordstruct;
+extern THREADLOCAL EmFloatStruct global_emfloatstruct;
+extern THREADLOCAL EmFloatStruct global_emfloatwidestruct;
+extern THREADLOCAL EmFloatStruct global_emfloatsortstruct;
+extern THREADLOCAL FourierStruct global_fourierstruct;
+extern THREADLOCAL FourierStruct global_fouriersimdstruct;
+extern THREADLOCAL AssignStruct global_assignstruct;
+extern THREADLOCAL AssignJVStruct global_assignjvstruct;
+extern THREADLOCAL IDEAStruct global_ideastruct;
+extern THREADLOCAL IDEAStruct global_ideasimdstruct;
+extern THREADLOCAL HuffStruct global_huffstruct;
+extern THREADLOCAL HuffStruct global_hufftablestruct;
+extern THREADLOCAL NNetStruct global_nnetstruct;
+extern THREADLOCAL MLPStruct global_mlpstruct;
+extern THREADLOCAL LUStruct global_lustruct;
+extern THREADLOCAL LUBlockStruct global_lublockstruct;
 
 /* External PROTOTYPES */
 /*extern unsigned long abs_randwc(unsigned long num);*/     /* From MISC */
@@ -59,6 +72,8 @@ extern void MoveMemory(farvoid *destination,
 		farvoid *source, unsigned long nbytes);
 extern void ReportError(char *context, int errorcode);
 extern void ErrorExit();
+extern void alloc_failed(void);
+extern int calib_stale(int *adjust, ulong ticks);
 extern unsigned long StartStopwatch();
 extern unsigned long StopStopwatch(unsigned long startticks);
 extern unsigned long TicksToSecs(unsigned long tickamount);
@@ -68,13 +83,25 @@ extern double TicksToFracSecs(unsigned long tickamount);
 ** NUMERIC SORT **
 *****************/
 
+/*
+** TYPEDEFS
+*/
+typedef struct {
+        int pool;               /* Sort pool id */
+        int part;               /* Helper #, 1 up */
+} SortHelperJob;
+
 /*
 ** PROTOTYPES
 */
 void DoNumSort(void);
+void DoNumSortPar(void);
+static void DoNumSortMode(SortStruct *numsortstruct, int par);
+static void *SortHelper(void *arg);
 static ulong DoNumSortIteration(farlong *arraybase,
 		ulong arraysize,
-		uint numarrays);
+		uint numarrays,
+		int par);
 static void LoadNumArrayWithRand(farlong *array,
 		ulong arraysize,
 		uint numarrays);
@@ -96,9 +123,12 @@ static void NumSift(farlong *array,
 ** PROTOTYPES
 */
 void DoStringSort(void);
+void DoStringSortKey(void);
+static void DoStringSortMode(SortStruct *strsortstruct, int key);
 static ulong DoStringSortIteration(faruchar *arraybase,
 		uint numarrays,
-		ulong arraysize);
+		ulong arraysize,
+		int key);
 static farulong *LoadStringArray(faruchar *strarray,
 		uint numarrays,
 		ulong *strings,
@@ -133,10 +163,17 @@ static void strsift(farulong *optrarray,
 ** PROTOTYPES
 */
 void DoBitops(void);
+void DoBitopsECALL(void);
+void DoBitopsWord(void);
+static void DoBitopsMode(BitOpStruct *locbitopstruct,
+		int mode);
 static ulong DoBitfieldIteration(farulong *bitarraybase,
 		farulong *bitoparraybase,
+		ulong bitfieldarraysize,
 		long bitoparraysize,
-		ulong *nbitops);
+		ulong *nbitops,
+		int mode,
+		int kernel);
 static void ToggleBitRun(farulong *bitmap,
 		ulong bit_addr,
 		ulong nbits,
@@ -156,10 +193,24 @@ typedef struct
 	u16 mantissa[INTERNAL_FPF_PRECISION];
 } InternalFPF;
 
+typedef struct
+{
+	u8 type;        /* As in InternalFPF */
+	u8 sign;
+	short exp;
+	unsigned long long mant;        /* The 64-bit mantissa, one limb */
+} WideFPF;
+
 /*
 ** PROTOTYPES
 */
 void DoEmFloat(void);
+void DoEmFloatWide(void);
+void DoEmFloatSorted(void);
+static void DoEmFloatMode(EmFloatStruct *locemfloatstruct, int mode);
+static ulong DoSortedEmFloatIteration(const int *buf, ulong arraysize,
+	ulong loops);
+static void *EmFloatHelper(void *arg);
 
 /*
 ** EXTERNALS
@@ -170,6 +221,8 @@ extern void SetupCPUEmFloatArrays(InternalFPF *abase,
 extern ulong DoEmFloatIteration(InternalFPF *abase,
 	InternalFPF *bbase, InternalFPF *cbase,
 	ulong arraysize, ulong loops);
+extern ulong DoWideEmFloatIteration(int a, int b, int c, ulong arraysize,
+	ulong loops);
 
 /*************************
 ** FOURIER COEFFICIENTS **
@@ -179,9 +232,14 @@ extern ulong DoEmFloatIteration(InternalFPF *abase,
 ** PROTOTYPES
 */
 void DoFourier(void);
-static ulong DoFPUTransIteration(fardouble *abase,
-		fardouble *bbase,
-		ulong arraysize);
+void DoFourierSIMD(void);
+static void DoFourierMode(FourierStruct *locfourierstruct, int simd);
+static ulong DoFPUTransIteration(int abuf,
+		int bbuf,
+		ulong arraysize,
+		int simd);
+static void FourierAlloc(int *abuf, int *bbuf, ulong arraysize, int simd);
+static void *FourierHelper(void *arg);
 static double TrapezoidIntegrate(double x0,
 		double x1,
 		int nsteps,
@@ -229,6 +287,7 @@ static int first_assignments(long tableau[][ASSIGNCOLS],
 		short assignedtableau[][ASSIGNCOLS]);
 static void second_assignments(long tableau[][ASSIGNCOLS],
 		short assignedtableau[][ASSIGNCOLS]);
+void DoAssignJV(void);
 
 /********************
 ** IDEA ENCRYPTION **
@@ -255,10 +314,12 @@ typedef u16 IDEAkey[KEYLEN];
 ** PROTOTYPES
 */
 void DoIDEA(void);
+void DoIDEASIMD(void);
+static void DoIDEAMode(IDEAStruct *locideastruct, int simd);
 static ulong DoIDEAIteration(faruchar *plain1,
 	faruchar *crypt1, faruchar *plain2,
 	ulong arraysize, ulong nloops,
-	IDEAkey Z, IDEAkey DK);
+	IDEAkey Z, IDEAkey DK, int simd);
 static u16 mul(register u16 a, register u16 b);
 static u16 inv(u16 x);
 static void en_key_idea(u16 userkey[8], IDEAkey Z);
@@ -295,12 +356,15 @@ static long plaintextlen;               /* Length of plaintext */
 ** PROTOTYPES
 */
 void DoHuffman();
+void DoHuffmanTable(void);
+static void DoHuffmanMode(HuffStruct *lochuffstruct, int table);
 static void create_text_line(farchar *dt,long nchars);
 static void create_text_block(farchar *tb, ulong tblen,
 		ushort maxlinlen);
 static ulong DoHuffIteration(farchar *plaintext,
 	farchar *comparray, farchar *decomparray,
-	ulong arraysize, ulong nloops, huff_node *hufftree);
+	ulong arraysize, ulong nloops, huff_node *hufftree,
+	int table);
 static void SetCompBit(u8 *comparray, u32 bitoffset, char bitchar);
 static int GetCompBit(u8 *comparray, u32 bitoffset);
 
@@ -327,29 +391,30 @@ static int GetCompBit(u8 *comparray, u32 bitoffset);
 
 /*
 ** GLOBALS
+** Per thread: read_data_file() fills them in for each run.
 */
-double  mid_wts[MID_SIZE][IN_SIZE];     /* middle layer weights */
-double  out_wts[OUT_SIZE][MID_SIZE];    /* output layer weights */
-double  mid_out[MID_SIZE];              /* middle layer output */
-double  out_out[OUT_SIZE];              /* output layer output */
-double  mid_error[MID_SIZE];            /* middle layer errors */
-double  out_error[OUT_SIZE];            /* output layer errors */
-double  mid_wt_change[MID_SIZE][IN_SIZE]; /* storage for last wt change */
-double  out_wt_change[OUT_SIZE][MID_SIZE]; /* storage for last wt change */
-double  in_pats[MAXPATS][IN_SIZE];      /* input patterns */
-double  out_pats[MAXPATS][OUT_SIZE];    /* desired output patterns */
-double  tot_out_error[MAXPATS];         /* measure of whether net is done */
-double  out_wt_cum_change[OUT_SIZE][MID_SIZE]; /* accumulated wt changes */
-double  mid_wt_cum_change[MID_SIZE][IN_SIZE];  /* accumulated wt changes */
-
-double  worst_error; /* worst error each pass through the data */
-double  average_error; /* average error each pass through the data */
-double  avg_out_error[MAXPATS]; /* average error each pattern */
-
-int iteration_count;    /* number of passes thru network so far */
-int numpats;            /* number of patterns in data file */
-int numpasses;          /* number of training passes through data file */
-int learned;            /* flag--if TRUE, network has learned all patterns */
+THREADLOCAL double  mid_wts[MID_SIZE][IN_SIZE];     /* middle layer weights */
+THREADLOCAL double  out_wts[OUT_SIZE][MID_SIZE];    /* output layer weights */
+THREADLOCAL double  mid_out[MID_SIZE];              /* middle layer output */
+THREADLOCAL double  out_out[OUT_SIZE];              /* output layer output */
+THREADLOCAL double  mid_error[MID_SIZE];            /* middle layer errors */
+THREADLOCAL double  out_error[OUT_SIZE];            /* output layer errors */
+THREADLOCAL double  mid_wt_change[MID_SIZE][IN_SIZE]; /* storage for last wt change */
+THREADLOCAL double  out_wt_change[OUT_SIZE][MID_SIZE]; /* storage for last wt change */
+THREADLOCAL double  in_pats[MAXPATS][IN_SIZE];      /* input patterns */
+THREADLOCAL double  out_pats[MAXPATS][OUT_SIZE];    /* desired output patterns */
+THREADLOCAL double  tot_out_error[MAXPATS];         /* measure of whether net is done */
+THREADLOCAL double  out_wt_cum_change[OUT_SIZE][MID_SIZE]; /* accumulated wt changes */
+THREADLOCAL double  mid_wt_cum_change[MID_SIZE][IN_SIZE];  /* accumulated wt changes */
+
+THREADLOCAL double  worst_error; /* worst error each pass through the data */
+THREADLOCAL double  average_error; /* average error each pass through the data */
+THREADLOCAL double  avg_out_error[MAXPATS]; /* average error each pattern */
+
+THREADLOCAL int iteration_count;    /* number of passes thru network so far */
+THREADLOCAL int numpats;            /* number of patterns in data file */
+THREADLOCAL int numpasses;          /* number of training passes through data file */
+THREADLOCAL int learned;            /* flag--if TRUE, network has learned all patterns */
 
 /*
 ** The Neural Net test requires an input data file.
@@ -378,6 +443,8 @@ static void zero_changes();
 static void randomize_wts();
 static int read_data_file();
 /* static int initialize_net(); */
+void DoNNetMLP(void);
+static ulong DoMLPIteration(ulong nepochs);
 
 /***********************
 **  LU DECOMPOSITION  **
@@ -424,5 +491,6 @@ static void lubksb(double a[][LUARRAYCOLS],
 	double b[LUARRAYROWS]);
 static int lusolve(double a[][LUARRAYCOLS],
 	int n, double b[LUARRAYROWS]);
+void DoLUBlocked(void);
 
 
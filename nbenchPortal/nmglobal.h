@@ -70,14 +70,26 @@
 **  CLOCKWCT
 **  MACTIMEMGR
 **  WIN31TIMER
+**  TIMERSELECT
 */
 
+/*
+** Define TIMERSELECT to pick the stopwatch at run time with
+** TIMER= in the command file.  Backends are clock(),
+** clock_gettime(CLOCK_MONOTONIC_RAW) (the default) and the
+** invariant TSC.  This is the default under LINUX.
+*/
+#ifdef LINUX
+#define TIMERSELECT
+#else
+
 /*
 ** Define CLOCKWCPS if you are using the clock() routine and the
 ** constant used as the divisor to determine seconds is
 ** CLOCKS_PER_SEC.  This is the default in most cases.
 */
 #define CLOCKWCPS
+#endif
 
 /*
 ** Define CLOCKWCT if you are using the clock() routine and the
@@ -162,9 +174,19 @@
 ** number of ticks that must take place between
 ** a StartStopwatch() and StopStopwatch() call.
 ** The idea is to reduce error buildup.
+** Under TIMERSELECT the value is taken as clock() ticks
+** (CLOCKS_PER_SEC) and converted to the same span of the
+** selected timer; GLOBALMINTICKS is in ticks of that timer.
 */
 #define MINIMUM_TICKS 60
 
+/*
+** Stopwatch backends for TIMERSELECT.
+*/
+#define TIMER_CLOCK 0           /* clock(), process CPU time */
+#define TIMER_MONORAW 1         /* clock_gettime(CLOCK_MONOTONIC_RAW) */
+#define TIMER_TSC 2             /* rdtscp, calibrated frequency */
+
 /*
 ** MINIMUM_SECONDS
 **
@@ -197,6 +219,30 @@
 */
 #define MEM_ARRAY_SIZE 20
 
+/*
+** Max # of threads for -threads=N.  Each thread holds a TCS
+** of the enclave, so this matches TCSNum in Enclave.config.xml.
+*/
+#define MAXTHREADS 10
+
+/*
+** Alignments of the enclave buffers (app_buf_create()):
+** a cache line, or a page for the kernels that want their
+** matrices to start on one.
+*/
+#define BUFALIGN_LINE 64
+#define BUFALIGN_PAGE 4096
+
+/*
+** THREADLOCAL marks state that each -threads worker needs
+** its own copy of.
+*/
+#ifdef LINUX
+#define THREADLOCAL __thread
+#else
+#define THREADLOCAL
+#endif
+
 /*
 ** TYPEDEFS
 */
@@ -275,6 +321,28 @@ typedef long int32;              /* Signed 32 bit integer */
 */
 #define NUMARRAYSIZE    8111L
 
+/*
+** Numeric Sort (PAR) sorts all the arrays in one ECALL,
+** shared out among SORTWORKERS threads in the enclave
+** (SORTWORKERS=n, at most SORTMAXWORKERS; each takes a TCS).
+** Each array is sorted with SORT_HEAP, the heapsort of
+** Numeric Sort, or SORT_RADIX, an LSD radix sort
+** (SORTALGO=HEAP or RADIX).
+*/
+#define SORTWORKERS     4
+#define SORTMAXWORKERS  8
+#define SORT_HEAP       0
+#define SORT_RADIX      1
+
+/*
+** The adjust field of the test structures is 0 until the
+** self-adjustment has run and 1 after.  ADJUST_CACHED marks
+** sizes read from the calibration cache (CALIBCACHE=): the
+** self-adjustment starts one step below them, and goes back
+** to scratch if that step already takes too long, so while
+** they still hold it takes two iterations.
+*/
+#define ADJUST_CACHED   2
 
 /*
 ** TYPEDEFS
@@ -285,6 +353,8 @@ typedef struct {
         double sortspersec;     /* # of sort iterations per sec */
         ushort numarrays;       /* # of arrays */
         ulong arraysize;        /* # of elements in array */
+        int workers;            /* Threads, Numeric Sort (PAR) */
+        int algo;               /* SORT_xxx, Numeric Sort (PAR) */
 } SortStruct;
 
 /****************
@@ -324,6 +394,24 @@ typedef struct {
 #define BITFARRAYSIZE 32768L
 #endif
 
+/*
+** How the operations array is run: one ECALL per bit run
+** (Bitfield (ECALL)), the whole array in one ECALL, a bit at
+** a time (Bitfield), or the same a word at a time
+** (Bitfield (WORD)).
+*/
+#define BITOPS_ECALL 0
+#define BITOPS_BATCHED 1
+#define BITOPS_WORD 2
+
+/*
+** Kernels of Bitfield (WORD): 64-bit words, or 256-bit AVX2
+** stores for the whole words of a run (BITKERNEL=WORD or
+** AVX2; the widest the CPU has by default).
+*/
+#define BITKERNEL_WORD 0
+#define BITKERNEL_AVX2 1
+
 /*
 ** TYPEDEFS
 */
@@ -333,6 +421,7 @@ typedef struct {
         double bitopspersec;    /* # of bitfield ops per sec */
         ulong bitoparraysize;           /* Total # of bitfield ops */
         ulong bitfieldarraysize;        /* Bit field array size */
+        int kernel;             /* BITKERNEL_xxx, Bitfield (WORD) */
 } BitOpStruct;
 
 /****************************
@@ -358,6 +447,18 @@ typedef struct {
 */
 #define EMFARRAYSIZE 3000L
 
+/*
+** Emulators of DoEmFloatMode(): FP Emulation, FP Emulation
+** (WIDE), and FP Emulation (SORTED), which runs the
+** operations a kind at a time, shared among EMFWORKERS
+** threads in the enclave, at most EMFMAXWORKERS.
+*/
+#define EMFLOAT_CLASSIC 0
+#define EMFLOAT_WIDE 1
+#define EMFLOAT_SORTED 2
+#define EMFWORKERS 1
+#define EMFMAXWORKERS 8
+
 /*
 ** TYPEDEFS
 */
@@ -366,6 +467,7 @@ typedef struct {
         ulong request_secs;     /* # of seconds requested */
         ulong arraysize;        /* Size of array */
         ulong loops;            /* Loops per iterations */
+        int workers;            /* Threads, FP Emulation (SORTED) */
         double emflops;         /* Results */
 } EmFloatStruct;
 
@@ -373,6 +475,16 @@ typedef struct {
 ** FOURIER COEFFICIENTS **
 *************************/
 
+/*
+** Fourier (SIMD) shares the coefficients among FOURWORKERS
+** threads in the enclave, at most FOURMAXWORKERS.  Its
+** coefficients may be off those of Fourier by FOURCHECKTOL
+** (relative to 1 + their size).
+*/
+#define FOURWORKERS 4
+#define FOURMAXWORKERS 8
+#define FOURCHECKTOL 1e-9
+
 /*
 ** TYPEDEFS
 */
@@ -380,6 +492,7 @@ typedef struct {
         int adjust;             /* Set adjust code */
         ulong request_secs;     /* # of requested seconds */
         ulong arraysize;        /* Size of coeff. arrays */
+        int workers;            /* Threads, Fourier (SIMD) */
         double fflops;          /* Results */
 } FourierStruct;
 
@@ -397,6 +510,27 @@ typedef struct {
         double iterspersec;     /* Results */
 } AssignStruct;
 
+/*
+** Assignment (JV): one ASSIGNSIZE x ASSIGNSIZE cost matrix
+** per iteration, solved from scratch by shortest augmenting
+** paths.  Costs are drawn like those of Assignment.
+*/
+#define ASSIGNSIZE 1024
+#define ASSIGNMAXSIZE 8192
+
+/*
+** Cost matrix size above which Assignment (JV) runs in the
+** sweep enclave
+*/
+#define ASSIGNHEAPBYTES (24L*1024L*1024L)
+
+typedef struct {
+        ulong request_secs;     /* Requested # of seconds */
+        ulong n;                /* Rows (and columns) */
+        long cost;              /* Cost of the assignment */
+        double iterspersec;     /* Results */
+} AssignJVStruct;
+
 /********************
 ** IDEA ENCRYPTION **
 ********************/
@@ -428,6 +562,15 @@ typedef struct {
         double iterspersec;     /* Results */
 } IDEAStruct;
 
+/*
+** Instruction sets of the SIMD kernels, narrowest first.
+** The enclave cannot execute CPUID, so the App picks the
+** widest one at start-up and passes it to the kernels.
+*/
+#define SIMD_SSE2 0             /* 8 blocks at a time */
+#define SIMD_AVX2 1             /* 16 blocks */
+#define SIMD_AVX512 2           /* 32 blocks, needs AVX-512BW */
+
 
 /************************
 ** HUFFMAN COMPRESSION **
@@ -454,6 +597,19 @@ typedef struct {
 */
 #define HUFFARRAYSIZE 5000L
 
+/*
+** Bytes Huffman (table) may need for the compressed text of
+** n bytes: its codes are at most 12 bits long (HUFFMAXBITS
+** of encl_huffman.c), plus the last partial word.
+*/
+#define HUFFTABLECOMP(n) (((n)*12L+7L)/8L+8L)
+
+/*
+** What a failed round trip of Huffman (table) reports.
+*/
+#define HUFFMISMATCH    -1      /* Does not give the plaintext back */
+#define HUFFOVERFLOW    -2      /* Compressed text does not fit */
+
 /*
 ** TYPEDEFS
 */
@@ -491,6 +647,38 @@ typedef struct {
         double iterspersec;     /* Results */
 } NNetStruct;
 
+/*
+** Neural Net (MLP): a net of MLPIN inputs, MLPHIDDEN hidden
+** and MLPOUT output units, trained on MLPPATTERNS patterns
+** in batches of MLPBATCH.  An iteration is a pass (epoch)
+** over all of them.
+*/
+#define MLPIN 256
+#define MLPHIDDEN 256
+#define MLPOUT 64
+#define MLPPATTERNS 1024
+#define MLPBATCH 64
+#define MLPMAXSIZE 4096         /* Largest layer */
+#define MAXMLPLOOPS 10000       /* Most epochs per iteration */
+#define MLPCHECKTOL 1e-9        /* Outputs and weights, gemm() vs plain loops */
+
+/*
+** Working set above which Neural Net (MLP) runs in the sweep
+** enclave, as LU (BLOCKED) does
+*/
+#define MLPHEAPBYTES (24L*1024L*1024L)
+
+typedef struct {
+        int adjust;             /* Set adjust code */
+        ulong request_secs;     /* Requested # of seconds */
+        ulong in, hid, out;     /* Layer sizes */
+        ulong npats;            /* Training patterns */
+        ulong batch;            /* Patterns per batch */
+        ulong loops;            /* Epochs per iteration */
+        double patspersec;      /* Patterns trained per second */
+        double gflops;          /* Same, in GFLOP/s */
+} MLPStruct;
+
 /***********************
 **  LU DECOMPOSITION  **
 ** (Linear Equations) **
@@ -517,3 +705,221 @@ typedef struct {
         double iterspersec;     /* Results */
 } LUStruct;
 
+/*
+** LU (BLOCKED) factors one LUSIZE x LUSIZE matrix per
+** iteration, LUBLOCK columns at a time.  LUKERNEL=CLASSIC
+** runs the Crout loops of LU on it instead, for comparison.
+*/
+#define LUSIZE 512
+#define LUMAXSIZE 4096
+#define LUBLOCK 64
+#define LUKERNEL_CLASSIC 0
+#define LUKERNEL_BLOCKED 1
+
+/*
+** Working set (two matrices) above which LU (BLOCKED) runs
+** in the sweep enclave, whose heap is not limited to 36 MB
+*/
+#define LUHEAPBYTES (24L*1024L*1024L)
+
+/*
+** Largest residual accepted, in units of |A| |x| n epsilon
+*/
+#define LUCHECKTOL 100.0
+
+typedef struct {
+        ulong request_secs;     /* Requested # of seconds */
+        ulong n;                /* Rows (and columns) */
+        ulong nb;               /* Columns per panel */
+        int kernel;             /* LUKERNEL_xxx */
+        double iterspersec;     /* Factorizations per second */
+        double gflops;          /* Same, in GFLOP/s */
+} LUBlockStruct;
+
+
+/****************************
+** ECALL/OCALL TRANSITIONS **
+****************************/
+
+/*
+** DEFINES
+*/
+/*
+** Default # of timed calls per measurement.  Large buffers
+** are capped by TRANSMAXBYTES of traffic, but never go below
+** TRANSMINSAMPLES calls.
+*/
+#define TRANSSAMPLES 10000L
+#define TRANSMINSAMPLES 100L
+#define TRANSMAXBYTES (256L*1024L*1024L)
+
+/*
+** Buffer sizes run from 64 bytes to 16 MB in steps of 4.
+*/
+#define TRANSMINBUF 64L
+#define TRANSMAXBUF (16L*1024L*1024L)
+
+/*
+** Max # of result rows: empty ECALL, OCALL, and the three
+** buffer kinds for each size.
+*/
+#define TRANSMAXROWS 32
+
+/*
+** Max # of concurrent threads; one TCS is needed per thread,
+** and the main thread keeps the one it is bound to.
+*/
+#define TRANSMAXTHREADS (MAXTHREADS-1)
+
+/*
+** TYPEDEFS
+*/
+typedef struct {
+        char name[32];          /* What was measured */
+        ulong samples;          /* # of timed calls (all threads) */
+        double p50;             /* Latency percentiles, ns */
+        double p99;
+        double p999;
+        double perthread;       /* Calls/sec of each thread (mean) */
+        double total;           /* Calls/sec of all threads */
+        int failed;             /* Non-zero if the ECALL failed */
+} TransResult;
+
+typedef struct {
+        int dotrans;            /* Run the transition benchmarks */
+        ulong samples;          /* Timed calls per measurement */
+        int threads;            /* # of concurrent threads */
+        double timeroverhead;   /* ns spent reading the clock */
+        int numresults;         /* # of rows in results */
+        TransResult results[TRANSMAXROWS];
+} TransStruct;
+
+
+/****************************
+** EPC-PRESSURE SWEEP      **
+****************************/
+
+/*
+** DEFINES
+*/
+/*
+** Tests that can be swept (SWEEP=...).
+*/
+#define SWEEP_NONE -1
+#define SWEEP_NUMSORT 0
+#define SWEEP_EMF 1
+#define SWEEP_IDEA 2
+#define SWEEP_HUFF 3
+
+/*
+** The working set runs from SWEEPMINKB to SWEEPMAXKB,
+** doubling at each step.  The top end needs the sweep
+** enclave (enclave.sweep.signed.so), whose heap is far
+** larger than the EPC.
+*/
+#define SWEEPMINKB 64L
+#define SWEEPMAXKB (256L*1024L)
+
+/*
+** IDEA and Huffman run enough loops per timed call to move
+** about SWEEPVOLUME bytes, so small working sets are not
+** swamped by the cost of the ECALL.
+*/
+#define SWEEPVOLUME (4L*1024L*1024L)
+
+/*
+** Heap slack on top of the working set (Huffman tree and
+** allocator overhead) when checking that a size fits.
+*/
+#define SWEEPSLACK (64L*1024L)
+
+/*
+** Max # of result rows.
+*/
+#define SWEEPMAXROWS 32
+
+/*
+** Width of the ns/byte bars in the sweep table.
+*/
+#define SWEEPBAR 30
+
+/*
+** TYPEDEFS
+*/
+typedef struct {
+        ulong bytes;            /* Working set, bytes */
+        double iterspersec;     /* Iterations/sec in the enclave */
+        double nsperbyte;       /* ns per iteration per byte */
+        double native;          /* Iterations/sec native (-diff) */
+        double natnsperbyte;
+        int failed;             /* Did not fit in the enclave heap */
+} SweepResult;
+
+typedef struct {
+        int test;               /* SWEEP_xxx */
+        ulong minkb;            /* Smallest working set, KB */
+        ulong maxkb;            /* Largest working set, KB */
+        int native;             /* Also sweep natively */
+        int numresults;         /* # of rows in results */
+        SweepResult results[SWEEPMAXROWS];
+} SweepStruct;
+
+/*********************
+** STREAMING IDEA   **
+**********************/
+
+/*
+** DEFINES
+*/
+/*
+** The chunk size runs from STREAMMINKB to STREAMMAXKB,
+** doubling at each step.  Each run streams STREAMMB
+** megabytes (STREAMMB=n) from an untrusted buffer through
+** the enclave and back out.
+*/
+#define STREAMMINKB 4L
+#define STREAMMAXKB 2048L
+#define STREAMMB 16L
+
+/*
+** Enclave buffers in each of the input and output rings:
+** two, so one chunk is copied while the next is ciphered.
+*/
+#define STREAMSLOTS 2
+
+/*
+** Stages of the pipeline; STREAM_SERIAL does all three on
+** one thread, one chunk after the other.
+*/
+#define STREAM_SERIAL 0
+#define STREAM_COPYIN 1
+#define STREAM_CIPHER 2
+#define STREAM_COPYOUT 3
+
+/*
+** Max # of result rows.
+*/
+#define STREAMMAXROWS 16
+
+/*
+** TYPEDEFS
+*/
+typedef struct {
+        ulong chunk;            /* Chunk size, bytes */
+        double serial;          /* MB/s, one thread */
+        double pipelined;       /* MB/s, three stages */
+        double native;          /* MB/s, pipelined, native (-diff) */
+        int failed;             /* Ring allocation failed */
+        int nothreads;          /* A stage thread did not start */
+        int mismatch;           /* Output differs from cipher_idea */
+} StreamResult;
+
+typedef struct {
+        int dostream;           /* Run the streaming test */
+        ulong mb;               /* MB streamed per run */
+        ulong minkb;            /* Smallest chunk, KB */
+        ulong maxkb;            /* Largest chunk, KB */
+        int native;             /* Also stream natively */
+        int numresults;         /* # of rows in results */
+        StreamResult results[STREAMMAXROWS];
+} StreamStruct;
@@ -0,0 +1,248 @@
+/*
+** streambench.c
+*/
+
+/*********************************
+** STREAMING IDEA               **
+**********************************
+** Encrypt bulk data as it flows through the enclave: STREAMMB
+** megabytes are read from an untrusted buffer, a chunk at a
+** time, ciphered in the enclave (IDEA, with the SIMD kernel of
+** IDEA (SIMD)) and written to another untrusted buffer.  The
+** enclave reaches both through [user_check] pointers.
+** Each chunk size from STREAMMINKB to STREAMMAXKB is run
+**  serially    one ECALL copies a chunk in, ciphers it and
+**              copies it out, then takes the next
+**  pipelined   copy-in, cipher and copy-out each run on their
+**              own thread and hand chunks on through
+**              double-buffered rings in the enclave, so the
+**              copies of one chunk overlap the cipher of the
+**              next
+** and the MB/s of both are reported.  IDEA works block by
+** block, so the ciphertext does not depend on the chunk size;
+** every run is checked against the scalar cipher_idea().
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "nmglobal.h"
+#include "streambench.h"
+
+/*************
+** DoStream **
+**************
+** Run every chunk size and leave the results in
+** global_streamstruct.results[] for the caller to print.
+*/
+void DoStream(void)
+{
+StreamStruct *locstreamstruct;  /* Local stream structure */
+StreamResult *result;           /* Row being filled in */
+unsigned char *in;              /* Untrusted plaintext */
+unsigned char *out;             /* Untrusted ciphertext */
+unsigned char *ref;             /* Ciphertext of cipher_idea() */
+unsigned short Z[STREAMKEYLEN]; /* Subkeys */
+size_t len;                     /* Bytes streamed per run */
+double mb;                      /* Same, in MB */
+double secs;                    /* Of a pipelined run */
+ulong kb;                       /* Chunk size, KB */
+int haveref;                    /* ref is filled in */
+size_t i;
+
+locstreamstruct=&global_streamstruct;
+locstreamstruct->numresults=0;
+if(locstreamstruct->mb<1)
+        locstreamstruct->mb=1;
+if(locstreamstruct->minkb<1)
+        locstreamstruct->minkb=1;
+len=(size_t)locstreamstruct->mb*1024L*1024L;
+mb=(double)locstreamstruct->mb;
+
+in=(unsigned char *)malloc(len);
+out=(unsigned char *)malloc(len);
+ref=(unsigned char *)malloc(len);
+if(in==NULL || out==NULL || ref==NULL)
+{       printf("**Streaming IDEA: out of memory\n");
+        ErrorExit();
+}
+
+/*
+** Random plaintext and subkeys.  Any 52 words will do as an
+** encryption key schedule.
+*/
+randnum((int32)3);
+for(i=0;i<len;i++)
+        in[i]=(unsigned char)(abs_randwc((u32)255) & 0xFF);
+for(i=0;i<STREAMKEYLEN;i++)
+        Z[i]=(unsigned short)(abs_randwc((u32)60000) & 0xFFFF);
+
+haveref=0;
+for(kb=locstreamstruct->minkb;
+  kb<=locstreamstruct->maxkb && kb*1024L<=len &&
+  locstreamstruct->numresults<STREAMMAXROWS;
+  kb*=2)
+{
+        result=&locstreamstruct->results[locstreamstruct->numresults++];
+        memset(result,0,sizeof(StreamResult));
+        result->chunk=kb*1024L;
+
+        if(app_stream_init((size_t)result->chunk,Z,global_simd)!=0)
+        {       result->failed=1;
+                break;
+        }
+        if(!haveref)
+        {       if(app_stream_reference(in,ref,len)!=0)
+                {       result->failed=1;
+                        app_stream_free();
+                        break;
+                }
+                haveref=1;
+        }
+        result->serial=mb/StreamSerial(in,out,len);
+        if(StreamCheck(out,ref,len)!=0)
+                result->mismatch=1;
+
+        secs=StreamPipelined(in,out,len,result->chunk,Z);
+        app_stream_free();
+        if(secs<(double)0.0)
+        {       result->nothreads=1;
+                break;
+        }
+        result->pipelined=mb/secs;
+        if(StreamCheck(out,ref,len)!=0)
+                result->mismatch=1;
+
+        if(locstreamstruct->native)
+        {       app_native=1;
+                secs=StreamPipelined(in,out,len,result->chunk,Z);
+                app_stream_free();
+                app_native=0;
+                if(secs<(double)0.0)
+                {       result->nothreads=1;
+                        break;
+                }
+                result->native=mb/secs;
+                if(StreamCheck(out,ref,len)!=0)
+                        result->mismatch=1;
+        }
+}
+
+free(in);
+free(out);
+free(ref);
+return;
+}
+
+/*****************
+** StreamSerial **
+******************
+** Best time in seconds of STREAMREPEAT serial runs, with the
+** rings already set up.
+*/
+static double StreamSerial(unsigned char *in, unsigned char *out, size_t len)
+{
+unsigned long elapsed;          /* Stopwatch ticks */
+double secs, best;
+int r;
+
+best=(double)0.0;
+for(r=0;r<STREAMREPEAT;r++)
+{       memset(out,0,len);
+        elapsed=StartStopwatch();
+        if(app_stream_stage(STREAM_SERIAL,in,out,len)!=0)
+        {       printf("**Streaming IDEA: serial run failed\n");
+                ErrorExit();
+        }
+        secs=TicksToFracSecs(StopStopwatch(elapsed));
+        if(r==0 || secs<best)
+                best=secs;
+}
+return(best);
+}
+
+/********************
+** StreamPipelined **
+*********************
+** Best time in seconds of STREAMREPEAT pipelined runs.  The
+** three stages start together on threads of their own, each
+** in its own ECALL; the rings are set up afresh for every run
+** so the chunk counters start at zero.  Returns -1 if a stage
+** thread cannot be created: the stages already running are
+** told to give up and joined.
+*/
+static double StreamPipelined(unsigned char *in, unsigned char *out,
+        size_t len, ulong chunk, unsigned short *Z)
+{
+StreamJob jobs[3];              /* One per stage */
+pthread_t tids[3];
+int started[3];
+unsigned long elapsed;          /* Stopwatch ticks */
+double secs, best;
+int r, i;
+
+best=(double)0.0;
+for(r=0;r<STREAMREPEAT;r++)
+{       if(app_stream_init((size_t)chunk,Z,global_simd)!=0)
+        {       printf("**Streaming IDEA: cannot set up the rings\n");
+                ErrorExit();
+        }
+        memset(out,0,len);
+        for(i=0;i<3;i++)
+        {       jobs[i].stage=STREAM_COPYIN+i;
+                jobs[i].in=in;
+                jobs[i].out=out;
+                jobs[i].len=len;
+                jobs[i].failed=0;
+        }
+        elapsed=StartStopwatch();
+        for(i=0;i<3;i++)
+                started[i]=pthread_create(&tids[i],NULL,StreamThread,
+                        &jobs[i])==0;
+        if(!started[0] || !started[1] || !started[2])
+                app_stream_abort();
+        for(i=0;i<3;i++)
+                if(started[i])
+                        pthread_join(tids[i],NULL);
+        secs=TicksToFracSecs(StopStopwatch(elapsed));
+        if(!started[0] || !started[1] || !started[2])
+                return((double)-1.0);
+        for(i=0;i<3;i++)
+                if(jobs[i].failed)
+                {       printf("**Streaming IDEA: pipelined run failed\n");
+                        ErrorExit();
+                }
+        if(r==0 || secs<best)
+                best=secs;
+}
+return(best);
+}
+
+/*****************
+** StreamThread **
+******************
+** Body of one stage.  If its ECALL fails, the other stages
+** would wait for it forever; tell them to give up.
+*/
+static void *StreamThread(void *arg)
+{
+StreamJob *job;
+
+job=(StreamJob *)arg;
+if(app_stream_stage(job->stage,job->in,job->out,job->len)!=0)
+{       job->failed=1;
+        app_stream_abort();
+}
+return(NULL);
+}
+
+/****************
+** StreamCheck **
+*****************
+** 0 if a run's ciphertext matches that of cipher_idea().
+*/
+static int StreamCheck(unsigned char *out, unsigned char *ref, size_t len)
+{
+return(memcmp(out,ref,len)!=0 ? -1 : 0);
+}
@@ -0,0 +1,55 @@
+/*
+** streambench.h
+** Header for streambench.c
+** Streaming IDEA over untrusted buffers.
+*/
+
+/*
+** EXTERNALS
+*/
+extern StreamStruct global_streamstruct;
+extern int global_simd;                 /* SIMD_xxx of the cipher */
+
+extern void ErrorExit(void);            /* From SYSSPEC */
+extern unsigned long StartStopwatch();
+extern unsigned long StopStopwatch(unsigned long startticks);
+extern double TicksToFracSecs(unsigned long tickamount);
+extern int32 randnum(int32 lngval);     /* From MISC */
+extern u32 abs_randwc(u32 num);
+
+/*
+** Bridges from App/App.cpp.
+*/
+extern int app_native;
+extern int app_stream_init(size_t chunk, unsigned short *Z, int level);
+extern void app_stream_free(void);
+extern int app_stream_stage(int stage, const void *in, void *out, size_t len);
+extern void app_stream_abort(void);
+extern int app_stream_reference(const void *in, void *out, size_t len);
+
+/*
+** DEFINES
+*/
+#define STREAMKEYLEN 52         /* IDEA subkeys, KEYLEN in nbench1.h */
+#define STREAMREPEAT 3          /* Runs per row; the best is kept */
+
+/*
+** TYPEDEFS
+*/
+typedef struct {
+        int stage;              /* STREAM_xxx */
+        const void *in;         /* Untrusted input */
+        void *out;              /* Untrusted output */
+        size_t len;             /* Bytes to stream */
+        int failed;             /* ECALL failed */
+} StreamJob;
+
+/*
+** PROTOTYPES
+*/
+void DoStream(void);
+static double StreamSerial(unsigned char *in, unsigned char *out, size_t len);
+static double StreamPipelined(unsigned char *in, unsigned char *out,
+        size_t len, ulong chunk, unsigned short *Z);
+static void *StreamThread(void *arg);
+static int StreamCheck(unsigned char *out, unsigned char *ref, size_t len);
@@ -0,0 +1,147 @@
+/*
+** sweepbench.c
+*/
+
+/*********************************
+** EPC-PRESSURE SWEEP           **
+**********************************
+** Grow the working set of one test geometrically, from
+** SWEEPMINKB to SWEEPMAXKB, and record iterations/sec and
+** ns per byte at each size.  Once the working set no longer
+** fits in the EPC, pages are evicted and reloaded (encrypted)
+** on every pass and ns/byte climbs; the sweep shows where.
+** The test's own arrays are sized from the working set:
+**  NUMSORT  one array of longs
+**  EMF      three arrays of InternalFPF
+**  IDEA     plain, crypt and plain2 buffers
+**  HUFFMAN  plain, compressed and decompressed buffers
+** ns/byte is the time of one iteration over the whole
+** working set, so it is flat while the data fits in the
+** caches and the EPC.  Sizes past the enclave heap are
+** marked and end the sweep.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nmglobal.h"
+#include "sweepbench.h"
+
+/*************
+** DoSweep **
+**************
+** Run the sweep and leave the results in
+** global_sweepstruct.results[] for the caller to print.
+*/
+void DoSweep(void)
+{
+SweepStruct *locsweepstruct;    /* Local sweep structure */
+SweepResult *result;            /* Row being filled in */
+ulong kb;                       /* Working set, KB */
+
+locsweepstruct=&global_sweepstruct;
+locsweepstruct->numresults=0;
+if(locsweepstruct->minkb<1)
+        locsweepstruct->minkb=1;
+
+for(kb=locsweepstruct->minkb;
+  kb<=locsweepstruct->maxkb && locsweepstruct->numresults<SWEEPMAXROWS;
+  kb*=2)
+{
+        result=&locsweepstruct->results[locsweepstruct->numresults++];
+        memset(result,0,sizeof(SweepResult));
+        result->bytes=kb*1024L;
+
+        /*
+        ** Make sure the enclave can hold it; a failed
+        ** allocation inside the enclave is not reported back.
+        */
+        if(app_heap_probe((size_t)(result->bytes+SWEEPSLACK))!=0)
+        {       result->failed=1;
+                break;
+        }
+
+        result->iterspersec=SweepRun(locsweepstruct->test,result->bytes);
+        result->nsperbyte=(double)1e9/
+                (result->iterspersec*(double)result->bytes);
+
+        if(locsweepstruct->native)
+        {       app_native=1;
+                result->native=SweepRun(locsweepstruct->test,result->bytes);
+                app_native=0;
+                result->natnsperbyte=(double)1e9/
+                        (result->native*(double)result->bytes);
+        }
+}
+return;
+}
+
+/*************
+** SweepRun **
+**************
+** Size the test for a working set of bytes, run it once
+** without self-adjustment and return iterations/sec.  The
+** test's global structure is put back afterwards.
+*/
+static double SweepRun(int test, ulong bytes)
+{
+SortStruct numsortsave;         /* Saved global structures */
+EmFloatStruct emfloatsave;
+IDEAStruct ideasave;
+HuffStruct huffsave;
+double iterspersec;
+ulong arraysize;
+ulong loops;
+
+iterspersec=(double)0.0;
+switch(test)
+{
+        case SWEEP_NUMSORT:
+                numsortsave=global_numsortstruct;
+                global_numsortstruct.adjust=1;
+                global_numsortstruct.numarrays=1;
+                global_numsortstruct.arraysize=bytes/sizeof(long);
+                DoNumSort();
+                iterspersec=global_numsortstruct.sortspersec;
+                global_numsortstruct=numsortsave;
+                break;
+
+        case SWEEP_EMF:
+                emfloatsave=global_emfloatstruct;
+                global_emfloatstruct.adjust=1;
+                global_emfloatstruct.loops=1;
+                global_emfloatstruct.arraysize=bytes/(3L*sizeof(InternalFPF));
+                DoEmFloat();
+                iterspersec=global_emfloatstruct.emflops;
+                global_emfloatstruct=emfloatsave;
+                break;
+
+        case SWEEP_IDEA:
+                /*
+                ** IDEA works on 8-byte blocks.
+                */
+                arraysize=(bytes/3L) & ~7L;
+                loops=SWEEPVOLUME/arraysize;
+                ideasave=global_ideastruct;
+                global_ideastruct.adjust=1;
+                global_ideastruct.arraysize=arraysize;
+                global_ideastruct.loops=loops<1 ? 1 : loops;
+                DoIDEA();
+                iterspersec=global_ideastruct.iterspersec;
+                global_ideastruct=ideasave;
+                break;
+
+        case SWEEP_HUFF:
+                arraysize=bytes/3L;
+                loops=SWEEPVOLUME/arraysize;
+                huffsave=global_huffstruct;
+                global_huffstruct.adjust=1;
+                global_huffstruct.arraysize=arraysize;
+                global_huffstruct.loops=loops<1 ? 1 : loops;
+                DoHuffman();
+                iterspersec=global_huffstruct.iterspersec;
+                global_huffstruct=huffsave;
+                break;
+}
+return(iterspersec);
+}
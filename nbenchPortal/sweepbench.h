@@ -0,0 +1,47 @@
+/*
+** sweepbench.h
+** Header for sweepbench.c
+** EPC-pressure sweep.
+*/
+
+/*
+** TYPEDEFS
+*/
+
+/*
+** An element of the EMF arrays, as in emfloat.h, which the
+** sweep needs only the size of.
+*/
+typedef struct
+{
+        u8 type;
+        u8 sign;
+        short exp;
+        u16 mantissa[INTERNAL_FPF_PRECISION];
+} InternalFPF;
+
+/*
+** EXTERNALS
+*/
+extern SweepStruct global_sweepstruct;
+extern THREADLOCAL SortStruct global_numsortstruct;
+extern THREADLOCAL EmFloatStruct global_emfloatstruct;
+extern THREADLOCAL IDEAStruct global_ideastruct;
+extern THREADLOCAL HuffStruct global_huffstruct;
+
+extern void DoNumSort(void);            /* From NBENCH1 */
+extern void DoEmFloat(void);
+extern void DoIDEA(void);
+extern void DoHuffman(void);
+
+/*
+** Bridges from App/App.cpp.
+*/
+extern int app_native;
+extern int app_heap_probe(size_t size);
+
+/*
+** PROTOTYPES
+*/
+void DoSweep(void);
+static double SweepRun(int test, ulong bytes);
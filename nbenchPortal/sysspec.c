@@ -774,6 +774,159 @@ exit(1);
 **    STOPWATCH ROUTINES    **
 *****************************/
 
+#ifdef TIMERSELECT
+/*
+** State of the selected stopwatch.  stopwatch_tps is the
+** number of ticks per second of the current timer.
+*/
+static int stopwatch_timer=TIMER_CLOCK;
+static double stopwatch_tps=(double)CLOCKS_PER_SEC;
+
+/****************************
+** ReadStopwatch
+** Reads the selected timer in ticks.  MONORAW ticks are
+** nanoseconds (microseconds if a long is only 32 bits, so a
+** difference of two readings spans over an hour); TSC ticks
+** are CPU reference cycles.
+*/
+static unsigned long ReadStopwatch(void)
+{
+struct timespec ts;
+#ifdef TIMERTSC
+unsigned int aux;
+#endif
+
+switch(stopwatch_timer)
+{
+	case TIMER_MONORAW:
+		clock_gettime(CLOCK_MONOTONIC_RAW,&ts);
+#ifdef LONG64
+		return((unsigned long)ts.tv_sec*1000000000UL+
+			(unsigned long)ts.tv_nsec);
+#else
+		return((unsigned long)ts.tv_sec*1000000UL+
+			(unsigned long)(ts.tv_nsec/1000));
+#endif
+#ifdef TIMERTSC
+	case TIMER_TSC:
+		return((unsigned long)__rdtscp(&aux));
+#endif
+}
+return((unsigned long)clock());
+}
+
+/****************************
+** SelectStopwatch
+** Makes the given TIMER_xxx the stopwatch.  The TSC is only
+** accepted if it is invariant (constant rate, not stopped in
+** deep C-states) and rdtscp is available; its rate is then
+** calibrated against CLOCK_MONOTONIC_RAW.  Returns 0 on
+** success, -1 if the timer cannot be used (the current
+** stopwatch is left alone).
+*/
+int SelectStopwatch(int timer)
+{
+struct timespec ts;
+#ifdef TIMERTSC
+unsigned int eax, ebx, ecx, edx;
+unsigned long tsc0, tsc1;
+double ns0, ns1;
+#endif
+
+switch(timer)
+{
+	case TIMER_CLOCK:
+		stopwatch_timer=TIMER_CLOCK;
+		stopwatch_tps=(double)CLOCKS_PER_SEC;
+		return(0);
+
+	case TIMER_MONORAW:
+		if(clock_gettime(CLOCK_MONOTONIC_RAW,&ts)!=0)
+			return(-1);
+		stopwatch_timer=TIMER_MONORAW;
+#ifdef LONG64
+		stopwatch_tps=(double)1e9;
+#else
+		stopwatch_tps=(double)1e6;
+#endif
+		return(0);
+
+#ifdef TIMERTSC
+	case TIMER_TSC:
+		if(!__get_cpuid(0x80000007,&eax,&ebx,&ecx,&edx) ||
+		  !(edx & (1<<8)))
+			return(-1);             /* Not invariant */
+		if(!__get_cpuid(0x80000001,&eax,&ebx,&ecx,&edx) ||
+		  !(edx & (1<<27)))
+			return(-1);             /* No rdtscp */
+		if(clock_gettime(CLOCK_MONOTONIC_RAW,&ts)!=0)
+			return(-1);
+
+		/*
+		** Count TSC ticks over about 100 milliseconds.
+		*/
+		stopwatch_timer=TIMER_TSC;
+		ns0=(double)ts.tv_sec*(double)1e9+(double)ts.tv_nsec;
+		tsc0=ReadStopwatch();
+		do {
+			clock_gettime(CLOCK_MONOTONIC_RAW,&ts);
+			ns1=(double)ts.tv_sec*(double)1e9+(double)ts.tv_nsec;
+		} while(ns1-ns0<(double)1e8);
+		tsc1=ReadStopwatch();
+		stopwatch_tps=(double)(tsc1-tsc0)*(double)1e9/(ns1-ns0);
+		return(0);
+#endif
+}
+return(-1);
+}
+
+/****************************
+** CurrentStopwatch
+** Returns the TIMER_xxx in use.
+*/
+int CurrentStopwatch(void)
+{
+return(stopwatch_timer);
+}
+
+/****************************
+** StopwatchName
+** Returns a printable name for the stopwatch in use.
+*/
+char *StopwatchName(void)
+{
+switch(stopwatch_timer)
+{
+	case TIMER_MONORAW: return("clock_gettime(CLOCK_MONOTONIC_RAW)");
+	case TIMER_TSC: return("TSC (invariant, rdtscp)");
+}
+return("clock()");
+}
+
+/****************************
+** StopwatchResolution
+** Returns the smallest step the stopwatch can be seen to
+** take, in seconds.  Found by spinning on the timer.
+*/
+double StopwatchResolution(void)
+{
+unsigned long t0, t1;
+unsigned long best;
+int i;
+
+best=0;
+for(i=0;i<10;i++)
+{	t0=ReadStopwatch();
+	do {
+		t1=ReadStopwatch();
+	} while(t1==t0);
+	if(best==0 || t1-t0<best)
+		best=t1-t0;
+}
+return((double)best/stopwatch_tps);
+}
+#endif
+
 /****************************
 ** StartStopwatch
 ** Starts a software stopwatch.  Returns the first value of
@@ -781,6 +934,9 @@ exit(1);
 */
 unsigned long StartStopwatch()
 {
+#ifdef TIMERSELECT
+return(ReadStopwatch());
+#else
 #ifdef MACTIMEMGR
 /*
 ** For Mac code warrior, use timer. In this case, what we return is really
@@ -800,6 +956,7 @@ return((unsigned long)win31tinfo.dwmsSinceStart);
 return((unsigned long)clock());
 #endif
 #endif
+#endif
 }
 
 /****************************
@@ -810,6 +967,9 @@ return((unsigned long)clock());
 unsigned long StopStopwatch(unsigned long startticks)
 {
 	
+#ifdef TIMERSELECT
+return(ReadStopwatch()-startticks);
+#else
 #ifdef MACTIMEMGR
 /*
 ** For Mac code warrior...ignore startticks.  Return val. in microseconds
@@ -824,6 +984,7 @@ return((unsigned long)win31tinfo.dwmsSinceStart-startticks);
 return((unsigned long)clock()-startticks);
 #endif
 #endif
+#endif
 }
 
 /****************************
@@ -833,6 +994,10 @@ return((unsigned long)clock()-startticks);
 */
 unsigned long TicksToSecs(unsigned long tickamount)
 {
+#ifdef TIMERSELECT
+return((unsigned long)((double)tickamount/stopwatch_tps));
+#endif
+
 #ifdef CLOCKWCT
 return((unsigned long)(tickamount/CLK_TCK));
 #endif
@@ -862,6 +1027,10 @@ return((unsigned long)(tickamount/1000L));
 */
 double TicksToFracSecs(unsigned long tickamount)
 {
+#ifdef TIMERSELECT
+return((double)tickamount/stopwatch_tps);
+#endif
+
 #ifdef CLOCKWCT
 return((double)tickamount/(double)CLK_TCK);
 #endif
@@ -882,3 +1051,13 @@ return((double)tickamount/(double)1000);
 #endif
 }
 
+/****************************
+** SecsToTicks
+** Converts seconds to ticks of the stopwatch; the inverse
+** of TicksToFracSecs().
+*/
+unsigned long SecsToTicks(double secs)
+{
+return((unsigned long)(secs/TicksToFracSecs(1UL)+(double)0.5));
+}
+
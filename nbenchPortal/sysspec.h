@@ -54,6 +54,17 @@
 #include "alloc.h"
 */
 
+/*
+** Run-time selectable stopwatch
+*/
+#ifdef TIMERSELECT
+#if defined(__x86_64__) || defined(__i386__)
+#define TIMERTSC
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
 /*
 ** MAC Time Manager routines (from Code Warrior)
 */
@@ -166,3 +177,15 @@ unsigned long TicksToSecs(unsigned long tickamount);
 
 double TicksToFracSecs(unsigned long tickamount);
 
+unsigned long SecsToTicks(double secs);
+
+#ifdef TIMERSELECT
+int SelectStopwatch(int timer);
+
+int CurrentStopwatch(void);
+
+char *StopwatchName(void);
+
+double StopwatchResolution(void);
+#endif
+
@@ -0,0 +1,313 @@
+/*
+** transbench.c
+*/
+
+/*******************************************
+** ECALL/OCALL TRANSITION MICROBENCHMARKS **
+********************************************
+** Round-trip latency of enclave transitions:
+**  empty ECALL (nothing)
+**  ECALL with an [in], [out] or [user_check] buffer,
+**   64 bytes to 16 MB
+**  empty OCALL (ocall_print_string)
+** Each measurement times single calls and reports the
+** p50/p99/p99.9 latency and the calls/sec reached by each
+** thread.  The ECALL rows can be run on several threads at
+** once (TRANSTHREADS) to see how concurrent callers share
+** the enclave.  Calls are timed with the stopwatch chosen by
+** TIMER; TIMER=TSC gives the finest resolution.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "nmglobal.h"
+#include "transbench.h"
+
+/*******************
+** DoTransitions **
+********************
+** Run every transition measurement and leave the results
+** in global_transstruct.results[] for the caller to print.
+*/
+void DoTransitions(void)
+{
+TransStruct *loctransstruct;    /* Local transition structure */
+size_t len;                     /* Buffer length */
+char name[32];                  /* Row name */
+unsigned long long t0, t1;      /* For timer overhead */
+int i;
+
+loctransstruct=&global_transstruct;
+loctransstruct->numresults=0;
+if(loctransstruct->threads<1)
+        loctransstruct->threads=1;
+if(loctransstruct->threads>TRANSMAXTHREADS)
+        loctransstruct->threads=TRANSMAXTHREADS;
+
+/*
+** Every sample includes one read of the clock.  Measure what
+** that costs so it can be reported along with the results.
+*/
+t0=TransNow();
+for(i=0;i<1000;i++)
+        t1=TransNow();
+loctransstruct->timeroverhead=TransNs(t1-t0)/(double)1000.0;
+
+TransMeasure(TK_EMPTY,0,"empty ECALL");
+TransMeasure(TK_OCALL,0,"empty OCALL");
+
+for(len=TRANSMINBUF;len<=TRANSMAXBUF;len*=4)
+{
+        if(len<1024)
+                sprintf(name,"%lu B",(ulong)len);
+        else if(len<1024*1024)
+                sprintf(name,"%lu KB",(ulong)len/1024);
+        else
+                sprintf(name,"%lu MB",(ulong)len/(1024*1024));
+        TransMeasure(TK_IN,len,name);
+        TransMeasure(TK_OUT,len,name);
+        TransMeasure(TK_USERCHECK,len,name);
+}
+return;
+}
+
+/*****************
+** TransMeasure **
+******************
+** Time one kind of transition on all threads and add a
+** row to the results.  OCALLs are always timed on a single
+** thread: the App stamps each OCALL as it arrives, and a
+** switchless OCALL runs on a worker thread, so arrivals
+** cannot be told apart by caller.
+*/
+static void TransMeasure(int kind, size_t len, char *name)
+{
+TransStruct *loctransstruct;    /* Local transition structure */
+TransResult *result;            /* Row being filled in */
+TransJob jobs[TRANSMAXTHREADS]; /* One per thread */
+pthread_t tids[TRANSMAXTHREADS];
+int started[TRANSMAXTHREADS];   /* pthread_create() succeeded */
+unsigned long long *all;        /* Latencies of all threads */
+ulong nsamples;                 /* Timed calls per thread */
+ulong total;                    /* Timed calls, all threads */
+int nthreads;
+int i;
+
+loctransstruct=&global_transstruct;
+if(loctransstruct->numresults>=TRANSMAXROWS)
+        return;
+result=&loctransstruct->results[loctransstruct->numresults++];
+memset(result,0,sizeof(TransResult));
+switch(kind)
+{       case TK_IN: sprintf(result->name,"ECALL [in] %s",name); break;
+        case TK_OUT: sprintf(result->name,"ECALL [out] %s",name); break;
+        case TK_USERCHECK: sprintf(result->name,"ECALL [user_check] %s",name); break;
+        default: strcpy(result->name,name); break;
+}
+
+/*
+** Keep the amount of copying reasonable for big buffers.
+*/
+nsamples=loctransstruct->samples;
+if(len>0 && nsamples*len>TRANSMAXBYTES)
+        nsamples=TRANSMAXBYTES/len;
+if(nsamples<TRANSMINSAMPLES)
+        nsamples=TRANSMINSAMPLES;
+
+nthreads=(kind==TK_OCALL) ? 1 : loctransstruct->threads;
+
+for(i=0;i<nthreads;i++)
+{       jobs[i].kind=kind;
+        jobs[i].len=len;
+        jobs[i].nsamples=nsamples;
+        jobs[i].failed=0;
+        jobs[i].buf=(unsigned char *)NULL;
+        jobs[i].lat=(unsigned long long *)malloc(
+                (nsamples+1)*sizeof(unsigned long long));
+        if(len>0)
+        {       jobs[i].buf=(unsigned char *)malloc(len);
+                if(jobs[i].buf!=NULL)
+                        memset(jobs[i].buf,0x5a,len);
+        }
+        if(jobs[i].lat==NULL || (len>0 && jobs[i].buf==NULL))
+        {       printf("**Transition benchmark: out of memory\n");
+                ErrorExit();
+        }
+}
+
+/*
+** Start all threads together; a single thread runs inline.
+** A thread that cannot be started marks its row failed.
+*/
+if(nthreads==1)
+        TransThread(&jobs[0]);
+else
+{       for(i=0;i<nthreads;i++)
+        {       started[i]=pthread_create(&tids[i],NULL,TransThread,
+                        &jobs[i])==0;
+                if(!started[i])
+                        jobs[i].failed=1;
+        }
+        for(i=0;i<nthreads;i++)
+                if(started[i])
+                        pthread_join(tids[i],NULL);
+}
+
+/*
+** Merge latencies, then pick the percentiles.
+*/
+all=(unsigned long long *)malloc(nthreads*nsamples*sizeof(unsigned long long));
+if(all==NULL)
+{       printf("**Transition benchmark: out of memory\n");
+        ErrorExit();
+}
+total=0;
+for(i=0;i<nthreads;i++)
+{       if(jobs[i].failed)
+                result->failed=1;
+        else
+        {       memcpy(all+total,jobs[i].lat,
+                        nsamples*sizeof(unsigned long long));
+                total+=nsamples;
+                result->perthread+=(double)nsamples*(double)1e9/
+                        TransNs(jobs[i].elapsed);
+        }
+        free(jobs[i].lat);
+        if(jobs[i].buf!=NULL)
+                free(jobs[i].buf);
+}
+if(total>0)
+{       qsort(all,total,sizeof(unsigned long long),TransCompare);
+        result->samples=total;
+        result->p50=TransNs(TransPercentile(all,total,(double)0.5));
+        result->p99=TransNs(TransPercentile(all,total,(double)0.99));
+        result->p999=TransNs(TransPercentile(all,total,(double)0.999));
+        result->total=result->perthread;
+        result->perthread/=(double)(total/nsamples);
+}
+free(all);
+return;
+}
+
+/****************
+** TransThread **
+*****************
+** Body of one measuring thread.  A few untimed calls first
+** so the buffers and the enclave pages are warm.  A call
+** that fails marks the job failed and ends it, so that it
+** is not taken for a fast sample.
+*/
+static void *TransThread(void *arg)
+{
+TransJob *job;                  /* What to do */
+unsigned long long start;       /* Loop start */
+unsigned long long t;           /* Call start */
+ulong i;
+
+job=(TransJob *)arg;
+
+if(job->kind==TK_OCALL)
+{
+        /*
+        ** The enclave issues nsamples+1 OCALLs back to back; the
+        ** gap between two arrivals is one OCALL round trip.
+        */
+        app_ocall_loop(job->lat,16);
+        start=TransNow();
+        if(app_ocall_loop(job->lat,job->nsamples+1)!=0)
+        {       job->failed=1;
+                return(NULL);
+        }
+        job->elapsed=(double)(TransNow()-start);
+        for(i=0;i<job->nsamples;i++)
+                job->lat[i]=job->lat[i+1]-job->lat[i];
+        return(NULL);
+}
+
+for(i=0;i<16;i++)
+        if(TransCall(job->kind,job->buf,job->len)!=0)
+        {       job->failed=1;
+                return(NULL);
+        }
+
+start=TransNow();
+for(i=0;i<job->nsamples;i++)
+{       t=TransNow();
+        if(TransCall(job->kind,job->buf,job->len)!=0)
+        {       job->failed=1;
+                return(NULL);
+        }
+        job->lat[i]=TransNow()-t;
+}
+job->elapsed=(double)(TransNow()-start);
+return(NULL);
+}
+
+/**************
+** TransCall **
+***************
+** Make one ECALL of the given kind.
+*/
+static int TransCall(int kind, unsigned char *buf, size_t len)
+{
+switch(kind)
+{       case TK_EMPTY: return(app_nothing());
+        case TK_IN: return(app_ecall_in(buf,len));
+        case TK_OUT: return(app_ecall_out(buf,len));
+        case TK_USERCHECK: return(app_ecall_user_check(buf,len));
+}
+return(-1);
+}
+
+/*************
+** TransNow **
+**************
+** Stopwatch reading in ticks; same clock the App uses to
+** stamp OCALL arrivals.
+*/
+static unsigned long long TransNow(void)
+{
+return((unsigned long long)StartStopwatch());
+}
+
+/************
+** TransNs **
+*************
+** Convert stopwatch ticks to nanoseconds.
+*/
+static double TransNs(double ticks)
+{
+return(ticks*TicksToFracSecs(1UL)*(double)1e9);
+}
+
+/*****************
+** TransCompare **
+******************
+** qsort() comparison for latencies.
+*/
+static int TransCompare(const void *a, const void *b)
+{
+unsigned long long x, y;
+
+x=*(const unsigned long long *)a;
+y=*(const unsigned long long *)b;
+return((x>y)-(x<y));
+}
+
+/********************
+** TransPercentile **
+*********************
+** Nearest-rank percentile of n sorted samples.
+*/
+static double TransPercentile(unsigned long long *sorted, ulong n,
+        double p)
+{
+ulong rank;
+
+rank=(ulong)(p*(double)n+(double)0.999999);
+if(rank<1) rank=1;
+if(rank>n) rank=n;
+return((double)sorted[rank-1]);
+}
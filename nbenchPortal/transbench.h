@@ -0,0 +1,58 @@
+/*
+** transbench.h
+** Header for transbench.c
+** ECALL/OCALL transition microbenchmarks.
+*/
+
+/*
+** EXTERNALS
+*/
+extern TransStruct global_transstruct;
+
+extern void ErrorExit(void);    /* From SYSSPEC */
+extern unsigned long StartStopwatch();
+extern double TicksToFracSecs(unsigned long tickamount);
+
+/*
+** Bridges from App/App.cpp.  Each returns 0 on success.
+*/
+extern int app_nothing(void);
+extern int app_ecall_in(const void *buf, size_t len);
+extern int app_ecall_out(void *buf, size_t len);
+extern int app_ecall_user_check(void *buf, size_t len);
+extern int app_ocall_loop(unsigned long long *stamps, unsigned long count);
+
+/*
+** Kinds of transition measured.
+*/
+#define TK_EMPTY 0              /* Empty ECALL */
+#define TK_IN 1                 /* ECALL with [in] buffer */
+#define TK_OUT 2                /* ECALL with [out] buffer */
+#define TK_USERCHECK 3          /* ECALL with [user_check] buffer */
+#define TK_OCALL 4              /* Empty OCALL */
+
+/*
+** TYPEDEFS
+*/
+typedef struct {
+        int kind;               /* TK_xxx */
+        size_t len;             /* Buffer length */
+        unsigned char *buf;     /* Buffer (one per thread) */
+        ulong nsamples;         /* # of timed calls */
+        unsigned long long *lat;/* Latencies, stopwatch ticks */
+        double elapsed;         /* Time of the loop, ticks */
+        int failed;             /* ECALL failed */
+} TransJob;
+
+/*
+** PROTOTYPES
+*/
+void DoTransitions(void);
+static void TransMeasure(int kind, size_t len, char *name);
+static void *TransThread(void *arg);
+static int TransCall(int kind, unsigned char *buf, size_t len);
+static unsigned long long TransNow(void);
+static double TransNs(double ticks);
+static int TransCompare(const void *a, const void *b);
+static double TransPercentile(unsigned long long *sorted, ulong n,
+        double p);